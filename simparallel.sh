@@ -0,0 +1,128 @@
+#!/bin/bash
+
+arthome=$(
+   cd "$(dirname "$0")" || exit 1
+   pwd
+)
+
+njobs=$(nproc 2>/dev/null || echo 1)
+nevent=0
+seed=1
+
+usage() {
+   printf "Run a simulation steering file as several jobs and merge the outputs\n"
+   printf "Each event is reseeded from its global event number (art::crib::TEventSeedProcessor),\n"
+   printf "so the merged output does not depend on the number of jobs.\n\n"
+   printf "\033[1m\033[4mUsage:\033[0m $ ./simparallel.sh [OPTIONS] STEERING TAG\n\n"
+   printf "\033[1m\033[4mArguments:\033[0m\n"
+   printf "  STEERING  steering file name in steering/ (without .yaml)\n"
+   printf "            it can use @FIRST@, @NEVENT@, @SEED@, @JOB@ and @TAG@\n"
+   printf "            and should write output/sim/@TAG@/@JOB@.root (and @JOB@.hist.root)\n"
+   printf "  TAG       name of the output directory: output/sim/TAG\n\n"
+   printf "\033[1m\033[4mOptions:\033[0m\n"
+   printf "  -h        Print help\n"
+   printf "  -n NUM    Total number of events (required)\n"
+   printf "  -j NUM    Number of jobs (default: number of cpus)\n"
+   printf "  -s NUM    Base seed (default: 1)\n"
+}
+
+say() {
+   printf "\33[1msimparallel.sh\33[0m: %s\n" "$1"
+}
+
+err() {
+   say "$1" >&2
+   usage
+   exit 1
+}
+
+main() {
+   if [ $# -ne 2 ]; then
+      err "need correct argument"
+   fi
+   if [ "$nevent" -le 0 ] || [ "$njobs" -le 0 ]; then
+      err "the number of events and jobs should be positive"
+   fi
+   if [ ! -f "$arthome/steering/$1.yaml" ]; then
+      err "$arthome/steering/$1.yaml not found"
+   fi
+
+   steering=$1
+   tag=$2
+   outdir="$arthome/output/sim/$tag"
+   mkdir -p "$outdir"
+   cd "$arthome" || exit 1
+
+   # contiguous event ranges, the first (nevent % njobs) jobs have one more event
+   pids=()
+   first=0
+   for ((job = 0; job < njobs; job++)); do
+      num=$((nevent / njobs + (job < nevent % njobs ? 1 : 0)))
+      if [ "$num" -eq 0 ]; then
+         continue
+      fi
+      jobname=$(printf "%03d" "$job")
+      say "job $jobname: events $first -- $((first + num - 1))"
+      artemis -l -b -q "macro/simloop.C(\"$steering\", $first, $num, $job, $seed, \"$tag\")" \
+         >"$outdir/$jobname.log" 2>&1 &
+      pids+=($!)
+      first=$((first + num))
+   done
+
+   failed=0
+   for pid in "${pids[@]}"; do
+      wait "$pid" || failed=1
+   done
+   if [ "$failed" -ne 0 ]; then
+      say "some jobs failed, see $outdir/*.log" >&2
+      exit 1
+   fi
+
+   # merge in the job order, so the tree has the same event order as a single job
+   trees=()
+   hists=()
+   for ((job = 0; job < njobs; job++)); do
+      jobname=$(printf "%03d" "$job")
+      [ -f "$outdir/$jobname.root" ] && trees+=("$outdir/$jobname.root")
+      [ -f "$outdir/$jobname.hist.root" ] && hists+=("$outdir/$jobname.hist.root")
+   done
+   if [ ${#trees[@]} -gt 0 ]; then
+      say "merge trees -> $outdir/$tag.root"
+      chadd -f "$outdir/$tag.root" "${trees[@]}" >/dev/null || exit 1
+   fi
+   if [ ${#hists[@]} -gt 0 ]; then
+      say "merge histograms -> $outdir/$tag.hist.root"
+      hadd -f "$outdir/$tag.hist.root" "${hists[@]}" >/dev/null || exit 1
+      # ratios are not additive, recalculate them from the merged counts
+      if ! root -l -b -q "macro/solidangle.C(\"$outdir/$tag.hist.root\")" >/dev/null; then
+         say "failed to recalculate the solid angle of $outdir/$tag.hist.root" >&2
+         exit 1
+      fi
+   fi
+   say "done"
+}
+
+# script start
+while getopts "hn:j:s:" OPT; do
+   case $OPT in
+   h)
+      usage
+      exit 0
+      ;;
+   n)
+      nevent=$OPTARG
+      ;;
+   j)
+      njobs=$OPTARG
+      ;;
+   s)
+      seed=$OPTARG
+      ;;
+   \?)
+      err "invalid option!"
+      ;;
+   esac
+done
+shift $((OPTIND - 1))
+
+main "$@"
@@ -3,43 +3,188 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022?
- * @note    last modified: 2024-08-23 20:49:16
+ * @note    last modified: 2026-10-18 21:58:41
  * @details originally made by J. W. Hwang
  */
 
 #include "TEvtNumProcessor.h"
 
+#include <TSystem.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
 using art::crib::TEvtNumProcessor;
 
 ClassImp(TEvtNumProcessor);
 
-TEvtNumProcessor::TEvtNumProcessor() : fCurNum(0), fLimEvNum(0), fPriEv(kFALSE), fPriEvNum(100) {
+namespace {
+TString FormatETA(Double_t sec) {
+    if (sec < 0.0)
+        return "--:--:--";
+    const Long64_t s = static_cast<Long64_t>(sec + 0.5);
+    return TString::Format("%02lld:%02lld:%02lld", s / 3600, (s / 60) % 60, s % 60);
+}
+} // namespace
+
+TEvtNumProcessor::TEvtNumProcessor()
+    : fCurNum(0), fLimEvNum(0), fPriEv(kFALSE), fPriEvNum(100), fLastReport(0.0), fStartBytes(-1),
+      fInputBytes(0) {
     RegisterProcessorParameter("EventNumLimit", "the limit of the event number",
                                fLimEvNum, 0);
     RegisterOptionalParameter("PrintEvent", "print the current event number",
                               fPriEv, kFALSE);
     RegisterProcessorParameter("PrintEventNum", "event number of frequency",
                                fPriEvNum, 100);
+    RegisterOptionalParameter("PrintInterval", "minimum interval of the output (s)",
+                              fPrintInterval, 1.0);
+    RegisterOptionalParameter("RateWindow", "length of the sliding window of the rate (s)",
+                              fRateWindow, 10.0);
+    RegisterOptionalParameter("TotalEvents", "expected number of events for ETA, 0: unknown",
+                              fTotalEvents, 0);
+    RegisterOptionalParameter("InputFiles", "input files, ETA from the size if TotalEvents is unknown",
+                              fInputFiles, StringVec_t());
+    RegisterOptionalParameter("LogFile", "time series of the rate, empty: no output",
+                              fLogFileName, TString(""));
 }
 
 TEvtNumProcessor::~TEvtNumProcessor() {}
 
-void TEvtNumProcessor::Init(TEventCollection *) {}
+void TEvtNumProcessor::Init(TEventCollection *) {
+    fPriEvNum = std::max(fPriEvNum, 1);
+    fCurNum = 0;
+    fWindow.clear();
+
+    fInputBytes = 0;
+    for (const auto &file : fInputFiles) {
+        FileStat_t info;
+        if (gSystem->GetPathInfo(file, info) != 0) {
+            Warning("Init", "cannot access %s, ETA may be wrong", file.Data());
+            continue;
+        }
+        fInputBytes += info.fSize;
+    }
+
+    if (fLogFile.is_open())
+        fLogFile.close();
+    if (!fLogFileName.IsNull()) {
+        fLogFile.open(fLogFileName.Data());
+        if (!fLogFile) {
+            SetStateError(TString::Format("cannot open %s", fLogFileName.Data()));
+            return;
+        }
+        fLogFile << "# time(s) events evt/s evt/s(avg) MB/s MB/s(avg) ETA(s) peakRSS(MB)\n";
+    }
+}
 
 void TEvtNumProcessor::EndOfRun() {
-    std::cout << "  Event Number: " << fCurNum << std::endl;
+    if (fCurNum == 0) {
+        std::cout << "  Event Number: " << fCurNum << std::endl;
+        return;
+    }
+    // the log file is kept open for the following runs, and closed at the destructor
+    Report(kTRUE);
 }
 
 void TEvtNumProcessor::Process() {
     fCurNum++;
-    if (fPriEv && !(fCurNum % fPriEvNum)) {
-        std::cout << "\r  Event Number: " << fCurNum;
-        std::cout.flush();
+    if (fCurNum == 1) {
+        fStart = Clock::now();
+        fStartBytes = GetReadBytes();
+        fLastReport = 0.0;
+        fWindow.clear();
+        fWindow.push_back({0.0, 0, fStartBytes < 0 ? -1 : 0});
+    }
+
+    // the clock is read only every PrintEventNum events
+    if ((fPriEv || fLogFile.is_open()) && !(fCurNum % fPriEvNum)) {
+        const Double_t t = std::chrono::duration<Double_t>(Clock::now() - fStart).count();
+        if (t - fLastReport >= fPrintInterval)
+            Report(kFALSE);
     }
 
+    // the last event number is printed at EndOfRun
     if (fLimEvNum && fCurNum >= fLimEvNum) {
-        std::cout << "\r  Event Number: " << fCurNum << std::endl;
-        Info("Process", "The number of event is limited to %d.", fCurNum);
+        if (fPriEv)
+            std::cout << std::endl; // end the progress line
+        Info("Process", "The number of event is limited to %lld.", fCurNum);
         SetStopLoop();
     }
 }
+
+void TEvtNumProcessor::Report(Bool_t is_last) {
+    const Double_t t = std::chrono::duration<Double_t>(Clock::now() - fStart).count();
+    const Long64_t read = GetReadBytes();
+    const Long64_t bytes = (read >= 0 && fStartBytes >= 0) ? read - fStartBytes : -1;
+    fLastReport = t;
+
+    fWindow.push_back({t, fCurNum, bytes});
+    while (fWindow.size() > 2 && t - fWindow.front().fTime > fRateWindow) {
+        fWindow.pop_front();
+    }
+    const Sample &first = fWindow.front();
+    const Double_t dt = t - first.fTime;
+
+    const Double_t rate_cum = t > 0.0 ? fCurNum / t : 0.0;
+    const Double_t rate_win = dt > 0.0 ? (fCurNum - first.fEvents) / dt : rate_cum;
+    const Double_t mb_cum = (bytes >= 0 && t > 0.0) ? bytes / t / 1.0e6 : -1.0;
+    const Double_t mb_win =
+        (bytes >= 0 && first.fBytes >= 0 && dt > 0.0) ? (bytes - first.fBytes) / dt / 1.0e6 : mb_cum;
+
+    Double_t eta = -1.0;
+    const Long64_t total = fTotalEvents > 0 ? fTotalEvents : fLimEvNum;
+    if (total > 0 && rate_win > 0.0) {
+        eta = std::max(total - fCurNum, 0LL) / rate_win;
+    } else if (fInputBytes > 0 && bytes >= 0 && mb_win > 0.0) {
+        eta = std::max(fInputBytes - bytes, 0LL) / (mb_win * 1.0e6);
+    }
+    const Double_t rss = GetPeakRSS();
+
+    if (fLogFile.is_open()) {
+        fLogFile << TString::Format("%.3f %lld %.1f %.1f %.3f %.3f %.1f %.1f\n", t, fCurNum, rate_win, rate_cum,
+                                    mb_win, mb_cum, eta, rss)
+                 << std::flush;
+    }
+
+    if (is_last) {
+        std::cout << "\r  Event Number: " << fCurNum << std::endl;
+        std::cout << TString::Format("  %.1f s, %.1f evt/s", t, rate_cum);
+        if (bytes >= 0)
+            std::cout << TString::Format(", %.1f MB read (%.2f MB/s)", bytes / 1.0e6, mb_cum);
+        std::cout << TString::Format(", peak RSS %.0f MB", rss) << std::endl;
+        return;
+    }
+    if (!fPriEv)
+        return;
+
+    std::cout << TString::Format("\r  Event Number: %lld  %.1f evt/s (avg %.1f)", fCurNum, rate_win, rate_cum);
+    if (mb_win >= 0.0)
+        std::cout << TString::Format("  %.2f MB/s (avg %.2f)", mb_win, mb_cum);
+    std::cout << "  ETA " << FormatETA(eta) << TString::Format("  RSS %.0f MB   ", rss);
+    std::cout.flush();
+}
+
+Long64_t TEvtNumProcessor::GetReadBytes() {
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    Long64_t value = 0;
+    while (io >> key >> value) {
+        if (key == "rchar:")
+            return value;
+    }
+    return -1;
+}
+
+Double_t TEvtNumProcessor::GetPeakRSS() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1.0e6; // bytes
+#else
+    return usage.ru_maxrss / 1.0e3; // kB
+#endif
+}
@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022?
- * @note    last modified: 2025-01-08 10:27:37
+ * @note    last modified: 2026-10-18 21:58:41
  * @details originally made by J. W. Hwang
  */
 
@@ -12,10 +12,22 @@
 
 #include "TProcessor.h"
 
+#include <chrono>
+#include <deque>
+#include <fstream>
+
 namespace art::crib {
 class TEvtNumProcessor;
 }
 
+/**
+ * The event number is printed with the event rate (events/s, window and cumulative),
+ * the read rate (MB/s, from /proc/self/io on Linux), the ETA and the peak RSS.
+ * The terminal line is updated at most once per PrintInterval seconds.
+ * The ETA is estimated from TotalEvents (or EventNumLimit) if it is given, otherwise from
+ * the total size of InputFiles and the read rate. If LogFile is given, the same numbers are
+ * written there at every update as a time series.
+ */
 class art::crib::TEvtNumProcessor : public TProcessor {
 
   public:
@@ -27,12 +39,39 @@ class art::crib::TEvtNumProcessor : public TProcessor {
     void Process() override;
 
   private:
-    Int_t fCurNum;
+    using Clock = std::chrono::steady_clock;
+
+    Long64_t fCurNum;
     Int_t fLimEvNum;
     Bool_t fPriEv;
     Int_t fPriEvNum;
+    Double_t fPrintInterval;  // minimum interval of the report (s)
+    Double_t fRateWindow;     // length of the sliding window (s)
+    Int_t fTotalEvents;       // expected number of events for ETA, 0: unknown
+    StringVec_t fInputFiles;  // input files for the ETA from the read size
+    TString fLogFileName;     // time series output, empty: no output
+
+    /// @brief one report
+    struct Sample {
+        Double_t fTime; // since the first event (s)
+        Long64_t fEvents;
+        Long64_t fBytes; // read since the first event, -1: unknown
+    };
+    std::deque<Sample> fWindow; //!
+    Clock::time_point fStart;   //!
+    Double_t fLastReport;       //! time of the last report (s)
+    Long64_t fStartBytes;       //! bytes read by the process at the first event, -1: unknown
+    Long64_t fInputBytes;       //! total size of the input files, 0: unknown
+    std::ofstream fLogFile;     //!
+
+    void Report(Bool_t is_last);
+
+    /// @brief bytes read by this process (rchar of /proc/self/io), -1 if not available
+    static Long64_t GetReadBytes();
+    /// @brief peak resident set size (MB)
+    static Double_t GetPeakRSS();
 
   protected:
-    ClassDefOverride(TEvtNumProcessor, 1);
+    ClassDefOverride(TEvtNumProcessor, 2);
 };
 #endif // end of #ifdef _TEVTNUMPROCESSOR_H_
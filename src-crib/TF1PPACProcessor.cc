@@ -3,7 +3,7 @@
  * @brief   Created from TPPACPrcessor
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022-08-08 17:25:02
- * @note    last modified: 2024-08-23 20:50:50
+ * @note    last modified: 2026-10-18 21:47:55
  * @details
  */
 
@@ -14,9 +14,12 @@
 #include "TPPACData.h"
 #include "TPPACParameter.h"
 
+#include <TAffineConverter.h>
 #include <TCategorizedData.h>
 #include <TRawDataObject.h>
 
+#include <algorithm>
+
 using art::crib::TF1PPACProcessor;
 
 ClassImp(TF1PPACProcessor);
@@ -25,7 +28,7 @@ ClassImp(TF1PPACProcessor);
 TF1PPACProcessor::TF1PPACProcessor()
     : fPPACOut(nullptr),
       fTimingConverterArray(nullptr), fChargeConverterArray(nullptr),
-      fXConverterArray(nullptr), fYConverterArray(nullptr) {
+      fXConverterArray(nullptr), fYConverterArray(nullptr), fNDet(0) {
     StringVec_t defInput(1, "catdata");
     RegisterInputCollection("InputCollection", "rawdata object returned by TRIDFEventStore",
                             fInputColName, defInput);
@@ -85,6 +88,29 @@ void TF1PPACProcessor::Init(TEventCollection *col) {
     TConverterUtil::SetConverterArray(&fXConverterArray, fXConverterArrayName, col);
     TConverterUtil::SetConverterArray(&fYConverterArray, fYConverterArrayName, col);
 
+    // resolve all the converters once, Process only reads the flat arrays
+    const Int_t nConvPerDet = fHasEachChConverter ? TPPACData::kNRAW : 1;
+    fNDet = 0;
+    for (const auto *array : {fTimingConverterArray, fChargeConverterArray}) {
+        if (array)
+            fNDet = std::max(fNDet, static_cast<Int_t>(array->size()) / nConvPerDet);
+    }
+    for (const auto *array : {fXConverterArray, fYConverterArray}) {
+        if (array)
+            fNDet = std::max(fNDet, static_cast<Int_t>(array->size()) + DETID_ORIGIN);
+    }
+    FlattenConverters(fTimingConverterArray, fTGain, fTOffset, fTConv);
+    FlattenConverters(fChargeConverterArray, fQGain, fQOffset, fQConv);
+    fXConv.assign(fNDet, nullptr);
+    fYConv.assign(fNDet, nullptr);
+    for (Int_t detID = DETID_ORIGIN; detID < fNDet; detID++) {
+        const std::size_t idx = detID - DETID_ORIGIN;
+        if (fXConverterArray && idx < fXConverterArray->size())
+            fXConv[detID] = fXConverterArray->at(idx);
+        if (fYConverterArray && idx < fYConverterArray->size())
+            fYConv[detID] = fYConverterArray->at(idx);
+    }
+
     if (fDoSeparatePPACs) {
         const Int_t &nPPACs = fListOfPPACNames.size();
         const Int_t &nParams = fListOfParameterNames.size();
@@ -100,6 +126,7 @@ void TF1PPACProcessor::Init(TEventCollection *col) {
         }
         fPPACArray.resize(nPPACs, nullptr);
         fPPACParameter.resize(nPPACs, nullptr);
+        fPPACGeometry.resize(nPPACs);
         for (Int_t i = 0; i != nPPACs; i++) {
             if (fListOfPPACNames[i].IsNull())
                 continue;
@@ -112,6 +139,45 @@ void TF1PPACProcessor::Init(TEventCollection *col) {
                 return;
             }
             fPPACParameter[i] = prm;
+
+            PPACGeometry &geo = fPPACGeometry[i];
+            for (Int_t k = 0; k < 2; k++) {
+                geo.fDTOffset[k] = (fDoInsideOffset ? prm->GetInsideOffset(k) : 0.0) -
+                                   (fDoOutsideOffset ? prm->GetOutsideOffset(k) : 0.0);
+                geo.fGeoOffset[k] = fDoGeometryOffset ? prm->GetGeometryOffset(k) : 0.0;
+            }
+            geo.fXSource = prm->GetExchangeXY() ? 1 : 0;
+            geo.fScale[0] = prm->GetNs2mm(geo.fXSource) * 0.5 * (prm->GetReflection() ? -1.0 : 1.0);
+            geo.fScale[1] = prm->GetNs2mm(1 - geo.fXSource) * 0.5;
+            geo.fZ = prm->GetGeometryOffset(2);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// An affine converter is stored as (gain, offset) evaluated at 0 and 1,
+/// the other converters are kept and called in Process.
+/// A missing converter is treated as identity.
+
+void TF1PPACProcessor::FlattenConverters(const std::vector<TConverterBase *> *array, DoubleVec_t &gain,
+                                         DoubleVec_t &offset, std::vector<TConverterBase *> &conv) const {
+    const Int_t size = fNDet * TPPACData::kNRAW;
+    gain.assign(size, 1.0);
+    offset.assign(size, 0.0);
+    conv.assign(size, nullptr);
+    if (!array)
+        return;
+
+    for (Int_t k = 0; k < size; k++) {
+        const std::size_t idx = fHasEachChConverter ? k : k / TPPACData::kNRAW;
+        TConverterBase *const c = idx < array->size() ? array->at(idx) : nullptr;
+        if (!c)
+            continue;
+        if (dynamic_cast<TAffineConverter *>(c)) {
+            offset[k] = c->Convert(0.0);
+            gain[k] = c->Convert(1.0) - offset[k];
+        } else {
+            conv[k] = c;
         }
     }
 }
@@ -123,7 +189,9 @@ void TF1PPACProcessor::Process() {
     fPPACOut->Clear("C");
     if (fDoSeparatePPACs) {
         for (std::vector<TClonesArray *>::iterator it = fPPACArray.begin(); it != fPPACArray.end(); it++) {
-            (*it)->Clear("C");
+            // slots with an empty PPAC name have no output
+            if (*it)
+                (*it)->Clear("C");
         }
     }
 
@@ -168,98 +236,54 @@ void TF1PPACProcessor::Process() {
 
         TPPACData *const ppac = static_cast<TPPACData *>(fPPACOut->ConstructedAt(fPPACOut->GetEntriesFast()));
         ppac->SetDetID(detID);
-        for (Int_t j = 0; j != TPPACData::kNRAW; ++j) {
-            if (IsValid(t[j])) {
-                if (fTimingConverterArray) {
-                    TConverterBase *conv = nullptr;
-                    if (fHasEachChConverter) {
-                        conv = fTimingConverterArray->at(detID * TPPACData::kNRAW + j);
-                    } else {
-                        conv = fTimingConverterArray->at(detID);
-                    }
-                    if (conv) {
-                        ppac->SetT(conv->Convert(t[j]), j);
-                    } else {
-                        ppac->SetT(t[j], j);
-                    }
-                } else {
-                    ppac->SetT(t[j], j);
-                }
+        if (detID >= DETID_ORIGIN && detID < fNDet) {
+            const Int_t base = detID * TPPACData::kNRAW;
+            for (Int_t j = 0; j != TPPACData::kNRAW; ++j) {
+                const Int_t k = base + j;
+                if (IsValid(t[j]))
+                    ppac->SetT(fTConv[k] ? fTConv[k]->Convert(t[j]) : fTOffset[k] + fTGain[k] * t[j], j);
+                if (IsValid(q[j]))
+                    ppac->SetQ(fQConv[k] ? fQConv[k]->Convert(q[j]) : fQOffset[k] + fQGain[k] * q[j], j);
             }
-
-            if (IsValid(q[j])) {
-                if (fChargeConverterArray) {
-                    TConverterBase *conv = nullptr;
-                    if (fHasEachChConverter) {
-                        conv = fChargeConverterArray->at(detID * TPPACData::kNRAW + j);
-                    } else {
-                        conv = fChargeConverterArray->at(detID);
-                    }
-                    ppac->SetQ(conv->Convert(q[j]), j);
-                } else {
+            if (fXConv[detID])
+                ppac->SetXConverter(fXConv[detID]);
+            if (fYConv[detID])
+                ppac->SetYConverter(fYConv[detID]);
+        } else {
+            // no converter for this detector
+            for (Int_t j = 0; j != TPPACData::kNRAW; ++j) {
+                if (IsValid(t[j]))
+                    ppac->SetT(t[j], j);
+                if (IsValid(q[j]))
                     ppac->SetQ(q[j], j);
-                }
             }
         }
-        if (fXConverterArray) {
-            ppac->SetXConverter(fXConverterArray->at(detID - DETID_ORIGIN));
-        }
-        if (fYConverterArray) {
-            ppac->SetYConverter(fYConverterArray->at(detID - DETID_ORIGIN));
-        }
         ppac->Update();
 
-        if (fDoSeparatePPACs && detID < (Int_t)fPPACArray.size()) {
-            Double_t X, Y;
-            TClonesArray *arr = fPPACArray[detID];
-            TPPACData *ppacdata = (TPPACData *)arr->ConstructedAt(arr->GetEntriesFast());
-            TPPACParameter *prm = (TPPACParameter *)fPPACParameter[detID];
-            ppac->Copy(*ppacdata);
-            Double_t dTX = (ppac->GetTX1() - ppac->GetTX2()) / (ppac->GetTX1() + ppac->GetTX2());
-            Double_t dTY = (ppac->GetTY1() - ppac->GetTY2()) / (ppac->GetTY1() + ppac->GetTY2());
-
-            // if (delaylinecalibrated)
-            if (fDoInsideOffset) {
-                dTX += prm->GetInsideOffset(0);
-                dTY += prm->GetInsideOffset(1);
-            }
-
-            // if (line calib ofset)
-            if (fDoOutsideOffset) {
-                dTX -= prm->GetOutsideOffset(0);
-                dTY -= prm->GetOutsideOffset(1);
-            }
+        if (fDoSeparatePPACs && detID < (Int_t)fPPACArray.size() && fPPACArray[detID]) {
+            const PPACGeometry &geo = fPPACGeometry[detID];
+            const TPPACParameter *const prm = fPPACParameter[detID];
+            const Double_t tx1 = ppac->GetTX1(), tx2 = ppac->GetTX2();
+            const Double_t ty1 = ppac->GetTY1(), ty2 = ppac->GetTY2();
+            const Double_t dT[2] = {(tx1 - tx2) / (tx1 + tx2) + geo.fDTOffset[0],
+                                    (ty1 - ty2) / (ty1 + ty2) + geo.fDTOffset[1]};
 
-            ppacdata->SetTXDiff(dTX);
-            ppacdata->SetTYDiff(dTY);
-            // exchange and calibration
-            X = dTX * prm->GetNs2mm(0) * 0.5;
-            Y = dTY * prm->GetNs2mm(1) * 0.5;
-            if (prm->GetExchangeXY()) {
-                Double_t tmp = X;
-                X = Y;
-                Y = tmp;
+            ppac->SetTXDiff(dT[0]);
+            ppac->SetTYDiff(dT[1]);
+            ppac->ResetQualityBit(TDataObject::kInvalid);
+            if (!prm->IsInsideTXSum(ppac->GetTXSum())) {
+                ppac->SetQualityBit(TPPACData::kBadTXSum | TDataObject::kInvalid);
             }
-            if (prm->GetReflection()) {
-                X *= -1;
+            if (!prm->IsInsideTYSum(ppac->GetTYSum())) {
+                ppac->SetQualityBit(TPPACData::kBadTYSum | TDataObject::kInvalid);
             }
+            ppac->SetX(dT[geo.fXSource] * geo.fScale[0] - geo.fGeoOffset[0]);
+            ppac->SetY(dT[1 - geo.fXSource] * geo.fScale[1] - geo.fGeoOffset[1]);
+            ppac->SetZ(geo.fZ);
 
-            // geometry offset
-            if (fDoGeometryOffset) {
-                X -= prm->GetGeometryOffset(0);
-                Y -= prm->GetGeometryOffset(1);
-            }
-            ppacdata->ResetQualityBit(TDataObject::kInvalid);
-            if (!prm->IsInsideTXSum(ppacdata->GetTXSum())) {
-                ppacdata->SetQualityBit(TPPACData::kBadTXSum | TDataObject::kInvalid);
-            }
-            if (!prm->IsInsideTYSum(ppacdata->GetTYSum())) {
-                ppacdata->SetQualityBit(TPPACData::kBadTYSum | TDataObject::kInvalid);
-            }
-            ppacdata->SetX(X);
-            ppacdata->SetY(Y);
-            ppacdata->SetZ(prm->GetGeometryOffset(2));
-            ppacdata->Copy(*ppac);
+            // the both outputs have the same contents
+            TClonesArray *const arr = fPPACArray[detID];
+            ppac->Copy(*arr->ConstructedAt(arr->GetEntriesFast()));
         }
     }
 }
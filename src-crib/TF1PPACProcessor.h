@@ -3,7 +3,7 @@
  * @brief   Created from TPPACProcessor
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022-08-08 17:27:59
- * @note    last modified: 2025-01-08 10:27:48
+ * @note    last modified: 2026-10-18 19:03:12
  * @details
  */
 
@@ -68,7 +68,32 @@ class art::crib::TF1PPACProcessor : public TProcessor {
     Bool_t fDoOutsideOffset;                // flag to calibrate outside offset
     Bool_t fDoGeometryOffset;               // flag to calibrate geometry offset
 
+    /// @brief calibration resolved at Init, index: detID * TPPACData::kNRAW + channel
+    /// value = offset + gain * raw, or conv->Convert(raw) if the converter is not affine
+    Int_t fNDet;                               //! number of detectors covered by the converter arrays
+    DoubleVec_t fTGain;                        //!
+    DoubleVec_t fTOffset;                      //!
+    std::vector<TConverterBase *> fTConv;      //! non-affine timing converter, otherwise nullptr
+    DoubleVec_t fQGain;                        //!
+    DoubleVec_t fQOffset;                      //!
+    std::vector<TConverterBase *> fQConv;      //! non-affine charge converter, otherwise nullptr
+    std::vector<TConverterBase *> fXConv;      //! x position converter of each detID
+    std::vector<TConverterBase *> fYConv;      //! y position converter of each detID
+
+    /// @brief position calculation of each ppac resolved from TPPACParameter and the flags
+    struct PPACGeometry {
+        Double_t fDTOffset[2];  // added to (dTX, dTY): inside offset - outside offset
+        Int_t fXSource;         // 0: X from dTX, 1: X from dTY (exchange XY)
+        Double_t fScale[2];     // mm of (X, Y) per unit of its source, reflection included
+        Double_t fGeoOffset[2]; // subtracted from (X, Y)
+        Double_t fZ;            // z position
+    };
+    std::vector<PPACGeometry> fPPACGeometry; //! index corresponds to the id of PPAC
+
   private:
+    void FlattenConverters(const std::vector<TConverterBase *> *array, DoubleVec_t &gain, DoubleVec_t &offset,
+                           std::vector<TConverterBase *> &conv) const;
+
     // Copy constructor (prohibited)
     TF1PPACProcessor(const TF1PPACProcessor &rhs) = delete;
     // Assignment operator (prohibited)
@@ -0,0 +1,254 @@
+/**
+ * @file    TF3PPACTrackProcessor.cc
+ * @brief   Beam tracking at F3 from the raw timing of two delay-line PPACs.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:21:37
+ * @note    last modified: 2026-10-18 19:21:37
+ * @details
+ */
+
+#include "TF3PPACTrackProcessor.h"
+#include "TProcessorUtil.h"
+
+#include <TAffineConverter.h>
+#include <TCategorizedData.h>
+#include <TMath.h>
+#include <TPPACData.h>
+#include <TPPACParameter.h>
+#include <TRawDataObject.h>
+#include <TTrack.h>
+
+#include <utility>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TF3PPACTrackProcessor);
+
+namespace art::crib {
+
+TF3PPACTrackProcessor::TF3PPACTrackProcessor()
+    : fCategorizedData(nullptr), fOutData(nullptr), fCrossCheckData(nullptr), fNCheck(0), fNMismatch(0) {
+    RegisterInputCollection("InputCollection", "rawdata object returned by TRIDFEventStore", fInputColName,
+                            TString("catdata"));
+    RegisterOutputCollection("OutputCollection", "output array of TTrack", fOutputColName, TString("f3ppac"));
+    RegisterProcessorParameter("CatID", "category ID of the PPACs", fCatID, 4);
+    RegisterProcessorParameter("TimingConverterArray", "name of time converter array (ch2ns)",
+                               fTimingConverterArrayName, TString("prm_dl_ppac_ch2ns"));
+    RegisterProcessorParameter("HasEachChConverter", "converter should be prepared for each channel",
+                               fHasEachChConverter, kTRUE);
+    RegisterProcessorParameter("PPACParameter", "name of ppac parameter", fParameterName, TString("prm_dl_ppac"));
+    StringVec_t defNames;
+    defNames.emplace_back("f3bppac");
+    defNames.emplace_back("f3appac");
+    RegisterProcessorParameter("ListOfPPACNames", "list of names of ppac (index: detID), two of them are used",
+                               fListOfPPACNames, defNames);
+    RegisterOptionalParameter("TrackZ", "z position of the output track (mm)", fTrackZ, 0.0);
+    RegisterOptionalParameter("doInsideOffset", "calibrate delayline offset if non 0", fDoInsideOffset, kTRUE);
+    RegisterOptionalParameter("doOutsideOffset", "calibrate line offset if non 0", fDoOutsideOffset, kTRUE);
+    RegisterOptionalParameter("doGeometryOffset", "calibrate geometry offset if non 0", fDoGeometryOffset, kTRUE);
+    RegisterOptionalParameter("CrossCheckCollection", "TTrack made by the processor chain, empty: no cross-check",
+                              fCrossCheckColName, TString(""));
+    RegisterOptionalParameter("CrossCheckTolerance", "tolerance of the position difference (mm)",
+                              fCrossCheckTolerance, 0.01);
+}
+
+TF3PPACTrackProcessor::~TF3PPACTrackProcessor() {
+    delete fOutData;
+    fOutData = nullptr;
+}
+
+/**
+ * @details
+ * All the converters and TPPACParameter values are read here, and
+ * Process uses only the PPAC structs.
+ */
+void TF3PPACTrackProcessor::Init(TEventCollection *col) {
+    auto result = util::GetInputObject<TCategorizedData>(col, fInputColName, "art::TCategorizedData");
+    if (std::holds_alternative<TString>(result)) {
+        SetStateError(std::get<TString>(result));
+        return;
+    }
+    fCategorizedData = std::get<TCategorizedData **>(result);
+
+    auto result_prm = util::GetParameterObject<TClonesArray>(col, fParameterName, "TClonesArray",
+                                                             "art::TPPACParameter");
+    if (std::holds_alternative<TString>(result_prm)) {
+        SetStateError(std::get<TString>(result_prm));
+        return;
+    }
+    const TClonesArray *const prm_array = std::get<TClonesArray *>(result_prm);
+
+    const TClonesArray *conv_array = nullptr;
+    auto result_conv = util::GetParameterObject<TClonesArray>(col, fTimingConverterArrayName, "TClonesArray",
+                                                              "art::TConverterBase");
+    if (std::holds_alternative<TString>(result_conv)) {
+        Warning("Init", "%s, timing is not converted", std::get<TString>(result_conv).Data());
+    } else {
+        conv_array = std::get<TClonesArray *>(result_conv);
+    }
+
+    Int_t nPPAC = 0;
+    for (Int_t detID = 0; detID < (Int_t)fListOfPPACNames.size(); detID++) {
+        if (fListOfPPACNames[detID].IsNull())
+            continue;
+        if (nPPAC == 2) {
+            SetStateError("ListOfPPACNames should contain two PPACs");
+            return;
+        }
+        const auto *prm = dynamic_cast<const TPPACParameter *>(prm_array->FindObject(fListOfPPACNames[detID]));
+        if (!prm) {
+            SetStateError(TString::Format("No such parameter '%s' is found", fListOfPPACNames[detID].Data()));
+            return;
+        }
+
+        PPAC &ppac = fPPAC[nPPAC++];
+        ppac.fDetID = detID;
+        ppac.fPrm = prm;
+        for (Int_t ch = 0; ch < kNPosCh; ch++) {
+            ppac.fGain[ch] = 1.0;
+            ppac.fOffset[ch] = 0.0;
+            ppac.fConv[ch] = nullptr;
+            if (!conv_array)
+                continue;
+            const Int_t idx = fHasEachChConverter ? detID * TPPACData::kNRAW + ch : detID;
+            auto *conv = static_cast<TConverterBase *>(conv_array->At(idx));
+            if (!conv)
+                continue;
+            if (dynamic_cast<TAffineConverter *>(conv)) {
+                ppac.fOffset[ch] = conv->Convert(0.0);
+                ppac.fGain[ch] = conv->Convert(1.0) - ppac.fOffset[ch];
+            } else {
+                ppac.fConv[ch] = conv;
+            }
+        }
+        for (Int_t k = 0; k < 2; k++) {
+            ppac.fDTOffset[k] = (fDoInsideOffset ? prm->GetInsideOffset(k) : 0.0) -
+                                (fDoOutsideOffset ? prm->GetOutsideOffset(k) : 0.0);
+            ppac.fGeoOffset[k] = fDoGeometryOffset ? prm->GetGeometryOffset(k) : 0.0;
+        }
+        ppac.fXSource = prm->GetExchangeXY() ? 1 : 0;
+        ppac.fScale[0] = prm->GetNs2mm(ppac.fXSource) * 0.5 * (prm->GetReflection() ? -1.0 : 1.0);
+        ppac.fScale[1] = prm->GetNs2mm(1 - ppac.fXSource) * 0.5;
+        ppac.fZ = prm->GetGeometryOffset(2);
+    }
+    if (nPPAC != 2) {
+        SetStateError("ListOfPPACNames should contain two PPACs");
+        return;
+    }
+    if (fPPAC[0].fZ > fPPAC[1].fZ) {
+        std::swap(fPPAC[0], fPPAC[1]);
+    }
+    if (!(fPPAC[1].fZ > fPPAC[0].fZ)) {
+        SetStateError("z positions of the two PPACs are the same");
+        return;
+    }
+    fIndex.assign(fListOfPPACNames.size(), -1);
+    fIndex[fPPAC[0].fDetID] = 0;
+    fIndex[fPPAC[1].fDetID] = 1;
+
+    if (!fCrossCheckColName.IsNull()) {
+        auto result_check = util::GetInputObject<TClonesArray>(col, fCrossCheckColName, "TClonesArray", "art::TTrack");
+        if (std::holds_alternative<TString>(result_check)) {
+            SetStateError(std::get<TString>(result_check));
+            return;
+        }
+        fCrossCheckData = std::get<TClonesArray **>(result_check);
+        fNCheck = fNMismatch = 0;
+    }
+
+    fOutData = new TClonesArray("art::TTrack");
+    fOutData->SetName(fOutputColName);
+    col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+
+    Info("Init", "CatID: %d, %s (z = %.1lf mm) and %s (z = %.1lf mm) => %s", fCatID,
+         fListOfPPACNames[fPPAC[0].fDetID].Data(), fPPAC[0].fZ, fListOfPPACNames[fPPAC[1].fDetID].Data(),
+         fPPAC[1].fZ, fOutputColName.Data());
+}
+
+void TF3PPACTrackProcessor::Process() {
+    fOutData->Clear("C");
+
+    const TObjArray *const cat = (*fCategorizedData)->FindCategory(fCatID);
+    Double_t x[2], y[2];
+    UInt_t found = 0;
+    UInt_t quality = 0;
+    const Int_t n = cat ? cat->GetEntriesFast() : 0;
+    for (Int_t i = 0; i != n; ++i) {
+        const TObjArray *const det = static_cast<TObjArray *>(cat->At(i));
+        Int_t raw[kNPosCh];
+        Int_t detID = kInvalidI;
+        Bool_t isComplete = kTRUE;
+        for (Int_t ch = 0; ch < kNPosCh && isComplete; ch++) {
+            const TObjArray *const tArray = static_cast<TObjArray *>(det->At(ch));
+            const TRawDataObject *const hit =
+                (tArray && tArray->GetEntriesFast()) ? static_cast<TRawDataObject *>(tArray->At(0)) : nullptr;
+            isComplete = hit != nullptr;
+            if (hit) {
+                raw[ch] = hit->GetValue();
+                detID = hit->GetDetID();
+            }
+        }
+        if (!isComplete || detID < 0 || detID >= (Int_t)fIndex.size() || fIndex[detID] < 0)
+            continue;
+
+        const Int_t k = fIndex[detID];
+        const PPAC &ppac = fPPAC[k];
+        Double_t t[kNPosCh];
+        for (Int_t ch = 0; ch < kNPosCh; ch++) {
+            t[ch] = ppac.fConv[ch] ? ppac.fConv[ch]->Convert(raw[ch]) : ppac.fOffset[ch] + ppac.fGain[ch] * raw[ch];
+        }
+        const Double_t dT[2] = {t[0] - t[1] + ppac.fDTOffset[0], t[2] - t[3] + ppac.fDTOffset[1]};
+        x[k] = dT[ppac.fXSource] * ppac.fScale[0] - ppac.fGeoOffset[0];
+        y[k] = dT[1 - ppac.fXSource] * ppac.fScale[1] - ppac.fGeoOffset[1];
+        if (!ppac.fPrm->IsInsideTXSum(t[0] + t[1]))
+            quality |= kBadTXSumA << (2 * k);
+        if (!ppac.fPrm->IsInsideTYSum(t[2] + t[3]))
+            quality |= kBadTYSumA << (2 * k);
+        found |= 1 << k;
+    }
+
+    TTrack *track = nullptr;
+    if (found == 3) {
+        const Double_t dz = fPPAC[1].fZ - fPPAC[0].fZ;
+        const Double_t tan_a = (x[1] - x[0]) / dz;
+        const Double_t tan_b = (y[1] - y[0]) / dz;
+        track = static_cast<TTrack *>(fOutData->ConstructedAt(0));
+        track->SetID(0);
+        track->SetPos(x[0] + (fTrackZ - fPPAC[0].fZ) * tan_a, y[0] + (fTrackZ - fPPAC[0].fZ) * tan_b, fTrackZ);
+        track->SetAngle(TMath::ATan(tan_a), TMath::ATan(tan_b));
+        track->ResetQualityBit(TDataObject::kInvalid);
+        if (quality) {
+            track->SetQualityBit(quality | TDataObject::kInvalid);
+        }
+    }
+
+    if (fCrossCheckData) {
+        CrossCheck(track);
+    }
+}
+
+void TF3PPACTrackProcessor::CrossCheck(const TTrack *track) {
+    const TClonesArray *const chain_array = *fCrossCheckData;
+    const auto *chain = chain_array->GetEntriesFast() ? static_cast<const TTrack *>(chain_array->At(0)) : nullptr;
+    if (!track && !chain)
+        return;
+
+    fNCheck++;
+    Bool_t isSame = track && chain;
+    for (Int_t k = 0; k < 2 && isSame; k++) {
+        const Double_t z = fPPAC[k].fZ;
+        isSame = TMath::Abs(track->GetX(z) - chain->GetX(z)) < fCrossCheckTolerance &&
+                 TMath::Abs(track->GetY(z) - chain->GetY(z)) < fCrossCheckTolerance;
+    }
+    if (!isSame) {
+        fNMismatch++;
+    }
+}
+
+void TF3PPACTrackProcessor::PostLoop() {
+    if (!fCrossCheckData)
+        return;
+    Info("PostLoop", "cross-check with %s: %lld / %lld events are different (tolerance %.3lf mm)",
+         fCrossCheckColName.Data(), fNMismatch, fNCheck, fCrossCheckTolerance);
+}
+
+} // namespace art::crib
@@ -0,0 +1,126 @@
+/**
+ * @file    TF3PPACTrackProcessor.h
+ * @brief   Beam tracking at F3 from the raw timing of two delay-line PPACs.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:21:37
+ * @note    last modified: 2026-10-18 19:21:37
+ * @details
+ */
+
+#ifndef CRIB_TF3PPACTRACKPROCESSOR_H_
+#define CRIB_TF3PPACTRACKPROCESSOR_H_
+
+#include <TProcessor.h>
+
+class TClonesArray;
+
+namespace art {
+class TCategorizedData;
+class TConverterBase;
+class TPPACParameter;
+class TTrack;
+} // namespace art
+
+namespace art::crib {
+
+/**
+ * @class TF3PPACTrackProcessor
+ * @brief Makes the TTrack directly from the categorized PPAC timing (one pass, no TPPACData).
+ *
+ * Replaces the chain of art::TPPACProcessor (ppac/dlppac.yaml) and art::TPPACTrackingProcessor
+ * (ppac/ppactrack.yaml) for the two-PPAC setup. For each PPAC,
+ * - TX1, TX2, TY1, TY2 are converted with the ch2ns converters (resolved at Init),
+ * - dT = (TX1 - TX2, TY1 - TY2) + delayoffset - linecalib, and the position is
+ *   dT * ns2mm / 2 with exchange, reflection and geometry offset of TPPACParameter,
+ * - TX1 + TX2 and TY1 + TY2 are checked with TXSumLimit and TYSumLimit.
+ * The track is the line through the two positions, given at z = TrackZ with the angles (rad).
+ * It is filled only if all four timings of both PPACs exist. If a sum is out of the limit,
+ * the corresponding EQualityBit and TDataObject::kInvalid are set.
+ *
+ * If CrossCheckCollection is set (the TTrack of the processor chain), the two tracks are
+ * compared at the z of the PPACs and the number of the different events is shown at the end.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: proc_f3_track
+ *     type: art::crib::TF3PPACTrackProcessor
+ *     parameter:
+ *       CatID: 4                                    # [Int_t] category ID of the PPACs
+ *       CrossCheckCollection: ""                    # [TString] TTrack made by the processor chain
+ *       CrossCheckTolerance: 0.01                   # [Double_t] tolerance of the cross-check (mm)
+ *       HasEachChConverter: 1                       # [Bool_t] converter for each channel
+ *       InputCollection: catdata                    # [TString] categorized data
+ *       ListOfPPACNames: [f3bppac, f3appac]         # [StringVec_t] index: detID, two names are used
+ *       OutputCollection: f3ppac                    # [TString] output array of TTrack
+ *       PPACParameter: prm_dl_ppac                  # [TString] array of TPPACParameter
+ *       TimingConverterArray: prm_dl_ppac_ch2ns     # [TString] array of TConverterBase (ch2ns)
+ *       TrackZ: 0.0                                 # [Double_t] z of the output track (mm)
+ *       doGeometryOffset: 1                         # [Bool_t]
+ *       doInsideOffset: 1                           # [Bool_t]
+ *       doOutsideOffset: 1                          # [Bool_t]
+ * ```
+ */
+class TF3PPACTrackProcessor : public TProcessor {
+  public:
+    /// @brief quality bits of the output track, A: upstream, B: downstream PPAC
+    enum EQualityBit { kBadTXSumA = 1 << 8, kBadTYSumA = 1 << 9, kBadTXSumB = 1 << 10, kBadTYSumB = 1 << 11 };
+
+    TF3PPACTrackProcessor();
+    ~TF3PPACTrackProcessor() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+    void PostLoop() override;
+
+  private:
+    /// @brief number of timing channels used for the position (TX1, TX2, TY1, TY2)
+    static constexpr Int_t kNPosCh = 4;
+
+    TString fInputColName;                  ///< categorized data
+    TString fOutputColName;                 ///< output array of TTrack
+    TCategorizedData **fCategorizedData;    ///<!
+    TClonesArray *fOutData;                 ///<!
+    Int_t fCatID;                           ///< category ID of the PPACs
+    TString fTimingConverterArrayName;      ///< ch2ns converter array
+    Bool_t fHasEachChConverter;             ///< converter for each channel
+    TString fParameterName;                 ///< TPPACParameter array
+    StringVec_t fListOfPPACNames;           ///< index corresponds to the detID
+    Double_t fTrackZ;                       ///< z of the output track position (mm)
+    Bool_t fDoInsideOffset;                 ///< add delayoffset
+    Bool_t fDoOutsideOffset;                ///< subtract linecalib
+    Bool_t fDoGeometryOffset;               ///< subtract geometry offset
+    TString fCrossCheckColName;             ///< TTrack of the processor chain, empty: no cross-check
+    Double_t fCrossCheckTolerance;          ///< (mm)
+    TClonesArray **fCrossCheckData;         ///<!
+
+    /// @brief calibration and geometry of one PPAC resolved at Init
+    struct PPAC {
+        Int_t fDetID;
+        Double_t fGain[kNPosCh];
+        Double_t fOffset[kNPosCh];
+        TConverterBase *fConv[kNPosCh]; // non-affine converter, otherwise nullptr
+        Double_t fDTOffset[2];          // added to (dTX, dTY)
+        Int_t fXSource;                 // 0: X from dTX, 1: X from dTY (exchange XY)
+        Double_t fScale[2];             // mm of (X, Y) per ns of its source, reflection included
+        Double_t fGeoOffset[2];         // subtracted from (X, Y)
+        Double_t fZ;
+        const TPPACParameter *fPrm;     // sum limits
+    };
+    PPAC fPPAC[2];             ///<! sorted by z
+    std::vector<Int_t> fIndex; ///<! detID -> index of fPPAC, -1 if not used
+
+    Long64_t fNCheck;    ///<! events compared with the processor chain
+    Long64_t fNMismatch; ///<! events different from the processor chain
+
+    void CrossCheck(const TTrack *track);
+
+    TF3PPACTrackProcessor(const TF3PPACTrackProcessor &rhs) = delete;
+    TF3PPACTrackProcessor &operator=(const TF3PPACTrackProcessor &rhs) = delete;
+
+    ClassDefOverride(TF3PPACTrackProcessor, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TF3PPACTRACKPROCESSOR_H_
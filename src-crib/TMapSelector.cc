@@ -3,11 +3,14 @@
  * @brief   extract one catid data
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-12-23 11:56:21
- * @note    last modified: 2025-03-05 18:39:21
+ * @note    last modified: 2026-10-18 10:48:02
  * @details
  */
 
 #include "TMapSelector.h"
+#include "TProcessorUtil.h"
+
+#include "map/TMappedData.h"
 
 #include <TCategorizedData.h>
 #include <TRawDataObject.h>
@@ -16,9 +19,13 @@
 ClassImp(art::crib::TMapSelector);
 
 namespace art::crib {
-TMapSelector::TMapSelector() : fCategorizedData(nullptr), fOutData(nullptr) {
+TMapSelector::TMapSelector()
+    : fCategorizedData(nullptr), fMappedData(nullptr), fMappedCatIndex(-1), fOutData(nullptr) {
     RegisterInputCollection("CategorizedDataName", "name of the segmented data",
                             fCategorizedDataName, TString("catdata"));
+    RegisterOptionalParameter("MappedDataName",
+                              "name of art::crib::TMappedData (TMapCompileProcessor), used instead of catdata if set",
+                              fMappedDataName, TString(""));
     RegisterOutputCollection("OutputCollection", "name of the output branch",
                              fOutputColName, TString("channel"));
 
@@ -33,6 +40,36 @@ TMapSelector::~TMapSelector() {
 }
 
 void TMapSelector::Init(TEventCollection *col) {
+    // CatID validation
+    if (fCatID.size() != 3) {
+        SetStateError("CatID must contain exactly 3 elements: [cid, detid, type]");
+        return;
+    }
+
+    delete fOutData; // Release memory allocated for fOutData if it exists
+    fOutData = new TClonesArray("art::TSimpleData");
+    fOutData->SetName(fOutputColName);
+
+    // compiled map buffers (optional)
+    if (!fMappedDataName.IsNull()) {
+        auto result = util::GetInputObject<TMappedData>(
+            col, fMappedDataName, "art::crib::TMappedData");
+        if (std::holds_alternative<TString>(result)) {
+            SetStateError(std::get<TString>(result));
+            return;
+        }
+        fMappedData = std::get<TMappedData **>(result);
+        fMappedCatIndex = (*fMappedData)->FindCategory(fCatID[0]);
+        if (fMappedCatIndex < 0) {
+            SetStateError(Form("CatID = %d is not compiled in '%s'", fCatID[0], fMappedDataName.Data()));
+            return;
+        }
+        col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+        Info("Init", "%s -> %s, CatID = %d",
+             fMappedDataName.Data(), fOutputColName.Data(), fCatID[0]);
+        return;
+    }
+
     // Categorized data initialization
     void **cat_ref = col->GetObjectRef(fCategorizedDataName);
     if (!cat_ref) {
@@ -48,15 +85,6 @@ void TMapSelector::Init(TEventCollection *col) {
     }
     fCategorizedData = reinterpret_cast<TCategorizedData **>(cat_ref);
 
-    // CatID validation
-    if (fCatID.size() != 3) {
-        SetStateError("CatID must contain exactly 3 elements: [cid, detid, type]");
-        return;
-    }
-
-    delete fOutData; // Release memory allocated for fOutData if it exists
-    fOutData = new TClonesArray("art::TSimpleData");
-    fOutData->SetName(fOutputColName);
     col->Add(fOutputColName, fOutData, fOutputIsTransparent);
     Info("Init", "%s -> %s, CatID = %d",
          fCategorizedDataName.Data(), fOutputColName.Data(), fCatID[0]);
@@ -64,6 +92,10 @@ void TMapSelector::Init(TEventCollection *col) {
 
 void TMapSelector::Process() {
     fOutData->Clear("C");
+    if (fMappedData) {
+        ProcessMappedData();
+        return;
+    }
     if (!fCategorizedData) {
         Warning("Process", "No CategorizedData object");
         return;
@@ -96,4 +128,18 @@ void TMapSelector::Process() {
     }
 }
 
+/// hits are already flat in the compiled buffers, no TObjArray walking
+void TMapSelector::ProcessMappedData() {
+    const TMappedData *const mapped = *fMappedData;
+    int counter = 0;
+    for (int iHit = 0, nHit = mapped->GetNHit(fMappedCatIndex); iHit < nHit; ++iHit) {
+        if (mapped->GetHitDetID(fMappedCatIndex, iHit) != fCatID[1] ||
+            mapped->GetHitType(fMappedCatIndex, iHit) != fCatID[2])
+            continue;
+        auto *outData = static_cast<art::TSimpleData *>(fOutData->ConstructedAt(counter));
+        counter++;
+        outData->SetValue(mapped->GetHitValue(fMappedCatIndex, iHit));
+    }
+}
+
 } // namespace art::crib
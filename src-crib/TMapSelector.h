@@ -3,7 +3,7 @@
  * @brief   extract one catid data
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-12-23 11:56:51
- * @note    last modified: 2025-03-05 18:36:51
+ * @note    last modified: 2026-10-18 10:48:02
  * @details
  */
 
@@ -19,6 +19,8 @@ class TCategorizedData;
 } // namespace art
 
 namespace art::crib {
+class TMappedData;
+
 class TMapSelector : public TProcessor {
   public:
     TMapSelector();
@@ -30,12 +32,17 @@ class TMapSelector : public TProcessor {
   private:
     TString fCategorizedDataName;
     TString fOutputColName;
+    TString fMappedDataName; // optional, output of TMapCompileProcessor
 
     IntVec_t fCatID; //!
 
     TCategorizedData **fCategorizedData; //!
+    TMappedData **fMappedData;           //!
+    Int_t fMappedCatIndex;               //! category index in TMappedData
     TClonesArray *fOutData;              //!
 
+    void ProcessMappedData();
+
     TMapSelector(const TMapSelector &) = delete;
     TMapSelector &operator=(const TMapSelector &) = delete;
 
@@ -0,0 +1,125 @@
+/**
+ * @file    TProcessorProfile.cc
+ * @brief   Cost table of the steering sections measured by TProfileProcessor.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:34:10
+ * @note    last modified: 2026-10-18 22:28:16
+ * @details
+ */
+
+#include "TProcessorProfile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace art::crib {
+
+TProcessorProfile *TProcessorProfile::Instance() {
+    static TProcessorProfile instance;
+    return &instance;
+}
+
+void TProcessorProfile::Clear() {
+    fSections.clear();
+    fLastProcess = fLastInit = 0;
+    fCalibTick = Now();
+    fCalibTime = std::chrono::steady_clock::now();
+    fResetRequested = kFALSE;
+}
+
+void TProcessorProfile::Reset() {
+    for (auto &sec : fSections) {
+        sec.fCalls = 0;
+        sec.fTotal = 0;
+        sec.fMax = 0;
+        sec.fInit = 0;
+        std::fill(sec.fHist.begin(), sec.fHist.end(), 0);
+    }
+}
+
+Int_t TProcessorProfile::AddSection(const TString &label) {
+    for (Int_t i = 0; i < (Int_t)fSections.size(); i++) {
+        if (fSections[i].fLabel == label)
+            return i;
+    }
+    fSections.emplace_back();
+    fSections.back().fLabel = label;
+    return fSections.size() - 1;
+}
+
+Double_t TProcessorProfile::GetSecondsPerTick() const {
+#if defined(__x86_64__) || defined(__i386__)
+    const Double_t sec = std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - fCalibTime).count();
+    const Tick_t ticks = Now() - fCalibTick;
+    return ticks > 0 ? sec / ticks : 0.0;
+#else
+    return 1.0e-9;
+#endif
+}
+
+Double_t TProcessorProfile::GetBinCenter(Int_t bin) {
+    if (bin < kNSubBins)
+        return bin;
+    const Int_t msb = bin / kNSubBins;
+    const Double_t width = std::ldexp(1.0, msb - 2);
+    return std::ldexp(1.0, msb) + (bin % kNSubBins + 0.5) * width;
+}
+
+Double_t TProcessorProfile::GetPercentile(const Section &sec, Double_t q) const {
+    if (sec.fCalls == 0)
+        return 0.0;
+    const Long64_t target = std::max<Long64_t>(1, static_cast<Long64_t>(q * sec.fCalls));
+    Long64_t sum = 0;
+    for (Int_t bin = 0; bin < kNBins; bin++) {
+        sum += sec.fHist[bin];
+        if (sum >= target)
+            return GetBinCenter(bin);
+    }
+    return sec.fMax;
+}
+
+void TProcessorProfile::Print(const TString &sort) const {
+    const Int_t n = fSections.size();
+    if (n == 0) {
+        printf("  no profile, add art::crib::TProfileProcessor to the steering file\n");
+        return;
+    }
+
+    const Double_t spt = GetSecondsPerTick();
+    const Double_t us = spt * 1.0e6;
+    std::vector<Double_t> key(n);
+    Double_t total = 0.0;
+    for (Int_t i = 0; i < n; i++) {
+        const Section &sec = fSections[i];
+        total += sec.fTotal;
+        if (sort == "mean")
+            key[i] = sec.fCalls ? static_cast<Double_t>(sec.fTotal) / sec.fCalls : 0.0;
+        else if (sort == "p99")
+            key[i] = GetPercentile(sec, 0.99);
+        else if (sort == "calls")
+            key[i] = sec.fCalls;
+        else if (sort == "steering")
+            key[i] = -i;
+        else
+            key[i] = sec.fTotal;
+    }
+    std::vector<Int_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&key](Int_t a, Int_t b) { return key[a] > key[b]; });
+
+    printf("  %-24s %10s %10s %6s %10s %10s %10s %10s %10s %10s\n", "section", "calls", "total(s)", "%", "mean(us)",
+           "p50(us)", "p90(us)", "p99(us)", "max(us)", "init(ms)");
+    for (const Int_t i : order) {
+        const Section &sec = fSections[i];
+        const Double_t mean = sec.fCalls ? static_cast<Double_t>(sec.fTotal) / sec.fCalls : 0.0;
+        printf("  %-24s %10lld %10.3f %6.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", sec.fLabel.Data(),
+               sec.fCalls, sec.fTotal * spt, total > 0.0 ? 100.0 * sec.fTotal / total : 0.0, mean * us,
+               GetPercentile(sec, 0.50) * us, GetPercentile(sec, 0.90) * us, GetPercentile(sec, 0.99) * us,
+               sec.fMax * us, sec.fInit * spt * 1.0e3);
+    }
+    printf("  %-24s %10s %10.3f\n", "(sum)", "", total * spt);
+}
+
+} // namespace art::crib
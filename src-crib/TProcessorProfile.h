@@ -0,0 +1,134 @@
+/**
+ * @file    TProcessorProfile.h
+ * @brief   Cost table of the steering sections measured by TProfileProcessor.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:34:10
+ * @note    last modified: 2026-10-18 22:28:16
+ * @details
+ */
+
+#ifndef CRIB_TPROCESSORPROFILE_H_
+#define CRIB_TPROCESSORPROFILE_H_
+
+#include <TString.h>
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace art::crib {
+
+/**
+ * @class TProcessorProfile
+ * @brief Singleton holding the call counts, total and log-scale histogram of the section costs.
+ *
+ * A section is the set of processors between two TProfileProcessor checkpoints.
+ * The time is counted with the TSC on x86 (steady_clock elsewhere) and converted to
+ * seconds with the calibration against steady_clock since the last Reset.
+ * The histogram has 4 bins per octave, so the percentiles are within about 20%.
+ *
+ * The table is read by the "tprof" command (TCmdTprof) while the loop is running,
+ * so the numbers may be a few events behind. The table is modified only in the loop thread:
+ * "tprof reset" calls RequestReset and the next checkpoint zeroes the counters.
+ */
+class TProcessorProfile {
+  public:
+    using Tick_t = ULong64_t;
+
+    static TProcessorProfile *Instance();
+
+    static Tick_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    /// @brief clears all the sections and restarts the calibration, at Init of the first checkpoint
+    void Clear();
+
+    /// @brief zeroes the counters, the sections and their ids are kept
+    void Reset();
+
+    /// @brief asks the loop thread to Reset at its next checkpoint
+    void RequestReset() { fResetRequested = kTRUE; }
+
+    /// @brief performs the requested Reset, called at the checkpoints
+    void ApplyRequestedReset() {
+        if (fResetRequested.load(std::memory_order_relaxed) && fResetRequested.exchange(kFALSE))
+            Reset();
+    }
+
+    /// @brief id of the section, a new section is added if the label is not found
+    Int_t AddSection(const TString &label);
+
+    void AddInit(Int_t id, Tick_t ticks) {
+        if (id < 0 || id >= (Int_t)fSections.size())
+            return;
+        fSections[id].fInit += ticks;
+    }
+    void AddProcess(Int_t id, Tick_t ticks) {
+        if (id < 0 || id >= (Int_t)fSections.size())
+            return;
+        Section &sec = fSections[id];
+        sec.fCalls++;
+        sec.fTotal += ticks;
+        sec.fMax = ticks > sec.fMax ? ticks : sec.fMax;
+        sec.fHist[GetBin(ticks)]++;
+    }
+
+    /**
+     * @brief prints the cost table
+     * @param (sort) "total" (default), "mean", "p99", "calls" or "steering" (no sort)
+     */
+    void Print(const TString &sort = "total") const;
+
+    Int_t GetNSections() const { return fSections.size(); }
+    Double_t GetSecondsPerTick() const;
+
+    Tick_t fLastProcess = 0; ///< time of the last checkpoint in Process
+    Tick_t fLastInit = 0;    ///< time of the last checkpoint in Init
+
+  private:
+    static constexpr Int_t kNSubBins = 4;
+    static constexpr Int_t kNBins = 64 * kNSubBins;
+
+    struct Section {
+        TString fLabel;
+        Long64_t fCalls = 0;
+        Tick_t fTotal = 0;
+        Tick_t fMax = 0;
+        Tick_t fInit = 0;
+        std::vector<Long64_t> fHist = std::vector<Long64_t>(kNBins, 0);
+    };
+    std::vector<Section> fSections;
+
+    Tick_t fCalibTick = 0;
+    std::chrono::steady_clock::time_point fCalibTime;
+    std::atomic<Bool_t> fResetRequested{kFALSE};
+
+    TProcessorProfile() { Clear(); }
+
+    /// @brief log2 of ticks with 2 bits below the leading bit
+    static Int_t GetBin(Tick_t ticks) {
+        if (ticks < kNSubBins)
+            return ticks;
+        const Int_t msb = 63 - __builtin_clzll(ticks);
+        return msb * kNSubBins + ((ticks >> (msb - 2)) & (kNSubBins - 1));
+    }
+    static Double_t GetBinCenter(Int_t bin);
+    Double_t GetPercentile(const Section &sec, Double_t q) const;
+
+    TProcessorProfile(const TProcessorProfile &) = delete;
+    TProcessorProfile &operator=(const TProcessorProfile &) = delete;
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TPROCESSORPROFILE_H_
@@ -0,0 +1,60 @@
+/**
+ * @file    TProfileProcessor.cc
+ * @brief   Checkpoint of the per-processor timing profiler.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:41:52
+ * @note    last modified: 2026-10-18 22:28:16
+ * @details
+ */
+
+#include "TProfileProcessor.h"
+#include "TProcessorProfile.h"
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TProfileProcessor);
+
+namespace art::crib {
+
+TProfileProcessor::TProfileProcessor() : fID(-1) {
+    RegisterOptionalParameter("Label", "section name of the processors since the previous checkpoint", fLabel,
+                              TString(""));
+    RegisterOptionalParameter("Begin", "first checkpoint (clears the profile)", fBegin, kFALSE);
+}
+
+TProfileProcessor::~TProfileProcessor() = default;
+
+void TProfileProcessor::Init(TEventCollection *) {
+    TProcessorProfile *prof = TProcessorProfile::Instance();
+    if (fBegin) {
+        prof->Clear();
+        prof->fLastInit = TProcessorProfile::Now();
+        return;
+    }
+
+    const TProcessorProfile::Tick_t now = TProcessorProfile::Now();
+    if (fLabel.IsNull())
+        fLabel = GetName();
+    fID = prof->AddSection(fLabel);
+    if (prof->fLastInit > 0)
+        prof->AddInit(fID, now - prof->fLastInit);
+    prof->fLastInit = TProcessorProfile::Now();
+}
+
+void TProfileProcessor::Process() {
+    TProcessorProfile *prof = TProcessorProfile::Instance();
+    const TProcessorProfile::Tick_t now = TProcessorProfile::Now();
+    prof->ApplyRequestedReset();
+    if (fID >= 0 && prof->fLastProcess > 0)
+        prof->AddProcess(fID, now - prof->fLastProcess);
+    // the bookkeeping above is not counted in the next section
+    prof->fLastProcess = fBegin ? now : TProcessorProfile::Now();
+}
+
+void TProfileProcessor::PostLoop() {
+    if (!fBegin)
+        return;
+    Info("PostLoop", "processor profile");
+    TProcessorProfile::Instance()->Print();
+}
+
+} // namespace art::crib
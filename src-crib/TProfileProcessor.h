@@ -0,0 +1,67 @@
+/**
+ * @file    TProfileProcessor.h
+ * @brief   Checkpoint of the per-processor timing profiler.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:41:52
+ * @note    last modified: 2026-10-18 22:28:16
+ * @details
+ */
+
+#ifndef CRIB_TPROFILEPROCESSOR_H_
+#define CRIB_TPROFILEPROCESSOR_H_
+
+#include <TProcessor.h>
+
+namespace art::crib {
+
+/**
+ * @class TProfileProcessor
+ * @brief Measures the Init and Process time of the processors since the previous checkpoint.
+ *
+ * Put one with `Begin: 1` at the top of the steering file, and one after each processor
+ * (or group of processors) to be measured. The time from the previous checkpoint is added to
+ * the section `Label` of TProcessorProfile. A checkpoint costs one TSC read and a histogram
+ * fill, and the profiler has no cost if the checkpoints are removed.
+ * The table is printed by the "tprof" command and at the end of the loop by the Begin checkpoint.
+ * If an event is stopped, the sections after the stopping processor are not counted.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: prof_begin
+ *     type: art::crib::TProfileProcessor
+ *     parameter:
+ *       Begin: 1                                    # [Bool_t] first checkpoint
+ *
+ *   - name: proc_ppac
+ *     ...
+ *
+ *   - name: prof_ppac
+ *     type: art::crib::TProfileProcessor
+ *     parameter:
+ *       Label: ppac                                 # [TString] section name, default: processor name
+ * ```
+ */
+class TProfileProcessor : public TProcessor {
+  public:
+    TProfileProcessor();
+    ~TProfileProcessor() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+    void PostLoop() override;
+
+  private:
+    TString fLabel; ///< section name
+    Bool_t fBegin;  ///< first checkpoint, clears the profile at Init
+    Int_t fID;      ///<! section id in TProcessorProfile
+
+    TProfileProcessor(const TProfileProcessor &rhs) = delete;
+    TProfileProcessor &operator=(const TProfileProcessor &rhs) = delete;
+
+    ClassDefOverride(TProfileProcessor, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TPROFILEPROCESSOR_H_
@@ -0,0 +1,261 @@
+/**
+ * @file    TScalerLog.cc
+ * @brief   Append-only memory-mapped scaler log
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 14:02:36
+ * @note    last modified: 2026-10-18 14:02:36
+ * @details
+ */
+
+#include "TScalerLog.h"
+
+#include <TError.h>
+#include <TFile.h>
+#include <TTree.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TScalerLog);
+
+namespace {
+constexpr char kMagic[8] = {'C', 'R', 'I', 'B', 'S', 'C', 'A', 'L'};
+constexpr UInt_t kVersion = 1;
+} // namespace
+
+namespace art::crib {
+
+TScalerLog::TScalerLog() = default;
+
+TScalerLog::~TScalerLog() {
+    Close();
+}
+
+Bool_t TScalerLog::Map(Long64_t capacity) {
+    Unmap();
+    const std::size_t size = sizeof(Header) + capacity * sizeof(Record);
+    if (fWritable && ftruncate(fFd, size) != 0)
+        return kFALSE;
+    void *ptr = mmap(nullptr, size, fWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fFd, 0);
+    if (ptr == MAP_FAILED)
+        return kFALSE;
+    fMap = static_cast<char *>(ptr);
+    fMapSize = size;
+    fCapacity = capacity;
+    fHeader = reinterpret_cast<Header *>(fMap);
+    fRecords = reinterpret_cast<Record *>(fMap + sizeof(Header));
+    return kTRUE;
+}
+
+void TScalerLog::Unmap() {
+    if (fMap)
+        munmap(fMap, fMapSize);
+    fMap = nullptr;
+    fMapSize = 0;
+    fCapacity = 0;
+    fHeader = nullptr;
+    fRecords = nullptr;
+}
+
+Bool_t TScalerLog::OpenWrite(const char *path, Int_t clock_ch, Int_t clock_hz) {
+    Close();
+    fFd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fFd < 0) {
+        ::Error("TScalerLog::OpenWrite", "cannot open %s", path);
+        return kFALSE;
+    }
+    fWritable = kTRUE;
+
+    struct stat st;
+    fstat(fFd, &st);
+    if (st.st_size == 0) {
+        // new log
+        if (!Map(kChunk)) {
+            ::Error("TScalerLog::OpenWrite", "cannot map %s", path);
+            Close();
+            return kFALSE;
+        }
+        std::memcpy(fHeader->fMagic, kMagic, sizeof(kMagic));
+        fHeader->fVersion = kVersion;
+        fHeader->fNumChannel = kNumChannel;
+        fHeader->fClockCh = clock_ch;
+        fHeader->fClockHz = clock_hz;
+        fHeader->fRecordSize = sizeof(Record);
+        fHeader->fReserved = 0;
+        fHeader->fNumRecords = 0;
+        return kTRUE;
+    }
+
+    // append to the existing log
+    Header header;
+    if (st.st_size < (off_t)sizeof(Header) || pread(fFd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.fMagic, kMagic, sizeof(kMagic)) != 0 || header.fVersion != kVersion ||
+        header.fNumChannel != kNumChannel || header.fRecordSize != sizeof(Record)) {
+        ::Error("TScalerLog::OpenWrite", "%s is not a scaler log of this version", path);
+        Close();
+        return kFALSE;
+    }
+    if (header.fClockCh != clock_ch || header.fClockHz != clock_hz) {
+        ::Warning("TScalerLog::OpenWrite", "%s: clock [%d, %d] of the existing log is kept",
+                  path, header.fClockCh, header.fClockHz);
+    }
+    const Long64_t nrec = header.fNumRecords;
+    if (!Map((nrec / kChunk + 1) * kChunk)) {
+        ::Error("TScalerLog::OpenWrite", "cannot map %s", path);
+        Close();
+        return kFALSE;
+    }
+    return kTRUE;
+}
+
+Bool_t TScalerLog::OpenRead(const char *path) {
+    Close();
+    fFd = open(path, O_RDONLY);
+    if (fFd < 0) {
+        ::Error("TScalerLog::OpenRead", "cannot open %s", path);
+        return kFALSE;
+    }
+    fWritable = kFALSE;
+    if (!Refresh()) {
+        ::Error("TScalerLog::OpenRead", "%s is not a scaler log of this version", path);
+        Close();
+        return kFALSE;
+    }
+    return kTRUE;
+}
+
+Bool_t TScalerLog::Refresh() {
+    if (fFd < 0 || fWritable)
+        return fFd >= 0;
+
+    struct stat st;
+    if (fstat(fFd, &st) != 0 || st.st_size < (off_t)sizeof(Header))
+        return kFALSE;
+    const Long64_t capacity = (st.st_size - sizeof(Header)) / sizeof(Record);
+    if (fMap && capacity == fCapacity)
+        return kTRUE;
+    if (!Map(capacity))
+        return kFALSE;
+    return std::memcmp(fHeader->fMagic, kMagic, sizeof(kMagic)) == 0 &&
+           fHeader->fVersion == kVersion && fHeader->fRecordSize == sizeof(Record);
+}
+
+void TScalerLog::Close() {
+    if (fFd < 0)
+        return;
+    Long64_t nrec = -1;
+    if (fWritable && fHeader) {
+        nrec = fHeader->fNumRecords;
+        msync(fMap, fMapSize, MS_SYNC);
+    }
+    Unmap();
+    if (nrec >= 0) {
+        // drop the unused part of the last chunk
+        if (ftruncate(fFd, sizeof(Header) + nrec * sizeof(Record)) != 0)
+            ::Warning("TScalerLog::Close", "cannot truncate the log");
+    }
+    close(fFd);
+    fFd = -1;
+    fWritable = kFALSE;
+}
+
+Bool_t TScalerLog::Append(Long64_t time, const UInt_t *values) {
+    if (!fWritable || !fHeader)
+        return kFALSE;
+    const Long64_t n = fHeader->fNumRecords;
+    if (n >= fCapacity && !Map(fCapacity + kChunk))
+        return kFALSE;
+
+    Record &rec = fRecords[n];
+    rec.fTime = time;
+    std::memcpy(rec.fValue, values, sizeof(rec.fValue));
+    rec.fClock = (fHeader->fClockCh >= 0 && fHeader->fClockCh < kNumChannel) ? values[fHeader->fClockCh] : 0;
+    rec.fReserved = 0;
+    // readers see the record only after it is complete
+    __atomic_store_n(&fHeader->fNumRecords, n + 1, __ATOMIC_RELEASE);
+    return kTRUE;
+}
+
+Long64_t TScalerLog::GetNumRecords() const {
+    if (!fHeader)
+        return 0;
+    const Long64_t n = __atomic_load_n(&fHeader->fNumRecords, __ATOMIC_ACQUIRE);
+    return std::min(n, fCapacity);
+}
+
+Int_t TScalerLog::GetClockCh() const {
+    return fHeader ? fHeader->fClockCh : -1;
+}
+
+Int_t TScalerLog::GetClockHz() const {
+    return fHeader ? fHeader->fClockHz : 0;
+}
+
+Long64_t TScalerLog::FindFirst(Long64_t time) const {
+    const Record *begin = fRecords;
+    const Record *end = fRecords + GetNumRecords();
+    const Record *it = std::lower_bound(begin, end, time,
+                                        [](const Record &rec, Long64_t t) { return rec.fTime < t; });
+    return it - begin;
+}
+
+ULong64_t TScalerLog::GetCounts(Int_t ch, Long64_t t0, Long64_t t1) const {
+    if (ch < 0 || ch >= kNumChannel)
+        return 0;
+    const Long64_t n = GetNumRecords();
+    const Long64_t i0 = FindFirst(t0);
+    const Long64_t i1 = std::min(FindFirst(t1), n - 1);
+    ULong64_t sum = 0;
+    // the difference of consecutive records is taken with 32-bit arithmetic to handle the overflow
+    for (Long64_t i = i0; i < i1; ++i) {
+        sum += (UInt_t)(fRecords[i + 1].fValue[ch] - fRecords[i].fValue[ch]);
+    }
+    return sum;
+}
+
+Double_t TScalerLog::GetRate(Int_t ch, Long64_t t0, Long64_t t1) const {
+    const Int_t clock_ch = GetClockCh();
+    const Int_t clock_hz = GetClockHz();
+    if (clock_ch < 0 || clock_hz <= 0)
+        return 0.;
+    const ULong64_t clock = GetCounts(clock_ch, t0, t1);
+    if (clock == 0)
+        return 0.;
+    return (Double_t)GetCounts(ch, t0, t1) * clock_hz / clock;
+}
+
+Long64_t TScalerLog::ConvertToTree(const char *logfile, const char *rootfile, const char *treename) {
+    TScalerLog log;
+    if (!log.OpenRead(logfile))
+        return -1;
+
+    TFile file(rootfile, "recreate");
+    if (file.IsZombie()) {
+        ::Error("TScalerLog::ConvertToTree", "cannot create %s", rootfile);
+        return -1;
+    }
+    // the tree is owned by the file
+    auto *tree = new TTree(treename, Form("scaler log (clock ch %d, %d Hz)", log.GetClockCh(), log.GetClockHz()));
+    Record rec;
+    tree->Branch("time", &rec.fTime, "time/L");
+    tree->Branch("sca", rec.fValue, Form("sca[%d]/i", kNumChannel));
+    tree->Branch("clock", &rec.fClock, "clock/i");
+
+    const Long64_t n = log.GetNumRecords();
+    for (Long64_t i = 0; i < n; ++i) {
+        rec = log.GetRecord(i);
+        tree->Fill();
+    }
+    tree->Write();
+    file.Close();
+    ::Info("TScalerLog::ConvertToTree", "%s -> %s (%lld entries)", logfile, rootfile, n);
+    return n;
+}
+
+} // namespace art::crib
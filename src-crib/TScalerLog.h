@@ -0,0 +1,132 @@
+/**
+ * @file    TScalerLog.h
+ * @brief   Append-only memory-mapped scaler log
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 14:02:36
+ * @note    last modified: 2026-10-18 14:02:36
+ * @details
+ */
+
+#ifndef CRIB_TSCALERLOG_H_
+#define CRIB_TSCALERLOG_H_
+
+#include <Rtypes.h>
+
+#include <cstddef>
+
+namespace art::crib {
+/**
+ * @class TScalerLog
+ * @brief Binary log of the scaler values, written by TScalerMonitorProcessor.
+ *
+ * The file consists of a Header followed by fixed-size Records
+ * (unix time, all scaler counters, clock counter) in native byte order.
+ * The writer maps the file with mmap and grows it in chunks, so an append is
+ * a single copy. The number of valid records is kept in the header, so the
+ * log can be read while it is written (call Refresh() to see new records).
+ *
+ * ```cpp
+ * art::crib::TScalerLog log;
+ * log.OpenRead("output/scaler/run0001.scalog");
+ * Double_t rate = log.GetRate(0, t_start, t_stop); // cps of ch 0
+ * art::crib::TScalerLog::ConvertToTree("run0001.scalog", "run0001_scaler.root");
+ * ```
+ */
+class TScalerLog {
+  public:
+    static constexpr Int_t kNumChannel = 32;
+
+    /// @brief file header
+    struct Header {
+        char fMagic[8];         ///< "CRIBSCAL"
+        UInt_t fVersion;        ///< format version
+        UInt_t fNumChannel;     ///< kNumChannel
+        Int_t fClockCh;         ///< channel of the clock
+        Int_t fClockHz;         ///< frequency of the clock
+        UInt_t fRecordSize;     ///< sizeof(Record)
+        UInt_t fReserved;       ///< padding
+        ULong64_t fNumRecords;  ///< number of valid records
+    };
+
+    /// @brief one scaler readout
+    struct Record {
+        Long64_t fTime;             ///< unix time (s)
+        UInt_t fValue[kNumChannel]; ///< counter values
+        UInt_t fClock;              ///< counter value of the clock channel
+        UInt_t fReserved;           ///< padding
+    };
+
+    TScalerLog();
+    ~TScalerLog();
+
+    /**
+     * @brief Opens the log for appending; a new file is created if it does not exist.
+     */
+    Bool_t OpenWrite(const char *path, Int_t clock_ch, Int_t clock_hz);
+    /**
+     * @brief Opens the log read-only.
+     */
+    Bool_t OpenRead(const char *path);
+    /**
+     * @brief Unmaps the file; the writer truncates the file to the written records.
+     */
+    void Close();
+    Bool_t IsOpen() const { return fMap != nullptr; }
+
+    /**
+     * @brief Appends one record, `values` has kNumChannel elements.
+     */
+    Bool_t Append(Long64_t time, const UInt_t *values);
+
+    /**
+     * @brief Maps the records appended by a writer after OpenRead().
+     */
+    Bool_t Refresh();
+
+    Long64_t GetNumRecords() const;
+    const Record &GetRecord(Long64_t i) const { return fRecords[i]; }
+    Int_t GetClockCh() const;
+    Int_t GetClockHz() const;
+
+    /**
+     * @brief Index of the first record with fTime >= time (binary search).
+     */
+    Long64_t FindFirst(Long64_t time) const;
+    /**
+     * @brief Counts of `ch` between the first records at or after t0 and t1 (counter overflow handled).
+     */
+    ULong64_t GetCounts(Int_t ch, Long64_t t0, Long64_t t1) const;
+    /**
+     * @brief Counts per second of `ch` between t0 and t1, measured by the clock channel.
+     */
+    Double_t GetRate(Int_t ch, Long64_t t0, Long64_t t1) const;
+
+    /**
+     * @brief Converts the log into a TTree (time, sca[32], clock).
+     * @return number of entries, or -1 on error
+     */
+    static Long64_t ConvertToTree(const char *logfile, const char *rootfile,
+                                  const char *treename = "scaler");
+
+  private:
+    static constexpr Long64_t kChunk = 4096; ///< records added when the file grows
+
+    Int_t fFd{-1};
+    Bool_t fWritable{kFALSE};
+    char *fMap{nullptr};
+    std::size_t fMapSize{0};
+    Long64_t fCapacity{0}; ///< records in the mapped region
+    Header *fHeader{nullptr};
+    Record *fRecords{nullptr};
+
+    Bool_t Map(Long64_t capacity);
+    void Unmap();
+
+    TScalerLog(const TScalerLog &) = delete;
+    TScalerLog &operator=(const TScalerLog &) = delete;
+
+    ClassDef(TScalerLog, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TSCALERLOG_H_
@@ -3,22 +3,295 @@
  * @brief
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-28 14:26:03
- * @note
+ * @note    last modified: 2026-10-18 13:24:51
  */
 
 #include "TScalerMonitorProcessor.h"
+#include "TScalerLog.h"
 
 #include <TAxis.h>
+#include <TCanvas.h>
+#include <TGraph.h>
 #include <TLegend.h>
+#include <TROOT.h>
 #include <TStyle.h>
+#include <TSystem.h>
+#include <TTimer.h>
+
+#include <atomic>
 #include <chrono>
+#include <vector>
 
 using art::crib::TScalerMonitorProcessor;
 
 ClassImp(TScalerMonitorProcessor);
 
+namespace art::crib {
+/**
+ * @brief Time series of the scaler monitor, drawn by a TTimer in the main thread.
+ *
+ * The event loop only pushes the rates into a single-producer single-consumer
+ * queue (Push), so it never waits for the drawing. The timer (Notify) moves
+ * the samples into fixed-capacity ring buffers and draws them with min/max
+ * decimation.
+ */
+class TScalerMonitorDrawer : public TTimer {
+  public:
+    static const Int_t SCALER_CH = TScalerMonitorProcessor::SCALER_CH;
+
+    TScalerMonitorDrawer(Long_t refresh, Int_t max_points,
+                         Long_t short_duration, Int_t short_capacity,
+                         Long_t long_duration, Int_t long_capacity);
+    ~TScalerMonitorDrawer() override;
+
+    void AddChannel(Int_t ch, const TString &name, Int_t color);
+    /// called from the event loop thread
+    Bool_t Push(Long_t time, Bool_t is_long, const Double_t *rate);
+    /// called from the main thread
+    Bool_t Notify() override;
+
+    Long64_t GetNumDropped() const { return fNumDropped.load(); }
+
+  private:
+    static const Int_t kQueueSize = 256;
+
+    struct Sample {
+        Long_t fTime;
+        Bool_t fIsLong;
+        Double_t fRate[SCALER_CH];
+    };
+
+    /// fixed-capacity ring buffer, the oldest point is overwritten
+    struct Ring {
+        std::vector<Double_t> fTime;
+        std::vector<Double_t> fValue;
+        Int_t fHead{0}; // next write position
+        Int_t fSize{0};
+
+        void Reset(Int_t capacity) {
+            fTime.assign(capacity, 0.);
+            fValue.assign(capacity, 0.);
+            fHead = fSize = 0;
+        }
+        void Push(Double_t time, Double_t value) {
+            fTime[fHead] = time;
+            fValue[fHead] = value;
+            fHead = (fHead + 1) % fTime.size();
+            if (fSize < (Int_t)fTime.size())
+                ++fSize;
+        }
+        /// i-th oldest point
+        Int_t Index(Int_t i) const { return (fHead - fSize + i + fTime.size()) % fTime.size(); }
+    };
+
+    struct Chart {
+        TPad *fPad{nullptr};
+        TLegend *fLegend{nullptr};
+        TGraph *fGraph[SCALER_CH] = {};
+        Ring fRing[SCALER_CH];
+        Long_t fDuration{0};
+        Int_t fCapacity{0};
+        Bool_t fDirty{kFALSE};
+    };
+
+    TCanvas *fCanvas{nullptr};
+    Chart fShort;
+    Chart fLong;
+    std::vector<Int_t> fDisplayCh;
+    Int_t fMaxPoints;
+
+    std::vector<Sample> fQueue;
+    std::atomic<Int_t> fQueueHead{0}; // consumer
+    std::atomic<Int_t> fQueueTail{0}; // producer
+    std::atomic<Long64_t> fNumDropped{0};
+
+    void InitChart(Chart &chart, const char *title);
+    void Fill(Chart &chart, Int_t ch);
+    void Draw(Chart &chart);
+};
+
+TScalerMonitorDrawer::TScalerMonitorDrawer(Long_t refresh, Int_t max_points,
+                                           Long_t short_duration, Int_t short_capacity,
+                                           Long_t long_duration, Int_t long_capacity)
+    : TTimer(refresh, kTRUE), fMaxPoints(max_points), fQueue(kQueueSize) {
+    fShort.fDuration = short_duration;
+    fShort.fCapacity = short_capacity;
+    fLong.fDuration = long_duration;
+    fLong.fCapacity = long_capacity;
+    InitChart(fShort, "count rate (short);;cps");
+    InitChart(fLong, "count rate (long);;cps");
+    fShort.fLegend = new TLegend(0.78, 0.70, 0.95, 0.95);
+
+    fCanvas = new TCanvas("canvas", "monitor", 800, 800);
+    fShort.fPad = new TPad("short", "short", 0.0, 0.5, 1.0, 1.0);
+    fLong.fPad = new TPad("long", "long", 0.0, 0.0, 1.0, 0.5);
+    fShort.fPad->Draw();
+    fLong.fPad->Draw();
+}
+
+TScalerMonitorDrawer::~TScalerMonitorDrawer() {
+    TurnOff();
+    // the canvas may have been closed by the user
+    if (gROOT->GetListOfCanvases()->FindObject(fCanvas)) {
+        fShort.fPad->Clear();
+        fLong.fPad->Clear();
+    }
+    for (auto *chart : {&fShort, &fLong}) {
+        for (auto *&graph : chart->fGraph) {
+            delete graph;
+            graph = nullptr;
+        }
+        delete chart->fLegend;
+        chart->fLegend = nullptr;
+    }
+}
+
+void TScalerMonitorDrawer::InitChart(Chart &chart, const char *title) {
+    for (auto *&graph : chart.fGraph) {
+        graph = new TGraph();
+        graph->SetLineWidth(1);
+        graph->SetMarkerStyle(8);
+        graph->SetMarkerSize(0.8);
+        graph->SetMinimum(0.);
+        graph->SetMaximum(1000.);
+        graph->SetTitle(title);
+    }
+}
+
+void TScalerMonitorDrawer::AddChannel(Int_t ch, const TString &name, Int_t color) {
+    fDisplayCh.emplace_back(ch);
+    for (auto *chart : {&fShort, &fLong}) {
+        TGraph *graph = chart->fGraph[ch];
+        graph->SetName(name);
+        graph->SetLineColor(color);
+        graph->SetMarkerColor(color);
+        graph->GetXaxis()->SetTimeDisplay(1);
+        graph->GetXaxis()->SetTimeFormat("%m/%d %H:%M");
+        chart->fRing[ch].Reset(chart->fCapacity);
+    }
+    fShort.fLegend->AddEntry(fShort.fGraph[ch], name, "pl");
+}
+
+Bool_t TScalerMonitorDrawer::Push(Long_t time, Bool_t is_long, const Double_t *rate) {
+    const Int_t tail = fQueueTail.load(std::memory_order_relaxed);
+    const Int_t next = (tail + 1) % kQueueSize;
+    if (next == fQueueHead.load(std::memory_order_acquire)) {
+        ++fNumDropped; // the drawer is not running (e.g. batch mode)
+        return kFALSE;
+    }
+    Sample &sample = fQueue[tail];
+    sample.fTime = time;
+    sample.fIsLong = is_long;
+    std::copy(rate, rate + SCALER_CH, sample.fRate);
+    fQueueTail.store(next, std::memory_order_release);
+    return kTRUE;
+}
+
+Bool_t TScalerMonitorDrawer::Notify() {
+    Int_t head = fQueueHead.load(std::memory_order_relaxed);
+    const Int_t tail = fQueueTail.load(std::memory_order_acquire);
+    for (; head != tail; head = (head + 1) % kQueueSize) {
+        const Sample &sample = fQueue[head];
+        Chart &chart = sample.fIsLong ? fLong : fShort;
+        for (const auto ch : fDisplayCh) {
+            chart.fRing[ch].Push(sample.fTime, sample.fRate[ch]);
+        }
+        chart.fDirty = kTRUE;
+    }
+    fQueueHead.store(head, std::memory_order_release);
+
+    Bool_t updated = kFALSE;
+    for (auto *chart : {&fShort, &fLong}) {
+        if (!chart->fDirty)
+            continue;
+        for (const auto ch : fDisplayCh) {
+            Fill(*chart, ch);
+        }
+        Draw(*chart);
+        chart->fDirty = kFALSE;
+        updated = kTRUE;
+    }
+    if (updated)
+        fCanvas->Update();
+
+    Reset();
+    return kTRUE;
+}
+
+/**
+ * @details
+ * Points older than the duration are not drawn. If more than fMaxPoints
+ * points remain, they are divided into fMaxPoints / 2 buckets and the
+ * minimum and maximum of each bucket are drawn, so that spikes are kept.
+ */
+void TScalerMonitorDrawer::Fill(Chart &chart, Int_t ch) {
+    const Ring &ring = chart.fRing[ch];
+    TGraph *graph = chart.fGraph[ch];
+    if (ring.fSize == 0) {
+        graph->Set(0);
+        return;
+    }
+
+    const Double_t newest = ring.fTime[ring.Index(ring.fSize - 1)];
+    Int_t first = 0;
+    while (first < ring.fSize - 1 && ring.fTime[ring.Index(first)] < newest - chart.fDuration)
+        ++first;
+    const Int_t npoint = ring.fSize - first;
+
+    if (npoint <= fMaxPoints || fMaxPoints < 2) {
+        graph->Set(npoint);
+        Double_t *x = graph->GetX();
+        Double_t *y = graph->GetY();
+        for (Int_t i = 0; i < npoint; ++i) {
+            const Int_t idx = ring.Index(first + i);
+            x[i] = ring.fTime[idx];
+            y[i] = ring.fValue[idx];
+        }
+        return;
+    }
+
+    const Int_t nbucket = fMaxPoints / 2;
+    graph->Set(2 * nbucket);
+    Double_t *x = graph->GetX();
+    Double_t *y = graph->GetY();
+    for (Int_t b = 0; b < nbucket; ++b) {
+        const Int_t lo = first + (Long64_t)npoint * b / nbucket;
+        const Int_t hi = first + (Long64_t)npoint * (b + 1) / nbucket;
+        Int_t imin = lo, imax = lo;
+        for (Int_t i = lo + 1; i < hi; ++i) {
+            if (ring.fValue[ring.Index(i)] < ring.fValue[ring.Index(imin)])
+                imin = i;
+            if (ring.fValue[ring.Index(i)] > ring.fValue[ring.Index(imax)])
+                imax = i;
+        }
+        const Int_t i0 = ring.Index(std::min(imin, imax));
+        const Int_t i1 = ring.Index(std::max(imin, imax));
+        x[2 * b] = ring.fTime[i0];
+        y[2 * b] = ring.fValue[i0];
+        x[2 * b + 1] = ring.fTime[i1];
+        y[2 * b + 1] = ring.fValue[i1];
+    }
+}
+
+/// the pad is cleared first, so that the primitives do not pile up
+void TScalerMonitorDrawer::Draw(Chart &chart) {
+    chart.fPad->cd();
+    chart.fPad->Clear();
+    Bool_t isfirst_obj = true;
+    for (const auto ch : fDisplayCh) {
+        if (chart.fGraph[ch]->GetN() == 0)
+            continue;
+        chart.fGraph[ch]->Draw(isfirst_obj ? "apl" : "pl");
+        isfirst_obj = false;
+    }
+    if (!isfirst_obj && chart.fLegend)
+        chart.fLegend->Draw();
+    chart.fPad->Modified();
+}
+} // namespace art::crib
+
 TScalerMonitorProcessor::TScalerMonitorProcessor()
-    : fShortCount(0), fLongCount(0) {
+    : fDrawer(nullptr), fLog(nullptr), fLogClock(0) {
     RegisterInputCollection("InputCollection",
                             "Scaler object inheriting from art::TScalerData",
                             fInputColName, TString("scatot"));
@@ -39,22 +312,23 @@ TScalerMonitorProcessor::TScalerMonitorProcessor()
     RegisterProcessorParameter("Channels", "the time range (seconds) for long time monitor",
                                fChannels, init_v);
 
+    RegisterOptionalParameter("RefreshInterval", "the interval time (milliseconds) to redraw the monitor",
+                              fRefreshInterval, 1000);
+    RegisterOptionalParameter("MaxDisplayPoints", "the maximum number of points drawn per channel",
+                              fMaxDisplayPoints, 1000);
+    RegisterOptionalParameter("LogFile", "binary scaler log appended at each scaler readout (art::crib::TScalerLog)",
+                              fLogFileName, TString(""));
+
     for (Int_t i = 0; i < SCALER_CH; i++) {
         fFactors[i] = 1.0;
-        fGr_s[i] = nullptr;
-        fGr_l[i] = nullptr;
     }
 }
 
 TScalerMonitorProcessor::~TScalerMonitorProcessor() {
-    for (Int_t i = 0; i < SCALER_CH; i++) {
-        delete fGr_s[i];
-        delete fGr_l[i];
-    }
-
-    // delete main;
-    // delete pad_s;
-    // delete pad_l;
+    delete fDrawer;
+    fDrawer = nullptr;
+    delete fLog;
+    fLog = nullptr;
 }
 
 void TScalerMonitorProcessor::Init(TEventCollection *col) {
@@ -64,9 +338,9 @@ void TScalerMonitorProcessor::Init(TEventCollection *col) {
     gStyle->SetPadGridY(1);
 
     Info("Init", "Scaler live time chart");
-    Info("Init", "NEED: analysis speed > trigger rate");
     Info("Init", "\tshort time chart: interval %d s, time range %d s", fShortInterval, fShortDuration);
     Info("Init", "\tlong time chart : interval %d s, time range %d s", fLongInterval, fLongDuration);
+    Info("Init", "\tredraw every %d ms, up to %d points per channel", fRefreshInterval, fMaxDisplayPoints);
     Info("Init", "Display: channel, name, scale factor");
     for (Size_t i = 0; i < fChannels.size(); i++) {
         Info("Init", "Display: %s", fChannels[i].Data());
@@ -78,6 +352,11 @@ void TScalerMonitorProcessor::Init(TEventCollection *col) {
         return;
     }
 
+    if (fClock.size() != 2 || fClock[0] < 0 || fClock[0] >= SCALER_CH) {
+        SetStateError("Clock must be [ch, Hz]");
+        return;
+    }
+
     for (Size_t i = 0; i < fChannels.size(); i++) {
         Int_t first = fChannels[i].First(',');
         Int_t last = fChannels[i].Last(',');
@@ -88,6 +367,10 @@ void TScalerMonitorProcessor::Init(TEventCollection *col) {
         }
         TString channel_str = fChannels[i](0, first);
         Int_t channel = channel_str.Remove(TString::kBoth, ' ').Atoi();
+        if (channel < 0 || channel >= SCALER_CH) {
+            SetStateError(TString::Format("channel out of range: %s", fChannels[i].Data()));
+            return;
+        }
         fDisplayCh.emplace_back(channel);
 
         TString name = fChannels[i](first + 1, last - first - 1);
@@ -99,44 +382,29 @@ void TScalerMonitorProcessor::Init(TEventCollection *col) {
         fFactors[channel] = factor;
     }
 
-    for (Int_t i = 0; i < SCALER_CH; i++) {
-        fGr_s[i] = new TGraph();
-        fGr_s[i]->SetLineWidth(1);
-        fGr_s[i]->SetMarkerStyle(8);
-        fGr_s[i]->SetMarkerSize(0.8);
-        fGr_s[i]->SetMinimum(0.);
-        fGr_s[i]->SetMaximum(1000.);
-
-        fGr_l[i] = new TGraph();
-        fGr_l[i]->SetLineWidth(1);
-        fGr_l[i]->SetMarkerStyle(8);
-        fGr_l[i]->SetMarkerSize(0.8);
-        fGr_l[i]->SetMinimum(0.);
-        fGr_l[i]->SetMaximum(1000.);
+    const Int_t short_capacity = fShortDuration / std::max(fShortInterval, 1) + 2;
+    const Int_t long_capacity = fLongDuration / std::max(fLongInterval, 1) + 2;
+    delete fDrawer;
+    fDrawer = new TScalerMonitorDrawer(fRefreshInterval, fMaxDisplayPoints,
+                                       fShortDuration, short_capacity,
+                                       fLongDuration, long_capacity);
+    for (size_t i = 0; i < fDisplayCh.size(); i++) {
+        fDrawer->AddChannel(fDisplayCh[i], fNames[i], fColor_list[i % fColor_list.size()]);
     }
-
-    for (Size_t i = 0; i < fChannels.size(); i++) {
-        fGr_s[fDisplayCh[i]]->SetTitle("count rate (short);;cps");
-        fGr_s[fDisplayCh[i]]->SetName(fNames[i]);
-        fGr_s[fDisplayCh[i]]->SetLineColor(fColor_list[i]);
-        fGr_s[fDisplayCh[i]]->SetMarkerColor(fColor_list[i]);
-        fGr_s[fDisplayCh[i]]->GetXaxis()->SetTimeDisplay(1);
-        fGr_s[fDisplayCh[i]]->GetXaxis()->SetTimeFormat("%m/%d %H:%M");
-
-        fGr_l[fDisplayCh[i]]->SetTitle("count rate (long);;cps");
-        fGr_l[fDisplayCh[i]]->SetName(fNames[i]);
-        fGr_l[fDisplayCh[i]]->SetLineColor(fColor_list[i]);
-        fGr_l[fDisplayCh[i]]->SetMarkerColor(fColor_list[i]);
-        fGr_l[fDisplayCh[i]]->GetXaxis()->SetTimeDisplay(1);
-        fGr_l[fDisplayCh[i]]->GetXaxis()->SetTimeFormat("%m/%d %H:%M");
+    fDrawer->TurnOn();
+
+    delete fLog;
+    fLog = nullptr;
+    if (!fLogFileName.IsNull()) {
+        gSystem->mkdir(gSystem->DirName(fLogFileName), kTRUE);
+        fLog = new TScalerLog;
+        if (!fLog->OpenWrite(fLogFileName, fClock[0], fClock[1])) {
+            SetStateError(TString::Format("cannot open the scaler log: %s", fLogFileName.Data()));
+            return;
+        }
+        Info("Init", "scaler log: %s (%lld records)", fLogFileName.Data(), fLog->GetNumRecords());
     }
 
-    main = new TCanvas("canvas", "monitor", 800, 800);
-    pad_s = new TPad("short", "short", 0.0, 0.5, 1.0, 1.0);
-    pad_l = new TPad("long", "long", 0.0, 0.0, 1.0, 0.5);
-    pad_s->Draw();
-    pad_l->Draw();
-
     fIsFirst = true;
 }
 
@@ -144,8 +412,6 @@ void TScalerMonitorProcessor::Process() {
     Long_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
     if (fIsFirst) {
-        fStartShort = now;
-        fStartLong = now;
         fCurrentShort = now;
         fCurrentLong = now;
 
@@ -160,111 +426,65 @@ void TScalerMonitorProcessor::Process() {
         }
     }
 
+    if (fLog)
+        WriteLog(now);
+
     ProcessShort(now);
     ProcessLong(now);
 }
 
-void TScalerMonitorProcessor::ProcessShort(Long_t now) {
-    if (now - fCurrentShort > fShortInterval) {
-        const TScalerData *const scadata = static_cast<TScalerData *>(*fInData);
-        if (scadata->GetValue(fClock[0]) - fShortScatot[fClock[0]] <= 0) {
-            for (Int_t i = 0; i < SCALER_CH; i++) {
-                fShortScatot[i] = scadata->GetValue(i);
-                fShortScadiff[i] = scadata->GetValue(i);
-            }
-            fCurrentShort = now;
-            return;
-        }
+/// a record is appended when the clock channel is updated, i.e. at each scaler readout
+void TScalerMonitorProcessor::WriteLog(Long_t now) {
+    const TScalerData *const scadata = static_cast<TScalerData *>(*fInData);
+    const UInt_t clock = scadata->GetValue(fClock[0]);
+    if (clock == fLogClock && fLog->GetNumRecords() > 0)
+        return;
 
-        for (Int_t i = 0; i < SCALER_CH; i++) {
-            fShortScadiff[i] = scadata->GetValue(i) - fShortScatot[i];
-            fShortScatot[i] = scadata->GetValue(i);
-        }
+    UInt_t values[SCALER_CH];
+    for (Int_t i = 0; i < SCALER_CH; i++) {
+        values[i] = scadata->GetValue(i);
+    }
+    fLog->Append(now, values);
+    fLogClock = clock;
+}
 
+/**
+ * @details
+ * Updates the scaler values and calculates the rate of all channels
+ * normalized by the clock channel. Returns false if the clock did not count.
+ */
+Bool_t TScalerMonitorProcessor::UpdateRate(UInt_t *scatot, UInt_t *scadiff) {
+    const TScalerData *const scadata = static_cast<TScalerData *>(*fInData);
+    if (scadata->GetValue(fClock[0]) - scatot[fClock[0]] <= 0) {
         for (Int_t i = 0; i < SCALER_CH; i++) {
-            fShortScadiff[i] = (UInt_t)(fClock[1] * fShortScadiff[i] / fShortScadiff[fClock[0]]);
-            fGr_s[i]->SetPoint(fShortCount, now, fShortScadiff[i] * fFactors[i]);
-
-            if (now - fStartShort > fShortDuration) { // slide
-                for (Int_t j = 0; j < fShortCount; j++) {
-                    Double_t x, y;
-                    fGr_s[i]->GetPoint(j + 1, x, y);
-                    fGr_s[i]->SetPoint(j, x, y);
-                }
-                fGr_s[i]->RemovePoint(fShortCount);
-            }
+            scatot[i] = scadata->GetValue(i);
+            scadiff[i] = scadata->GetValue(i);
         }
+        return kFALSE;
+    }
 
-        // draw process
-        pad_s->cd();
-        Bool_t isfirst_obj = true;
-        TLegend *legend = new TLegend(0.78, 0.70, 0.95, 0.95);
-        for (Size_t i = 0; i < fDisplayCh.size(); i++) {
-            if (isfirst_obj) {
-                fGr_s[fDisplayCh[i]]->Draw("apl");
-                legend->AddEntry(fGr_s[fDisplayCh[i]], fNames[i], "pl");
-                isfirst_obj = false;
-                continue;
-            }
-            fGr_s[fDisplayCh[i]]->Draw("pl");
-            legend->AddEntry(fGr_s[fDisplayCh[i]], fNames[i], "pl");
-        }
-        legend->Draw();
-        main->Update();
+    for (Int_t i = 0; i < SCALER_CH; i++) {
+        scadiff[i] = scadata->GetValue(i) - scatot[i];
+        scatot[i] = scadata->GetValue(i);
+    }
+    for (Int_t i = 0; i < SCALER_CH; i++) {
+        fRate[i] = fClock[1] * (Double_t)scadiff[i] / scadiff[fClock[0]] * fFactors[i];
+    }
+    return kTRUE;
+}
 
-        if (now - fStartShort <= fShortDuration) {
-            fShortCount++;
-        }
+void TScalerMonitorProcessor::ProcessShort(Long_t now) {
+    if (now - fCurrentShort > fShortInterval) {
+        if (UpdateRate(fShortScatot, fShortScadiff))
+            fDrawer->Push(now, kFALSE, fRate);
         fCurrentShort = now;
     }
 }
 
 void TScalerMonitorProcessor::ProcessLong(Long_t now) {
     if (now - fCurrentLong > fLongInterval) {
-        const TScalerData *const scadata = static_cast<TScalerData *>(*fInData);
-        if (scadata->GetValue(fClock[0]) - fLongScatot[fClock[0]] <= 0) {
-            for (Int_t i = 0; i < SCALER_CH; i++) {
-                fLongScatot[i] = scadata->GetValue(i);
-                fLongScadiff[i] = scadata->GetValue(i);
-            }
-            fCurrentLong = now;
-            return;
-        }
-        for (Int_t i = 0; i < SCALER_CH; i++) {
-            fLongScadiff[i] = scadata->GetValue(i) - fLongScatot[i];
-            fLongScatot[i] = scadata->GetValue(i);
-        }
-
-        for (Int_t i = 0; i < SCALER_CH; i++) {
-            fLongScadiff[i] = (UInt_t)(fClock[1] * fLongScadiff[i] / fLongScadiff[fClock[0]]);
-            fGr_l[i]->SetPoint(fLongCount, now, fLongScadiff[i] * fFactors[i]);
-
-            if (now - fStartLong > fLongDuration) { // slide
-                for (Int_t j = 0; j < fLongCount; j++) {
-                    Double_t x, y;
-                    fGr_l[i]->GetPoint(j + 1, x, y);
-                    fGr_l[i]->SetPoint(j, x, y);
-                }
-                fGr_l[i]->RemovePoint(fLongCount);
-            }
-        }
-
-        // draw process
-        pad_l->cd();
-        Bool_t isfirst_obj = true;
-        for (Int_t &ch : fDisplayCh) {
-            if (isfirst_obj) {
-                fGr_l[ch]->Draw("apl");
-                isfirst_obj = false;
-                continue;
-            }
-            fGr_l[ch]->Draw("pl");
-        }
-        main->Update();
-
-        if (now - fStartLong <= fLongDuration) {
-            fLongCount++;
-        }
+        if (UpdateRate(fLongScatot, fLongScadiff))
+            fDrawer->Push(now, kTRUE, fRate);
         fCurrentLong = now;
     }
 }
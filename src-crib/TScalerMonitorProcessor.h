@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-28 14:23:16
- * @note    last modified: 2025-01-08 10:28:23
+ * @note    last modified: 2026-10-18 21:20:04
  * @details
  */
 
@@ -11,8 +11,6 @@
 #define _CRIB_TSCALERMONITORPROCESSOR_H_
 
 #include "TProcessor.h"
-#include <TCanvas.h>
-#include <TGraph.h>
 #include <TScalerData.h>
 
 namespace art {
@@ -21,6 +19,8 @@ class TScalerData;
 
 namespace art::crib {
 class TScalerMonitorProcessor;
+class TScalerMonitorDrawer;
+class TScalerLog;
 } // namespace art::crib
 
 class art::crib::TScalerMonitorProcessor : public TProcessor {
@@ -38,9 +38,7 @@ class art::crib::TScalerMonitorProcessor : public TProcessor {
     const static Int_t SCALER_CH = 32;
 
   private:
-    TCanvas *main;
-    TPad *pad_s;
-    TPad *pad_l;
+    TScalerMonitorDrawer *fDrawer; //! time series and drawing (main thread)
 
     TString fInputColName;
     TScalerData **fInData; //!
@@ -53,27 +51,32 @@ class art::crib::TScalerMonitorProcessor : public TProcessor {
     IntVec_t fClock;       // [ch, Hz]
     StringVec_t fChannels; // channel info
 
+    Int_t fRefreshInterval;  // milliseconds
+    Int_t fMaxDisplayPoints; // number of points drawn per channel
+
+    TString fLogFileName;    // persistent scaler log (not written if empty)
+    TScalerLog *fLog;        //!
+    UInt_t fLogClock;        //! clock value of the last log record
+
     Bool_t fIsFirst;
 
     // for short data member
-    Long_t fStartShort;
     Long_t fCurrentShort;
     UInt_t fShortScatot[SCALER_CH] = {};  // scaler value
     UInt_t fShortScadiff[SCALER_CH] = {}; // scaler difference
-    TGraph *fGr_s[SCALER_CH];             // live time chart for 32ch
-    Int_t fShortCount;                    // TGraph point number
 
     // for long data member
-    Long_t fStartLong;
     Long_t fCurrentLong;
     UInt_t fLongScatot[SCALER_CH] = {};  // scaler value
     UInt_t fLongScadiff[SCALER_CH] = {}; // scaler difference
-    TGraph *fGr_l[SCALER_CH];            // live time chart for 32ch
-    Int_t fLongCount;                    // TGraph point number
 
     IntVec_t fDisplayCh;               // display channels
     StringVec_t fNames;                // channel names
     Double_t fFactors[SCALER_CH] = {}; // channel factors
+    Double_t fRate[SCALER_CH] = {};    // rate to be sent to the drawer
+
+    Bool_t UpdateRate(UInt_t *scatot, UInt_t *scadiff);
+    void WriteLog(Long_t now);
 
     IntVec_t fColor_list = {
         kRed,
@@ -10,6 +10,7 @@
 // segment and category
 // main
 #pragma link C++ class art::crib::TF1PPACProcessor;
+#pragma link C++ class art::crib::TF3PPACTrackProcessor;
 #pragma link C++ class art::crib::TTimingChargeAllMappingProcessor;
 #pragma link C++ class art::crib::TTimingDataMappingProcessor;
 #pragma link C++ class art::crib::TBranchCopyProcessor;
@@ -17,14 +18,23 @@
 #pragma link C++ class art::crib::TModuleData + ;
 #pragma link C++ class art::crib::TSegmentOutputProcessor;
 #pragma link C++ class art::crib::TScalerMonitorProcessor;
+#pragma link C++ class art::crib::TScalerLog;
+#pragma link C++ class art::crib::TScalerLog::Record;
 #pragma link C++ class art::crib::TChannelSelector;
 #pragma link C++ class art::crib::TMapSelector;
+#pragma link C++ class art::crib::TProfileProcessor;
+// map
+#pragma link C++ class art::crib::TMappedData;
+#pragma link C++ class art::crib::TMapCompileProcessor;
 // MUX
 #pragma link C++ class art::crib::TMUXData + ;
 #pragma link C++ class art::crib::TMUXDataMappingProcessor;
 #pragma link C++ class art::crib::TMUXPositionConverter;
 #pragma link C++ class art::crib::TMUXCalibrationProcessor;
 #pragma link C++ class art::crib::TMUXPositionValidator;
+// gate
+#pragma link C++ class art::crib::TCompiledGateProcessor;
+#pragma link C++ class art::crib::TIndexedCutG + ;
 // telescope
 #pragma link C++ class art::crib::TTelescopeData + ;
 #pragma link C++ class art::crib::TTelescopeProcessor;
@@ -42,6 +52,7 @@
 #pragma link C++ class art::crib::TCatCmdTCutG;
 #pragma link C++ class art::crib::TCmdErase;
 #pragma link C++ class art::crib::TCmdDraw;
+#pragma link C++ class art::crib::TCmdTprof;
 // geo
 #pragma link C++ class art::crib::TUserGeoInitializer;
 #pragma link C++ class art::crib::TDetectorParameter + ;
@@ -54,11 +65,17 @@
 #pragma link C++ class art::crib::TRandomBeamGenerator;
 #pragma link C++ class art::crib::TTreeBeamGenerator;
 #pragma link C++ class art::crib::TSolidAngleProcessor;
-// #pragma link C++ class art::crib::TRutherfordScattering;
+#pragma link C++ class art::crib::TEventSeedProcessor;
+#pragma link C++ class art::crib::TBeamPhaseSpace + ;
+#pragma link C++ class art::crib::TPhaseSpaceBeamGenerator;
+#pragma link C++ class art::crib::TRutherfordScattering;
 // timestamp
 #pragma link C++ class art::crib::TTSData + ;
 #pragma link C++ class art::crib::TTSMappingProcessor;
 #pragma link C++ class art::crib::TModuleDecoderTimestamp;
+#pragma link C++ class art::crib::TTSEventBuilder;
+#pragma link C++ class art::crib::TTSIndexWriter;
+#pragma link C++ class art::crib::TTSIndexedEventStore;
 #endif // __ROOTCLING__
 
 #endif // LINKDEF_CRIB_H
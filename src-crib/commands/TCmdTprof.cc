@@ -0,0 +1,47 @@
+/**
+ * @file    TCmdTprof.cc
+ * @brief   "tprof" command, cost table of the processors measured by TProfileProcessor
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:49:33
+ * @note    last modified: 2026-10-18 22:28:16
+ * @details
+ */
+
+#include "TCmdTprof.h"
+
+#include "../TProcessorProfile.h"
+
+#include <iostream>
+
+using art::crib::TCmdTprof;
+
+ClassImp(TCmdTprof);
+
+TCmdTprof::TCmdTprof() {
+    SetName("tprof");
+    SetTitle("show the processor cost table (TProfileProcessor)");
+}
+
+TCmdTprof::~TCmdTprof() {}
+
+Long_t TCmdTprof::Cmd(vector<TString> tokens) {
+    const TString opt = tokens.size() > 1 ? tokens[1] : TString("total");
+    if (opt == "reset") {
+        // the table is owned by the loop thread, the counters are zeroed at its next checkpoint
+        TProcessorProfile::Instance()->RequestReset();
+        Info("Cmd", "profile counters are cleared at the next event");
+        return 1;
+    }
+    if (opt != "total" && opt != "mean" && opt != "p99" && opt != "calls" && opt != "steering") {
+        Help();
+        return 1;
+    }
+    TProcessorProfile::Instance()->Print(opt);
+    return 1;
+}
+
+void TCmdTprof::Help() {
+    std::cout << "tprof [total|mean|p99|calls|steering] : show the processor cost table sorted by the key" << std::endl;
+    std::cout << "tprof reset                           : zero the counters from the next event" << std::endl;
+    std::cout << "  the sections are defined by art::crib::TProfileProcessor in the steering file" << std::endl;
+}
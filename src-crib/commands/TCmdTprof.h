@@ -0,0 +1,34 @@
+/**
+ * @file    TCmdTprof.h
+ * @brief   "tprof" command, cost table of the processors measured by TProfileProcessor
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:49:33
+ * @note    last modified: 2026-10-18 21:55:08
+ * @details
+ */
+
+#ifndef _CRIB_TCMDTPROF_H_
+#define _CRIB_TCMDTPROF_H_
+
+#include <TCatCmd.h>
+
+namespace art::crib {
+class TCmdTprof;
+} // namespace art::crib
+
+class art::crib::TCmdTprof : public TCatCmd {
+  public:
+    TCmdTprof();
+    ~TCmdTprof() override;
+
+    Long_t Cmd(vector<TString>) override;
+    void Help() override;
+
+  private:
+    TCmdTprof(const TCmdTprof &) = delete;            // undefined
+    TCmdTprof &operator=(const TCmdTprof &) = delete; // undefined
+
+    ClassDefOverride(TCmdTprof, 1);
+};
+
+#endif // end of #ifndef _CRIB_TCMDTPROF_H_
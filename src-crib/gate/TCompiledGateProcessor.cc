@@ -0,0 +1,115 @@
+/**
+ * @file    TCompiledGateProcessor.cc
+ * @brief   Gate definitions compiled at Init and evaluated into a bitset.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:55:12
+ * @note    last modified: 2026-10-18 19:55:12
+ * @details
+ */
+
+#include "TCompiledGateProcessor.h"
+
+#include <TBits.h>
+
+#include <algorithm>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TCompiledGateProcessor);
+
+namespace art::crib {
+
+TCompiledGateProcessor::TCompiledGateProcessor() : fOutData(nullptr), fNEvent(0) {
+    RegisterOutputCollection("OutputCollection", "TBits of the gate results (bit i: definition i)", fOutputColName,
+                             TString("gatebits"));
+    RegisterProcessorParameter("Definitions", "list of \"name; expression\"", fDefinitions, StringVec_t());
+    RegisterOptionalParameter("StopGates", "gates to stop the event, *: all", fStopGates, StringVec_t());
+    RegisterOptionalParameter("StopIf", "stop the event if the stop gate is this value", fStopIf, 0);
+}
+
+TCompiledGateProcessor::~TCompiledGateProcessor() {
+    delete fOutData;
+    fOutData = nullptr;
+}
+
+void TCompiledGateProcessor::Init(TEventCollection *col) {
+    fGateNames.clear();
+    fFormulas.clear();
+    fIsStopGate.clear();
+
+    const Bool_t stopAll = std::find(fStopGates.begin(), fStopGates.end(), "*") != fStopGates.end();
+    for (const auto &def : fDefinitions) {
+        const Ssiz_t sep = def.First(';');
+        if (sep == kNPOS) {
+            SetStateError(Form("definition should be \"name; expression\": %s", def.Data()));
+            return;
+        }
+        TString name = def(0, sep);
+        TString expr = def(sep + 1, def.Length() - sep - 1);
+        name = name.Strip(TString::kBoth);
+        expr = expr.Strip(TString::kBoth);
+        if (name.IsNull() || expr.IsNull()) {
+            SetStateError(Form("definition should be \"name; expression\": %s", def.Data()));
+            return;
+        }
+        if (std::find(fGateNames.begin(), fGateNames.end(), name) != fGateNames.end()) {
+            SetStateError(Form("gate %s is defined twice", name.Data()));
+            return;
+        }
+
+        TGateFormula formula;
+        TString error;
+        if (!formula.Compile(expr, col, error)) {
+            SetStateError(Form("gate %s: %s", name.Data(), error.Data()));
+            return;
+        }
+        fGateNames.emplace_back(name);
+        fFormulas.emplace_back(std::move(formula));
+        fIsStopGate.emplace_back(stopAll ||
+                                 std::find(fStopGates.begin(), fStopGates.end(), name) != fStopGates.end());
+    }
+
+    for (const auto &stop : fStopGates) {
+        if (stop != "*" && std::find(fGateNames.begin(), fGateNames.end(), stop) == fGateNames.end()) {
+            SetStateError(Form("stop gate %s is not defined", stop.Data()));
+            return;
+        }
+    }
+
+    const Int_t n = fGateNames.size();
+    fNPass.assign(n, 0);
+    fNStop.assign(n, 0);
+    fNEvent = 0;
+
+    fOutData = new TBits(n);
+    col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+
+    Info("Init", "%d gates are compiled", n);
+}
+
+void TCompiledGateProcessor::Process() {
+    fOutData->ResetAllBits();
+    fNEvent++;
+
+    const Int_t n = fFormulas.size();
+    for (Int_t i = 0; i < n; i++) {
+        const Bool_t pass = fFormulas[i].Test();
+        if (pass) {
+            fOutData->SetBitNumber(i);
+            fNPass[i]++;
+        }
+        if (fIsStopGate[i] && static_cast<Int_t>(pass) == fStopIf) {
+            fNStop[i]++;
+            SetStopEvent();
+            return;
+        }
+    }
+}
+
+void TCompiledGateProcessor::PostLoop() {
+    Info("PostLoop", "%lld events", fNEvent);
+    for (Int_t i = 0; i < (Int_t)fGateNames.size(); i++) {
+        Info("PostLoop", "  %-20s pass: %lld, stop: %lld", fGateNames[i].Data(), fNPass[i], fNStop[i]);
+    }
+}
+
+} // namespace art::crib
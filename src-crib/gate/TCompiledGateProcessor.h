@@ -0,0 +1,83 @@
+/**
+ * @file    TCompiledGateProcessor.h
+ * @brief   Gate definitions compiled at Init and evaluated into a bitset.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:55:12
+ * @note    last modified: 2026-10-18 21:52:30
+ * @details
+ */
+
+#ifndef CRIB_TCOMPILEDGATEPROCESSOR_H_
+#define CRIB_TCOMPILEDGATEPROCESSOR_H_
+
+#include "TGateFormula.h"
+
+#include <TProcessor.h>
+
+class TBits;
+
+namespace art::crib {
+
+/**
+ * @class TCompiledGateProcessor
+ * @brief Replaces art::TTreeFormulaGateProcessor and the chain of art::TGateStopProcessor.
+ *
+ * Each definition "name; expression" is compiled once at Init by TGateFormula, so that
+ * no TTreeFormula is interpreted in the event loop. The gates are evaluated in the order
+ * of the definitions, and the bit i of the output TBits is set if the gate i is true.
+ * When a gate in StopGates equals StopIf, the event is stopped immediately and
+ * the remaining gates are not evaluated (their bits are 0). Put the gates rejecting
+ * many events first.
+ *
+ * The gates are not registered in the gate array of art::TGateArrayInitializer,
+ * so they cannot be referred to by name (e.g. `cut:` of the histograms or
+ * art::TGateStopProcessor). Use the bit of the output instead, e.g. an alias
+ * `ppaca_ok: gatebits.TestBitNumber(2)` in the histogram file, or keep
+ * art::TTreeFormulaGateProcessor for the gates which need a name.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: proc_gate
+ *     type: art::crib::TCompiledGateProcessor
+ *     parameter:
+ *       Definitions:                                # [StringVec_t] "name; expression"
+ *         - "nopileup; coin_raw@.GetEntriesFast()==1"
+ *         - "ppaca_normal; abs(f3appac.fX) < 50.0 && abs(f3appac.fY) < 50.0"
+ *       OutputCollection: gatebits                  # [TString] TBits of the gate results
+ *       StopGates: ["*"]                            # [StringVec_t] gates to stop the event, *: all
+ *       StopIf: 0                                   # [Int_t] stop if the gate result is this value
+ * ```
+ */
+class TCompiledGateProcessor : public TProcessor {
+  public:
+    TCompiledGateProcessor();
+    ~TCompiledGateProcessor() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+    void PostLoop() override;
+
+  private:
+    TString fOutputColName;   ///< output TBits
+    TBits *fOutData;          ///<!
+    StringVec_t fDefinitions; ///< "name; expression"
+    StringVec_t fStopGates;   ///< names of the gates to stop the event
+    Int_t fStopIf;            ///< stop the event if the stop gate is this value
+
+    std::vector<TString> fGateNames;     ///<!
+    std::vector<TGateFormula> fFormulas; ///<!
+    std::vector<Bool_t> fIsStopGate;     ///<!
+    std::vector<Long64_t> fNPass;        ///<! events with the gate true
+    std::vector<Long64_t> fNStop;        ///<! events stopped by the gate
+    Long64_t fNEvent;                    ///<!
+
+    TCompiledGateProcessor(const TCompiledGateProcessor &rhs) = delete;
+    TCompiledGateProcessor &operator=(const TCompiledGateProcessor &rhs) = delete;
+
+    ClassDefOverride(TCompiledGateProcessor, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TCOMPILEDGATEPROCESSOR_H_
@@ -0,0 +1,133 @@
+/**
+ * @file    TCutGIndex.cc
+ * @brief   Uniform-grid index of a polygon for fast point-in-polygon tests.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:08:41
+ * @note    last modified: 2026-10-18 20:08:41
+ * @details
+ */
+
+#include "TCutGIndex.h"
+
+#include <algorithm>
+
+namespace art::crib {
+
+void TCutGIndex::Build(Int_t n, const Double_t *x, const Double_t *y, Int_t ncell) {
+    fX.assign(x, x + std::max(n, 0));
+    fY.assign(y, y + std::max(n, 0));
+    fCell.clear();
+    fRowStart.clear();
+    fRowEdge.clear();
+    fNx = fNy = 0;
+    fBuilt = kTRUE;
+    // too few points: every test is done by IsInsideAll
+    if (n < 3)
+        return;
+
+    const auto [xmin, xmax] = std::minmax_element(fX.begin(), fX.end());
+    const auto [ymin, ymax] = std::minmax_element(fY.begin(), fY.end());
+    fXmin = *xmin;
+    fXmax = *xmax;
+    fYmin = *ymin;
+    fYmax = *ymax;
+    fNx = fNy = std::max(ncell, 1);
+    fInvDx = fXmax > fXmin ? fNx / (fXmax - fXmin) : 0.0;
+    fInvDy = fYmax > fYmin ? fNy / (fYmax - fYmin) : 0.0;
+    const Double_t dx = fInvDx > 0.0 ? 1.0 / fInvDx : 0.0;
+    const Double_t dy = fInvDy > 0.0 ? 1.0 / fInvDy : 0.0;
+
+    // edges are registered to the rows and cells they pass, and to their neighbours,
+    // so that the rounding of the cell index of a point does not matter
+    fCell.assign(fNx * fNy, kOutside);
+    std::vector<std::vector<Int_t>> rows(fNy);
+    for (Int_t i = 0; i < n; i++) {
+        const Int_t j = i == 0 ? n - 1 : i - 1;
+        const Double_t ylo = std::min(fY[i], fY[j]);
+        const Double_t yhi = std::max(fY[i], fY[j]);
+        const Int_t row_lo = std::max(CellY(ylo) - 1, 0);
+        const Int_t row_hi = std::min(CellY(yhi) + 1, fNy - 1);
+        for (Int_t iy = row_lo; iy <= row_hi; iy++) {
+            rows[iy].emplace_back(i);
+
+            // x range of the edge in the row
+            Double_t xa = std::min(fX[i], fX[j]);
+            Double_t xb = std::max(fX[i], fX[j]);
+            if (yhi > ylo) {
+                const Double_t ya = std::clamp(fYmin + iy * dy, ylo, yhi);
+                const Double_t yb = std::clamp(fYmin + (iy + 1) * dy, ylo, yhi);
+                const Double_t xya = fX[j] + (ya - fY[j]) / (fY[i] - fY[j]) * (fX[i] - fX[j]);
+                const Double_t xyb = fX[j] + (yb - fY[j]) / (fY[i] - fY[j]) * (fX[i] - fX[j]);
+                xa = std::min(xya, xyb);
+                xb = std::max(xya, xyb);
+            }
+            const Int_t col_lo = std::max(CellX(xa) - 1, 0);
+            const Int_t col_hi = std::min(CellX(xb) + 1, fNx - 1);
+            for (Int_t ix = col_lo; ix <= col_hi; ix++) {
+                fCell[iy * fNx + ix] = kEdge;
+            }
+        }
+    }
+
+    fRowStart.assign(fNy + 1, 0);
+    for (Int_t iy = 0; iy < fNy; iy++) {
+        fRowStart[iy + 1] = fRowStart[iy] + rows[iy].size();
+        fRowEdge.insert(fRowEdge.end(), rows[iy].begin(), rows[iy].end());
+    }
+
+    // no edge in the cell and its neighbours: the center tells the whole cell
+    for (Int_t iy = 0; iy < fNy; iy++) {
+        for (Int_t ix = 0; ix < fNx; ix++) {
+            UChar_t &cell = fCell[iy * fNx + ix];
+            if (cell == kEdge)
+                continue;
+            cell = IsInsideAll(fXmin + (ix + 0.5) * dx, fYmin + (iy + 0.5) * dy) ? kInside : kOutside;
+        }
+    }
+}
+
+Bool_t TCutGIndex::IsInside(Double_t x, Double_t y) const {
+    if (fNx == 0)
+        return IsInsideAll(x, y);
+    // also rejects NaN
+    if (!(x >= fXmin && x <= fXmax && y >= fYmin && y <= fYmax))
+        return kFALSE;
+
+    const Int_t iy = CellY(y);
+    const UChar_t cell = fCell[iy * fNx + CellX(x)];
+    if (cell != kEdge)
+        return cell == kInside;
+
+    Bool_t odd = kFALSE;
+    for (Int_t k = fRowStart[iy]; k < fRowStart[iy + 1]; k++) {
+        odd ^= Crosses(fRowEdge[k], x, y);
+    }
+    return odd;
+}
+
+Int_t TCutGIndex::CellX(Double_t x) const {
+    return std::clamp(static_cast<Int_t>((x - fXmin) * fInvDx), 0, fNx - 1);
+}
+
+Int_t TCutGIndex::CellY(Double_t y) const {
+    return std::clamp(static_cast<Int_t>((y - fYmin) * fInvDy), 0, fNy - 1);
+}
+
+Bool_t TCutGIndex::Crosses(Int_t i, Double_t x, Double_t y) const {
+    // same expression as TMath::IsInside
+    const Int_t j = i == 0 ? static_cast<Int_t>(fX.size()) - 1 : i - 1;
+    if ((fY[i] < y && fY[j] >= y) || (fY[j] < y && fY[i] >= y)) {
+        return fX[i] + (y - fY[i]) / (fY[j] - fY[i]) * (fX[j] - fX[i]) < x;
+    }
+    return kFALSE;
+}
+
+Bool_t TCutGIndex::IsInsideAll(Double_t x, Double_t y) const {
+    Bool_t odd = kFALSE;
+    for (Int_t i = 0; i < (Int_t)fX.size(); i++) {
+        odd ^= Crosses(i, x, y);
+    }
+    return odd;
+}
+
+} // namespace art::crib
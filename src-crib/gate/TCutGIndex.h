@@ -0,0 +1,57 @@
+/**
+ * @file    TCutGIndex.h
+ * @brief   Uniform-grid index of a polygon for fast point-in-polygon tests.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:08:41
+ * @note    last modified: 2026-10-18 20:08:41
+ * @details
+ */
+
+#ifndef CRIB_TCUTGINDEX_H_
+#define CRIB_TCUTGINDEX_H_
+
+#include <Rtypes.h>
+
+#include <vector>
+
+namespace art::crib {
+
+/**
+ * @class TCutGIndex
+ * @brief Gives the same result as TCutG::IsInside (TMath::IsInside) with a few edge tests.
+ *
+ * The bounding box of the polygon is divided into ncell x ncell cells, and each cell is
+ * classified at Build as outside, inside or edge (an edge of the polygon is in the cell or
+ * in its neighbours). A point outside the bounding box or in an outside/inside cell is
+ * answered without any edge test. For a point in an edge cell, the even-odd rule of
+ * TMath::IsInside is applied only to the edges in the same row of cells.
+ */
+class TCutGIndex {
+  public:
+    TCutGIndex() = default;
+
+    /// @brief builds the index of the polygon (x[i], y[i]), the last edge closes the polygon
+    void Build(Int_t n, const Double_t *x, const Double_t *y, Int_t ncell = 64);
+    Bool_t IsBuilt() const { return fBuilt; }
+    Bool_t IsInside(Double_t x, Double_t y) const;
+
+  private:
+    enum ECell : UChar_t { kOutside, kInside, kEdge };
+
+    Bool_t fBuilt = kFALSE;
+    std::vector<Double_t> fX, fY; // vertices
+    Double_t fXmin = 0.0, fXmax = 0.0, fYmin = 0.0, fYmax = 0.0;
+    Double_t fInvDx = 0.0, fInvDy = 0.0; // cells per unit length
+    Int_t fNx = 0, fNy = 0;
+    std::vector<UChar_t> fCell;   // ECell of the cell (ix, iy) at iy * fNx + ix
+    std::vector<Int_t> fRowStart; // edges of the row iy: fRowEdge[fRowStart[iy] .. fRowStart[iy + 1]]
+    std::vector<Int_t> fRowEdge;  // edge i is from vertex i - 1 to vertex i
+
+    Int_t CellX(Double_t x) const;
+    Int_t CellY(Double_t y) const;
+    Bool_t Crosses(Int_t i, Double_t x, Double_t y) const;
+    Bool_t IsInsideAll(Double_t x, Double_t y) const;
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TCUTGINDEX_H_
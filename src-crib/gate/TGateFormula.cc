@@ -0,0 +1,664 @@
+/**
+ * @file    TGateFormula.cc
+ * @brief   Gate expression compiled once into a node list with resolved data addresses.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:44:05
+ * @note    last modified: 2026-10-18 22:24:51
+ * @details
+ */
+
+#include "TGateFormula.h"
+
+#include "../TProcessorUtil.h"
+
+#include <TClass.h>
+#include <TClonesArray.h>
+#include <TCutG.h>
+#include <TDataMember.h>
+#include <TDataType.h>
+#include <TFile.h>
+#include <TMethodCall.h>
+#include <TROOT.h>
+#include <TRealData.h>
+#include <TSystem.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+enum EFunc { kAbs, kSqrt, kExp, kLog, kPow, kMin, kMax };
+
+Bool_t IsSupportedType(Int_t type) {
+    switch (type) {
+    case kChar_t:
+    case kUChar_t:
+    case kShort_t:
+    case kUShort_t:
+    case kInt_t:
+    case kUInt_t:
+    case kLong_t:
+    case kULong_t:
+    case kLong64_t:
+    case kULong64_t:
+    case kFloat_t:
+    case kFloat16_t:
+    case kDouble_t:
+    case kDouble32_t:
+    case kBool_t:
+        return kTRUE;
+    default:
+        return kFALSE;
+    }
+}
+
+Double_t ReadValue(const char *p, Int_t type) {
+    switch (type) {
+    case kChar_t:
+        return *reinterpret_cast<const Char_t *>(p);
+    case kUChar_t:
+        return *reinterpret_cast<const UChar_t *>(p);
+    case kShort_t:
+        return *reinterpret_cast<const Short_t *>(p);
+    case kUShort_t:
+        return *reinterpret_cast<const UShort_t *>(p);
+    case kInt_t:
+        return *reinterpret_cast<const Int_t *>(p);
+    case kUInt_t:
+        return *reinterpret_cast<const UInt_t *>(p);
+    case kLong_t:
+        return *reinterpret_cast<const Long_t *>(p);
+    case kULong_t:
+        return *reinterpret_cast<const ULong_t *>(p);
+    case kLong64_t:
+        return *reinterpret_cast<const Long64_t *>(p);
+    case kULong64_t:
+        return *reinterpret_cast<const ULong64_t *>(p);
+    case kFloat_t:
+    case kFloat16_t:
+        return *reinterpret_cast<const Float_t *>(p);
+    case kBool_t:
+        return *reinterpret_cast<const Bool_t *>(p);
+    default: // kDouble_t, kDouble32_t
+        return *reinterpret_cast<const Double_t *>(p);
+    }
+}
+
+/// @brief function id and the number of arguments, -1 if unknown
+Int_t FindFunction(TString name, Int_t &nargs) {
+    if (name.BeginsWith("TMath::"))
+        name.Remove(0, 7);
+    name.ToLower();
+    nargs = 1;
+    if (name == "abs" || name == "fabs")
+        return kAbs;
+    if (name == "sqrt")
+        return kSqrt;
+    if (name == "exp")
+        return kExp;
+    if (name == "log")
+        return kLog;
+    nargs = 2;
+    if (name == "pow" || name == "power")
+        return kPow;
+    if (name == "min")
+        return kMin;
+    if (name == "max")
+        return kMax;
+    return -1;
+}
+
+/// @brief TCutG loaded by macro/load_tcutg.C, or saved in gate/ by TCatCmdTCutG
+const TCutG *FindCutG(const TString &name, std::unique_ptr<TCutG> &owned) {
+    if (gROOT) {
+        const TObject *obj = gROOT->GetListOfSpecials()->FindObject(name);
+        if (obj && obj->InheritsFrom(TCutG::Class()))
+            return static_cast<const TCutG *>(obj);
+    }
+    const TString path = "gate/" + name + ".root";
+    if (gSystem->AccessPathName(path))
+        return nullptr;
+    std::unique_ptr<TFile> file(TFile::Open(path));
+    if (!file || file->IsZombie())
+        return nullptr;
+    owned.reset(dynamic_cast<TCutG *>(file->Get(name)));
+    return owned.get();
+}
+} // namespace
+
+namespace art::crib {
+
+TGateFormula::TGateFormula() : fRoot(-1), fPos(0), fCol(nullptr), fCutDepth(0) {}
+
+TGateFormula::~TGateFormula() = default;
+TGateFormula::TGateFormula(TGateFormula &&) noexcept = default;
+TGateFormula &TGateFormula::operator=(TGateFormula &&) noexcept = default;
+
+Bool_t TGateFormula::Compile(const TString &expr, TEventCollection *col, TString &error) {
+    fNodes.clear();
+    fLeaves.clear();
+    fCuts.clear();
+    fRoot = -1;
+    fCol = col;
+    fError = "";
+    fCutDepth = 0;
+
+    if (Tokenize(expr)) {
+        fPos = 0;
+        fRoot = ParseOr();
+        if (fRoot >= 0 && Peek().fType != kTokEnd) {
+            fRoot = Fail(Form("unexpected '%s'", Peek().fText.Data()));
+        }
+    }
+    fTokens.clear();
+    fCol = nullptr;
+
+    if (fRoot < 0) {
+        fLeaves.clear();
+        error = Form("%s in \"%s\"", fError.Data(), expr.Data());
+        return kFALSE;
+    }
+    return kTRUE;
+}
+
+Bool_t TGateFormula::Test() const {
+    if (fRoot < 0)
+        return kFALSE;
+    Bool_t valid = kTRUE;
+    const Double_t value = EvalNode(fRoot, valid);
+    return valid && value != 0.0;
+}
+
+Bool_t TGateFormula::Tokenize(const TString &expr) {
+    fTokens.clear();
+    const char *s = expr.Data();
+    const Int_t n = expr.Length();
+    Int_t i = 0;
+    while (i < n) {
+        const char c = s[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) ||
+            (c == '.' && i + 1 < n && std::isdigit(static_cast<unsigned char>(s[i + 1])))) {
+            char *end = nullptr;
+            const Double_t value = std::strtod(s + i, &end);
+            const Int_t len = end - (s + i);
+            fTokens.push_back({kTokNumber, TString(s + i, len), value});
+            i += len;
+            continue;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            Int_t j = i;
+            while (j < n) {
+                if (std::isalnum(static_cast<unsigned char>(s[j])) || s[j] == '_') {
+                    j++;
+                } else if (s[j] == ':' && j + 1 < n && s[j + 1] == ':') {
+                    j += 2;
+                } else {
+                    break;
+                }
+            }
+            fTokens.push_back({kTokName, TString(s + i, j - i), 0.0});
+            i = j;
+            continue;
+        }
+
+        Bool_t found = kFALSE;
+        for (const char *op : {"||", "&&", "<=", ">=", "==", "!="}) {
+            if (i + 1 < n && c == op[0] && s[i + 1] == op[1]) {
+                fTokens.push_back({kTokOp, op, 0.0});
+                i += 2;
+                found = kTRUE;
+                break;
+            }
+        }
+        if (found)
+            continue;
+        if (std::strchr("<>+-*/!()[],.@", c) == nullptr) {
+            Fail(Form("unexpected character '%c'", c));
+            return kFALSE;
+        }
+        fTokens.push_back({kTokOp, TString(c), 0.0});
+        i++;
+    }
+    fTokens.push_back({kTokEnd, "end of expression", 0.0});
+    return kTRUE;
+}
+
+Bool_t TGateFormula::Accept(const char *op) {
+    if (Peek().fType == kTokOp && Peek().fText == op) {
+        fPos++;
+        return kTRUE;
+    }
+    return kFALSE;
+}
+
+Bool_t TGateFormula::Expect(const char *op) {
+    if (Accept(op))
+        return kTRUE;
+    Fail(Form("'%s' is expected before '%s'", op, Peek().fText.Data()));
+    return kFALSE;
+}
+
+Int_t TGateFormula::Fail(const TString &msg) {
+    // keep the first (innermost) reason
+    if (fError.IsNull())
+        fError = msg;
+    return -1;
+}
+
+Int_t TGateFormula::AddNode(Int_t op, Int_t a, Int_t b, Int_t index, Double_t value) {
+    fNodes.push_back({op, a, b, index, value});
+    return fNodes.size() - 1;
+}
+
+Int_t TGateFormula::ParseOr() {
+    Int_t a = ParseAnd();
+    while (a >= 0 && Accept("||")) {
+        const Int_t b = ParseAnd();
+        a = b < 0 ? -1 : AddNode(kOr, a, b);
+    }
+    return a;
+}
+
+Int_t TGateFormula::ParseAnd() {
+    Int_t a = ParseCompare();
+    while (a >= 0 && Accept("&&")) {
+        const Int_t b = ParseCompare();
+        a = b < 0 ? -1 : AddNode(kAnd, a, b);
+    }
+    return a;
+}
+
+Int_t TGateFormula::ParseCompare() {
+    static const std::pair<const char *, Int_t> kCompare[] = {{"<=", kLE}, {">=", kGE}, {"==", kEQ},
+                                                              {"!=", kNE}, {"<", kLT},  {">", kGT}};
+    Int_t a = ParseAdd();
+    if (a < 0)
+        return -1;
+    for (const auto &[op, id] : kCompare) {
+        if (Accept(op)) {
+            const Int_t b = ParseAdd();
+            return b < 0 ? -1 : AddNode(id, a, b);
+        }
+    }
+    return a;
+}
+
+Int_t TGateFormula::ParseAdd() {
+    Int_t a = ParseMul();
+    while (a >= 0) {
+        Int_t op = -1;
+        if (Accept("+"))
+            op = kAdd;
+        else if (Accept("-"))
+            op = kSub;
+        else
+            break;
+        const Int_t b = ParseMul();
+        a = b < 0 ? -1 : AddNode(op, a, b);
+    }
+    return a;
+}
+
+Int_t TGateFormula::ParseMul() {
+    Int_t a = ParseUnary();
+    while (a >= 0) {
+        Int_t op = -1;
+        if (Accept("*"))
+            op = kMul;
+        else if (Accept("/"))
+            op = kDiv;
+        else
+            break;
+        const Int_t b = ParseUnary();
+        a = b < 0 ? -1 : AddNode(op, a, b);
+    }
+    return a;
+}
+
+Int_t TGateFormula::ParseUnary() {
+    if (Accept("+"))
+        return ParseUnary();
+    for (const auto &[op, id] : {std::pair<const char *, Int_t>{"-", kNeg}, {"!", kNot}}) {
+        if (Accept(op)) {
+            const Int_t a = ParseUnary();
+            return a < 0 ? -1 : AddNode(id, a);
+        }
+    }
+    return ParsePrimary();
+}
+
+Int_t TGateFormula::ParsePrimary() {
+    const Token &tok = Peek();
+    if (tok.fType == kTokNumber) {
+        fPos++;
+        return AddNode(kConst, -1, -1, -1, tok.fValue);
+    }
+    if (Accept("(")) {
+        const Int_t a = ParseOr();
+        if (a < 0 || !Expect(")"))
+            return -1;
+        return a;
+    }
+    if (tok.fType == kTokName) {
+        const TString name = tok.fText;
+        fPos++;
+        Int_t nargs = 0;
+        if (Peek().fType != kTokOp)
+            return ParseCut(name, kFALSE);
+        if (Peek().fText == "(")
+            return FindFunction(name, nargs) >= 0 ? ParseFunction(name) : ParseCut(name, kTRUE);
+        if (Peek().fText == "." || Peek().fText == "[" || Peek().fText == "@")
+            return ParseLeaf(name);
+        return ParseCut(name, kFALSE);
+    }
+    return Fail(Form("unexpected '%s'", tok.fText.Data()));
+}
+
+Int_t TGateFormula::ParseFunction(const TString &name) {
+    Int_t nargs = 0;
+    const Int_t func = FindFunction(name, nargs);
+    if (func < 0)
+        return Fail(Form("unknown function %s", name.Data()));
+
+    if (!Expect("("))
+        return -1;
+    const Int_t a = ParseOr();
+    if (a < 0)
+        return -1;
+    Int_t b = -1;
+    if (nargs == 2) {
+        if (!Expect(","))
+            return -1;
+        b = ParseOr();
+        if (b < 0)
+            return -1;
+    }
+    if (!Expect(")"))
+        return -1;
+    return AddNode(nargs == 2 ? kFunc2 : kFunc1, a, b, func);
+}
+
+Int_t TGateFormula::ParseLeaf(const TString &name) {
+    Int_t element = 0;
+    if (Accept("[")) {
+        if (Peek().fType != kTokNumber)
+            return Fail(Form("element index of %s is not a number", name.Data()));
+        element = static_cast<Int_t>(Peek().fValue);
+        fPos++;
+        if (!Expect("]"))
+            return -1;
+    }
+    const Bool_t is_self = Accept("@");
+    if (!Expect("."))
+        return -1;
+
+    auto result = util::GetInputObject<TObject>(fCol, name, "TObject");
+    if (std::holds_alternative<TString>(result))
+        return Fail(std::get<TString>(result));
+
+    Leaf leaf{};
+    leaf.fRef = std::get<TObject **>(result);
+    const TObject *obj = *leaf.fRef;
+    if (!obj)
+        return Fail(Form("%s is null", name.Data()));
+
+    TClass *cl = obj->IsA();
+    leaf.fElement = -1;
+    if (!is_self && obj->InheritsFrom(TClonesArray::Class())) {
+        cl = static_cast<const TClonesArray *>(obj)->GetClass();
+        leaf.fElement = element;
+    }
+
+    // data member chain "fA.fB", or a method of the object
+    TString member;
+    while (kTRUE) {
+        if (Peek().fType != kTokName)
+            return Fail(Form("member name is expected after %s", name.Data()));
+        const TString part = Peek().fText;
+        fPos++;
+
+        if (Accept("(")) {
+            if (!member.IsNull())
+                return Fail(Form("method of the data member %s.%s is not supported", name.Data(), member.Data()));
+            // only constant arguments, passed to TMethodCall as a string
+            TString args;
+            while (!Accept(")")) {
+                const Token &tok = Peek();
+                if (tok.fType == kTokNumber || (tok.fType == kTokOp && (tok.fText == "," || tok.fText == "-"))) {
+                    args += tok.fText;
+                    fPos++;
+                } else {
+                    return Fail(Form("argument of %s.%s should be a number", name.Data(), part.Data()));
+                }
+            }
+            if (!ResolveMethod(leaf, cl, part, args))
+                return -1;
+            break;
+        }
+
+        member += member.IsNull() ? part : "." + part;
+        if (!Accept(".")) {
+            if (!ResolveMember(leaf, cl, member))
+                return -1;
+            break;
+        }
+    }
+
+    fLeaves.emplace_back(std::move(leaf));
+    return AddNode(kLeaf, -1, -1, fLeaves.size() - 1);
+}
+
+Int_t TGateFormula::ParseCut(const TString &name, Bool_t has_args) {
+    std::unique_ptr<TCutG> owned;
+    const TCutG *cut = FindCutG(name, owned);
+    if (!cut) {
+        return Fail(has_args ? Form("unknown function %s", name.Data())
+                             : Form("%s is not a TCutG, or a member is needed after it", name.Data()));
+    }
+
+    Int_t x = -1, y = -1;
+    if (has_args) {
+        if (!Expect("(") || (x = ParseOr()) < 0 || !Expect(",") || (y = ParseOr()) < 0 || !Expect(")"))
+            return -1;
+    } else {
+        // VarX and VarY may contain other cuts
+        if (++fCutDepth > 8)
+            return Fail(Form("too deep nesting of TCutG %s", name.Data()));
+        x = ParseSubExpression(cut->GetVarX());
+        y = x < 0 ? -1 : ParseSubExpression(cut->GetVarY());
+        fCutDepth--;
+        if (y < 0)
+            return Fail(Form("VarX or VarY of TCutG %s cannot be compiled", name.Data()));
+    }
+
+    fCuts.emplace_back();
+    fCuts.back().Build(cut->GetN(), cut->GetX(), cut->GetY());
+    return AddNode(kCut, x, y, fCuts.size() - 1);
+}
+
+Int_t TGateFormula::ParseSubExpression(const TString &expr) {
+    if (expr.IsNull())
+        return Fail("empty expression");
+    std::vector<Token> tokens = std::move(fTokens);
+    const std::size_t pos = fPos;
+
+    Int_t a = -1;
+    if (Tokenize(expr)) {
+        fPos = 0;
+        a = ParseOr();
+        if (a >= 0 && Peek().fType != kTokEnd)
+            a = Fail(Form("unexpected '%s'", Peek().fText.Data()));
+    }
+    fTokens = std::move(tokens);
+    fPos = pos;
+    return a;
+}
+
+Bool_t TGateFormula::ResolveMember(Leaf &leaf, TClass *cl, const TString &member) {
+    // TRealData has the offset of all the (also nested and protected) members from the object start
+    TRealData *rd = cl ? cl->GetRealData(member) : nullptr;
+    if (!rd) {
+        Fail(Form("no data member %s in %s", member.Data(), cl ? cl->GetName() : "(null)"));
+        return kFALSE;
+    }
+    TDataMember *dm = rd->GetDataMember();
+    if (!dm || !dm->IsBasic() || dm->IsaPointer() || dm->GetArrayDim() > 0 || !dm->GetDataType() ||
+        !IsSupportedType(dm->GetDataType()->GetType())) {
+        Fail(Form("%s::%s is not a number", cl->GetName(), member.Data()));
+        return kFALSE;
+    }
+    leaf.fKind = kDataMember;
+    leaf.fOffset = rd->GetThisOffset();
+    leaf.fType = dm->GetDataType()->GetType();
+    return kTRUE;
+}
+
+Bool_t TGateFormula::ResolveMethod(Leaf &leaf, TClass *cl, const TString &method, const TString &args) {
+    if (!cl) {
+        Fail(Form("no class for %s()", method.Data()));
+        return kFALSE;
+    }
+    // the entries of the collection is read without the interpreter
+    if ((method == "GetEntriesFast" || method == "GetEntries") && args.IsNull() &&
+        cl->InheritsFrom(TObjArray::Class())) {
+        leaf.fKind = kEntries;
+        return kTRUE;
+    }
+
+    leaf.fMethod = std::make_unique<TMethodCall>(cl, method, args);
+    if (!leaf.fMethod->IsValid()) {
+        Fail(Form("no method %s(%s) in %s", method.Data(), args.Data(), cl->GetName()));
+        return kFALSE;
+    }
+    switch (leaf.fMethod->ReturnType()) {
+    case TMethodCall::kDouble:
+        leaf.fMethodIsDouble = kTRUE;
+        break;
+    case TMethodCall::kLong:
+        leaf.fMethodIsDouble = kFALSE;
+        break;
+    default:
+        Fail(Form("%s::%s does not return a number", cl->GetName(), method.Data()));
+        return kFALSE;
+    }
+    leaf.fKind = kMethod;
+    return kTRUE;
+}
+
+Double_t TGateFormula::ReadLeaf(const Leaf &leaf, Bool_t &valid) const {
+    TObject *obj = *leaf.fRef;
+    if (!obj) {
+        valid = kFALSE;
+        return 0.0;
+    }
+    if (leaf.fElement >= 0) {
+        const auto *arr = static_cast<const TClonesArray *>(obj);
+        if (leaf.fElement >= arr->GetEntriesFast()) {
+            valid = kFALSE;
+            return 0.0;
+        }
+        obj = arr->UncheckedAt(leaf.fElement);
+    }
+
+    switch (leaf.fKind) {
+    case kEntries:
+        return static_cast<const TObjArray *>(obj)->GetEntriesFast();
+    case kMethod:
+        if (leaf.fMethodIsDouble) {
+            Double_t ret = 0.0;
+            leaf.fMethod->Execute(obj, ret);
+            return ret;
+        } else {
+            Long_t ret = 0;
+            leaf.fMethod->Execute(obj, ret);
+            return ret;
+        }
+    default:
+        return ReadValue(reinterpret_cast<const char *>(obj) + leaf.fOffset, leaf.fType);
+    }
+}
+
+Double_t TGateFormula::EvalNode(Int_t id, Bool_t &valid) const {
+    const Node &node = fNodes[id];
+    switch (node.fOp) {
+    case kConst:
+        return node.fValue;
+    case kLeaf:
+        return ReadLeaf(fLeaves[node.fIndex], valid);
+    case kNeg:
+        return -EvalNode(node.fA, valid);
+    case kNot:
+        return EvalNode(node.fA, valid) == 0.0;
+    case kAnd:
+        // the result is false if the left operand is false or missing, the right one can be skipped
+        return EvalNode(node.fA, valid) != 0.0 && valid && EvalNode(node.fB, valid) != 0.0;
+    case kOr: {
+        // a true left operand does not hide a missing element in the right one (as TTreeFormula)
+        const Bool_t a = EvalNode(node.fA, valid) != 0.0;
+        if (!valid)
+            return 0.0;
+        const Bool_t b = EvalNode(node.fB, valid) != 0.0;
+        return a || b;
+    }
+    case kFunc1: {
+        const Double_t a = EvalNode(node.fA, valid);
+        switch (node.fIndex) {
+        case kAbs:
+            return std::fabs(a);
+        case kSqrt:
+            return std::sqrt(a);
+        case kExp:
+            return std::exp(a);
+        default: // kLog
+            return std::log(a);
+        }
+    }
+    default:
+        break;
+    }
+
+    const Double_t a = EvalNode(node.fA, valid);
+    const Double_t b = EvalNode(node.fB, valid);
+    switch (node.fOp) {
+    case kAdd:
+        return a + b;
+    case kSub:
+        return a - b;
+    case kMul:
+        return a * b;
+    case kDiv:
+        return a / b;
+    case kLT:
+        return a < b;
+    case kLE:
+        return a <= b;
+    case kGT:
+        return a > b;
+    case kGE:
+        return a >= b;
+    case kEQ:
+        return a == b;
+    case kNE:
+        return a != b;
+    case kCut:
+        return fCuts[node.fIndex].IsInside(a, b);
+    default: // kFunc2
+        switch (node.fIndex) {
+        case kPow:
+            return std::pow(a, b);
+        case kMin:
+            return std::min(a, b);
+        default: // kMax
+            return std::max(a, b);
+        }
+    }
+}
+
+} // namespace art::crib
@@ -0,0 +1,160 @@
+/**
+ * @file    TGateFormula.h
+ * @brief   Gate expression compiled once into a node list with resolved data addresses.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 19:44:05
+ * @note    last modified: 2026-10-18 22:24:51
+ * @details
+ */
+
+#ifndef CRIB_TGATEFORMULA_H_
+#define CRIB_TGATEFORMULA_H_
+
+#include "TCutGIndex.h"
+
+#include <TString.h>
+
+#include <memory>
+#include <vector>
+
+class TClass;
+class TMethodCall;
+class TObject;
+
+namespace art {
+class TEventCollection;
+} // namespace art
+
+namespace art::crib {
+
+/**
+ * @class TGateFormula
+ * @brief Compiles the TTreeFormula-like expression of the gate definitions.
+ *
+ * The expression is parsed once, and every reference to the event collection is resolved to
+ * (object reference, element index, byte offset and type) or to a TMethodCall. The evaluation
+ * is a walk over the flat node list, and `&&` is short-circuit.
+ *
+ * Supported syntax (the subset used in steering/gate):
+ * - `name.fMember`, `name.fObj.fMember`: data member of the element 0 of the TClonesArray
+ *   (or of the object itself if it is not a TClonesArray), `name[i].fMember` for the element i
+ * - `name.Method(1, 2.0)`: method with constant arguments
+ * - `name@.GetEntriesFast()`, `name@.Method()`: method of the collection object itself
+ * - numbers, `+ - * /`, `< <= > >= == !=`, `! && ||`, parentheses
+ * - functions: abs, fabs, sqrt, exp, log, pow, min, max (and the TMath:: names)
+ * - `cutname`: TCutG of the name tested with its VarX and VarY, `cutname(x, y)` with the given ones.
+ *   The TCutG is taken from gROOT->GetListOfSpecials() (macro/load_tcutg.C), or gate/cutname.root
+ *   (TCatCmdTCutG), and tested by TCutGIndex
+ *
+ * If an element does not exist in the event (e.g. the array is empty), the result of Test() is false,
+ * as TTreeFormula gives no instance. This holds for both operands of `||`, so `a || b` is false
+ * when the element of `b` is missing even if `a` is true.
+ */
+class TGateFormula {
+  public:
+    TGateFormula();
+    ~TGateFormula();
+    TGateFormula(TGateFormula &&) noexcept;
+    TGateFormula &operator=(TGateFormula &&) noexcept;
+
+    /**
+     * @brief Parses the expression and resolves the objects in the event collection.
+     * @return kFALSE if the expression cannot be compiled, the reason is in `error`
+     */
+    Bool_t Compile(const TString &expr, TEventCollection *col, TString &error);
+
+    /// @brief evaluates the expression, kFALSE if it is 0 or a referred element does not exist
+    Bool_t Test() const;
+
+    /// @brief number of the references to the event collection
+    Int_t GetNLeaves() const { return fLeaves.size(); }
+
+  private:
+    enum EOp {
+        kConst,
+        kLeaf,
+        kNeg,
+        kNot,
+        kAdd,
+        kSub,
+        kMul,
+        kDiv,
+        kLT,
+        kLE,
+        kGT,
+        kGE,
+        kEQ,
+        kNE,
+        kAnd,
+        kOr,
+        kFunc1,
+        kFunc2,
+        kCut
+    };
+    struct Node {
+        Int_t fOp;
+        Int_t fA;        // first operand (node index)
+        Int_t fB;        // second operand (node index)
+        Int_t fIndex;    // leaf index or function id
+        Double_t fValue; // constant
+    };
+    /// @brief resolved reference to the event collection
+    struct Leaf {
+        TObject **fRef;                       // object in the event collection
+        Int_t fElement;                       // element index of TClonesArray, -1: the object itself
+        Int_t fKind;                          // ELeafKind
+        Long_t fOffset;                       // data member
+        Int_t fType;                          // EDataType of the data member
+        std::unique_ptr<TMethodCall> fMethod; // method
+        Bool_t fMethodIsDouble;               // return type of the method
+    };
+    enum ELeafKind { kDataMember, kEntries, kMethod };
+
+    struct Token {
+        Int_t fType; // ETokenType
+        TString fText;
+        Double_t fValue;
+    };
+    enum ETokenType { kTokNumber, kTokName, kTokOp, kTokEnd };
+
+    std::vector<Node> fNodes;
+    std::vector<Leaf> fLeaves;
+    std::vector<TCutGIndex> fCuts;
+    Int_t fRoot;
+
+    // parser state, used only in Compile
+    std::vector<Token> fTokens;
+    std::size_t fPos;
+    TEventCollection *fCol;
+    TString fError;
+    Int_t fCutDepth;
+
+    Bool_t Tokenize(const TString &expr);
+    const Token &Peek() const { return fTokens[fPos]; }
+    Bool_t Accept(const char *op);
+    Bool_t Expect(const char *op);
+    Int_t Fail(const TString &msg);
+    Int_t AddNode(Int_t op, Int_t a = -1, Int_t b = -1, Int_t index = -1, Double_t value = 0.0);
+    Int_t ParseOr();
+    Int_t ParseAnd();
+    Int_t ParseCompare();
+    Int_t ParseAdd();
+    Int_t ParseMul();
+    Int_t ParseUnary();
+    Int_t ParsePrimary();
+    Int_t ParseFunction(const TString &name);
+    Int_t ParseLeaf(const TString &name);
+    Int_t ParseCut(const TString &name, Bool_t has_args);
+    Int_t ParseSubExpression(const TString &expr);
+    Bool_t ResolveMember(Leaf &leaf, TClass *cl, const TString &member);
+    Bool_t ResolveMethod(Leaf &leaf, TClass *cl, const TString &method, const TString &args);
+
+    Double_t EvalNode(Int_t id, Bool_t &valid) const;
+    Double_t ReadLeaf(const Leaf &leaf, Bool_t &valid) const;
+
+    TGateFormula(const TGateFormula &) = delete;
+    TGateFormula &operator=(const TGateFormula &) = delete;
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TGATEFORMULA_H_
@@ -0,0 +1,33 @@
+/**
+ * @file    TIndexedCutG.cc
+ * @brief   TCutG with the bounding box and grid index for IsInside.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:16:27
+ * @note    last modified: 2026-10-18 20:16:27
+ * @details
+ */
+
+#include "TIndexedCutG.h"
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TIndexedCutG);
+
+namespace art::crib {
+
+TIndexedCutG::TIndexedCutG(const TCutG &cut, Int_t ncell) : TCutG(cut), fNCell(ncell) {
+    BuildIndex(ncell);
+}
+
+void TIndexedCutG::BuildIndex(Int_t ncell) {
+    fNCell = ncell;
+    fIndex.Build(GetN(), GetX(), GetY(), fNCell);
+}
+
+Int_t TIndexedCutG::IsInside(Double_t x, Double_t y) const {
+    // e.g. read from a file
+    if (!fIndex.IsBuilt())
+        fIndex.Build(GetN(), GetX(), GetY(), fNCell);
+    return fIndex.IsInside(x, y);
+}
+
+} // namespace art::crib
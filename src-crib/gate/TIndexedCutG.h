@@ -0,0 +1,46 @@
+/**
+ * @file    TIndexedCutG.h
+ * @brief   TCutG with the bounding box and grid index for IsInside.
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 20:16:27
+ * @note    last modified: 2026-10-18 20:16:27
+ * @details
+ */
+
+#ifndef CRIB_TINDEXEDCUTG_H_
+#define CRIB_TINDEXEDCUTG_H_
+
+#include "TCutGIndex.h"
+
+#include <TCutG.h>
+
+namespace art::crib {
+
+/**
+ * @class TIndexedCutG
+ * @brief Drop-in replacement of TCutG whose IsInside uses TCutGIndex.
+ *
+ * It is registered in gROOT->GetListOfSpecials() as TCutG, so the cut name can be used
+ * in TTree::Draw, SetAlias (macro/setalias.C) and the gate definitions as before.
+ * macro/load_tcutg.C replaces the TCutG objects in gate/<name>.root with this class.
+ * The index is made at the first IsInside call; call BuildIndex after changing the points.
+ */
+class TIndexedCutG : public TCutG {
+  public:
+    TIndexedCutG() = default;
+    explicit TIndexedCutG(const TCutG &cut, Int_t ncell = 64);
+
+    Int_t IsInside(Double_t x, Double_t y) const override;
+
+    /// @brief (re)builds the index with ncell x ncell cells
+    void BuildIndex(Int_t ncell = 64);
+
+  private:
+    mutable TCutGIndex fIndex; //!
+    Int_t fNCell = 64;         ///< number of cells along each axis
+
+    ClassDefOverride(TIndexedCutG, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TINDEXEDCUTG_H_
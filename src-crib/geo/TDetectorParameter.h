@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-18 11:32:42
- * @note    last modified: 2025-01-08 10:41:05
+ * @note    last modified: 2026-10-18 18:41:26
  * @details
  */
 
@@ -24,6 +24,9 @@ class art::crib::TDetectorParameter : public TParameterObject {
     TDetectorParameter(const TDetectorParameter &);
     TDetectorParameter &operator=(const TDetectorParameter &rhs);
 
+    /// @brief shape of the detector volume
+    enum EShape { kBox = 0, kTube = 1, kTrapezoid = 2 };
+
     TString GetDetName() const { return fDetName; }
     void SetDetName(TString str) { fDetName = str; }
 
@@ -52,6 +55,12 @@ class art::crib::TDetectorParameter : public TParameterObject {
     IntVec_t GetStripNum() const { return fStrip; }
     void SetStripNum(IntVec_t vec) { fStrip = vec; }
 
+    Int_t GetShape() const { return fShape; }
+    void SetShape(Int_t val) { fShape = val; }
+    Double_t GetShapeParameter(Int_t id) const { return fShapePrm[id]; }
+    DoubleVec_t GetShapeParameter() const { return fShapePrm; }
+    void SetShapeParameter(DoubleVec_t vec) { fShapePrm = vec; }
+
     Double_t GetDistance() const { return fDistance; }
     void SetDistance(Double_t val) { fDistance = val; }
     Double_t GetAngle() const { return fAngle; }
@@ -61,24 +70,27 @@ class art::crib::TDetectorParameter : public TParameterObject {
 
   protected:
     TString fDetName;
-    Int_t fN; //! number of SSDs
+    Int_t fN; // number of SSDs
+
+    StringVec_t fMaterial;
+    DoubleVec_t fThickness;
+    DoubleVec_t fPedestal; // if fCharge is below this, treat as 0 MeV
 
-    StringVec_t fMaterial;  //!
-    DoubleVec_t fThickness; //!
-    DoubleVec_t fPedestal;  //! if fCharge is below this, treat as 0 MeV
+    DoubleVec_t fCenterRot;
+    DoubleVec_t fOffset;
 
-    DoubleVec_t fCenterRot; //!
-    DoubleVec_t fOffset;    //!
+    DoubleVec_t fSize; // bounding box (x, y, z)
+    IntVec_t fStrip;
 
-    DoubleVec_t fSize; //!
-    IntVec_t fStrip;   //!
+    Int_t fShape = kBox;   // EShape
+    DoubleVec_t fShapePrm; // tube: (rmin, rmax), trapezoid: (x at -y/2, x at +y/2)
 
     Double_t fDistance;
     Double_t fAngle; // radian
     Double_t fMaxRadius;
 
   private:
-    ClassDefOverride(TDetectorParameter, 1) // ppac parameter holder
+    ClassDefOverride(TDetectorParameter, 2) // ppac parameter holder
 };
 
 #endif // end of #ifndef _TDETECTORPARAMETER_H_
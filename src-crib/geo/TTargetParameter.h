@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-17 22:14:55
- * @note    last modified: 2025-01-08 10:40:44
+ * @note    last modified: 2026-10-18 18:41:26
  * @details
  */
 
@@ -34,13 +34,13 @@ class art::crib::TTargetParameter : public TParameterObject {
     void SetThickness(Double_t val) { fThickness = val; }
 
   protected:
-    TString fName;       //! target name
-    Bool_t fIsGas;       //! gas target or not
-    Double_t fZ;         //! z position (not use in gas target, mm)
-    Double_t fThickness; //! thickness of the target (mm)
+    TString fName;       // target name
+    Bool_t fIsGas;       // gas target or not
+    Double_t fZ;         // z position (not use in gas target, mm)
+    Double_t fThickness; // thickness of the target (mm)
 
   private:
-    ClassDefOverride(TTargetParameter, 0)
+    ClassDefOverride(TTargetParameter, 1)
 };
 
 #endif // end of #ifndef _TTARGETPARAMETER_H_
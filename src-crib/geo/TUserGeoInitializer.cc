@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-17 21:27:49
- * @note    last modified: 2024-08-23 21:33:03
+ * @note    last modified: 2026-10-18 18:41:26
  * @details
  */
 
@@ -12,9 +12,14 @@
 #include "TDetectorParameter.h"
 #include "TTargetParameter.h"
 #include <TDirectory.h>
+#include <TFile.h>
+#include <TMD5.h>
 #include <TVector3.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <memory>
+
 using art::crib::TUserGeoInitializer;
 
 ClassImp(TUserGeoInitializer);
@@ -42,6 +47,13 @@ const char *kNodeKeyStrip = "strip";
 const char *kNodeKeyIsGas = "is_gas";
 const char *kNodeKeyZ = "z_position";
 const char *kNodeKeyPedestal = "pedestal";
+
+// snapshot file, increment the version when the contents are changed
+constexpr Int_t kSnapshotVersion = 1;
+const char *kSnapshotKeyInfo = "snapshot_info";
+const char *kSnapshotKeyGeometry = "geometry";
+const char *kSnapshotKeyDetector = "detectors";
+const char *kSnapshotKeyTarget = "targets";
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -49,6 +61,13 @@ const char *kNodeKeyPedestal = "pedestal";
 ///
 /// - "FileName": geometry file, like prm/geo/expname.yaml
 /// - "Visible": make detector geometry figure
+/// - "UseSnapshot": load the geometry from the binary snapshot if the yaml file is not changed
+///   (default: true). The snapshot (TGeoManager and parameter arrays in a ROOT file)
+///   is written at the first run and identified by the md5 of the yaml file.
+/// - "SnapshotFile": snapshot file name (default: "<FileName>.snapshot.root")
+///
+/// The detector volume type is "box" (size: [x, y, z]), "tube" (size: [rmin, rmax, z])
+/// or "trapezoid" (size: [x at -y/2, x at +y/2, y, z]). z is the thickness direction.
 ///
 /// in the source code, the geometry parameter objects
 /// can be used by the name of "prm_detector" or "prm_target"
@@ -65,6 +84,9 @@ TUserGeoInitializer::TUserGeoInitializer() : fGeom(nullptr) {
     RegisterProcessorParameter("FileName", "parameter file of detector geometry", fFileName, TString(""));
 
     RegisterProcessorParameter("Visible", "add artemis directory or not", fIsVisible, false);
+    RegisterOptionalParameter("UseSnapshot", "load/save the binary snapshot of the geometry", fUseSnapshot, true);
+    RegisterOptionalParameter("SnapshotFile", "snapshot file, <FileName>.snapshot.root if empty", fSnapshotFile,
+                              TString(""));
 }
 
 TUserGeoInitializer::~TUserGeoInitializer() {
@@ -81,7 +103,6 @@ void TUserGeoInitializer::Init(TEventCollection *col) {
     if (gGeoManager) {
         delete gGeoManager;
     }
-    fGeom = new TGeoManager("geometry", "Detector Geometry");
 
     Info("Init", "detector parameters are produced to %s", fDetPrmName.Data());
     fDetParameterArray = new TClonesArray("art::crib::TDetectorParameter");
@@ -89,7 +110,24 @@ void TUserGeoInitializer::Init(TEventCollection *col) {
     Info("Init", "target parameters are produced to %s", fTargetPrmName.Data());
     fTargetParameterArray = new TClonesArray("art::crib::TTargetParameter");
 
-    GeometryFromYaml(fFileName);
+    TString snapshot_key;
+    const TString snapshot_path = fSnapshotFile.IsNull() ? fFileName + ".snapshot.root" : fSnapshotFile;
+    if (fUseSnapshot) {
+        snapshot_key = GetSnapshotKey(fFileName);
+    }
+
+    if (!snapshot_key.IsNull() && LoadSnapshot(snapshot_path, snapshot_key)) {
+        Info("Init", "geometry is loaded from the snapshot %s", snapshot_path.Data());
+        if (fIsVisible) {
+            gDirectory->Add(fGeom->GetTopVolume());
+        }
+    } else {
+        fGeom = new TGeoManager("geometry", "Detector Geometry");
+        GeometryFromYaml(fFileName);
+        if (!snapshot_key.IsNull() && !IsError()) {
+            SaveSnapshot(snapshot_path, snapshot_key);
+        }
+    }
 
     col->Add("geom", fGeom, fOutputIsTransparent);
 
@@ -159,21 +197,15 @@ void TUserGeoInitializer::GeometryFromYaml(TString yamlfile) {
             return;
         }
         TString det_name = yaml_det[i][kNodeKeyName].as<std::string>();
+        TString det_type = yaml_det[i][kNodeKeyType].as<std::string>();
         Int_t det_mat_id = yaml_det[i][kNodeKeyMaterial].as<int>();
         DoubleVec_t det_size = yaml_det[i][kNodeKeySize].as<std::vector<double>>();
-        if (det_size.size() != 3) {
-            SetStateError("input yaml error, detector volume size must be 3D");
-            return;
-        }
 
-        // currently only support box type detector
-        if (yaml_det[i][kNodeKeyType].as<std::string>() != "box") {
-            SetStateError("Currently only support only box type");
+        TDetectorParameter *prm = static_cast<TDetectorParameter *>(fDetParameterArray->ConstructedAt(i));
+        TGeoVolume *det = MakeDetectorVolume(det_name, det_type, med_vec[det_mat_id], det_size, prm);
+        if (!det) {
             return;
         }
-
-        TGeoVolume *det =
-            fGeom->MakeBox(det_name.Data(), med_vec[det_mat_id], det_size[0] / 2., det_size[1] / 2., det_size[2] / 2.);
         DoubleVec_t rot_point = yaml_prm[i][kNodeKeyCenterRot].as<std::vector<double>>();
         DoubleVec_t offset = yaml_prm[i][kNodeKeyOffset].as<std::vector<double>>();
         IntVec_t det_strip = yaml_prm[i][kNodeKeyStrip].as<std::vector<int>>();
@@ -194,7 +226,6 @@ void TUserGeoInitializer::GeometryFromYaml(TString yamlfile) {
         top->AddNode(det, i, det_trans);
 
         // parameter input
-        TDetectorParameter *prm = static_cast<TDetectorParameter *>(fDetParameterArray->ConstructedAt(i));
         DoubleVec_t thickness = yaml_prm[i][kNodeKeyThickness].as<std::vector<double>>();
         DoubleVec_t pedestal = yaml_prm[i][kNodeKeyPedestal].as<std::vector<double>>();
         if (thickness.size() != pedestal.size()) {
@@ -229,7 +260,6 @@ void TUserGeoInitializer::GeometryFromYaml(TString yamlfile) {
         prm->SetOffset(offset);
         prm->SetDistance(distance);
         prm->SetAngle(angle); // radian
-        prm->SetSize(det_size);
         prm->SetStripNum(det_strip);
     }
 
@@ -256,3 +286,118 @@ void TUserGeoInitializer::GeometryFromYaml(TString yamlfile) {
         gDirectory->Add(top);
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// The volume is placed so that local z is the thickness direction.
+/// The bounding box is set to TDetectorParameter::SetSize, so the strip
+/// calculation of the other processors is the same as the box type,
+/// and the cross section of the tube/trapezoid is set to SetShapeParameter.
+
+TGeoVolume *TUserGeoInitializer::MakeDetectorVolume(const TString &name, const TString &type, TGeoMedium *med,
+                                                     const DoubleVec_t &size, TDetectorParameter *prm) {
+    TGeoVolume *vol = nullptr;
+    if (type == "box") {
+        if (size.size() != 3) {
+            SetStateError("input yaml error, box size must be [x, y, z]");
+            return nullptr;
+        }
+        vol = fGeom->MakeBox(name.Data(), med, size[0] / 2., size[1] / 2., size[2] / 2.);
+        prm->SetShape(TDetectorParameter::kBox);
+        prm->SetShapeParameter({});
+        prm->SetSize(size);
+    } else if (type == "tube") {
+        if (size.size() != 3 || size[0] < 0.0 || size[1] <= size[0]) {
+            SetStateError("input yaml error, tube size must be [rmin, rmax, z] (rmin < rmax)");
+            return nullptr;
+        }
+        vol = fGeom->MakeTube(name.Data(), med, size[0], size[1], size[2] / 2.);
+        prm->SetShape(TDetectorParameter::kTube);
+        prm->SetShapeParameter({size[0], size[1]});
+        prm->SetSize({2.0 * size[1], 2.0 * size[1], size[2]});
+    } else if (type == "trapezoid") {
+        if (size.size() != 4) {
+            SetStateError("input yaml error, trapezoid size must be [x at -y/2, x at +y/2, y, z]");
+            return nullptr;
+        }
+        // TGeoTrap: x half length changes along local y, same for the both z faces
+        vol = fGeom->MakeTrap(name.Data(), med, size[3] / 2., 0.0, 0.0, size[2] / 2., size[0] / 2., size[1] / 2., 0.0,
+                              size[2] / 2., size[0] / 2., size[1] / 2., 0.0);
+        prm->SetShape(TDetectorParameter::kTrapezoid);
+        prm->SetShapeParameter({size[0], size[1]});
+        prm->SetSize({std::max(size[0], size[1]), size[2], size[3]});
+    } else {
+        SetStateError(Form("detector type %s is not supported (box, tube or trapezoid)", type.Data()));
+        return nullptr;
+    }
+    return vol;
+}
+
+TString TUserGeoInitializer::GetSnapshotKey(const TString &yamlfile) const {
+    std::unique_ptr<TMD5> md5(TMD5::FileChecksum(yamlfile.Data()));
+    if (!md5) {
+        return "";
+    }
+    return Form("v%d %s", kSnapshotVersion, md5->AsString());
+}
+
+Bool_t TUserGeoInitializer::LoadSnapshot(const TString &path, const TString &key) {
+    if (gSystem->AccessPathName(path.Data())) {
+        return kFALSE;
+    }
+
+    TDirectory::TContext context;
+    std::unique_ptr<TFile> file(TFile::Open(path.Data()));
+    if (!file || file->IsZombie()) {
+        Warning("Init", "cannot open the snapshot %s", path.Data());
+        return kFALSE;
+    }
+    const TNamed *info = file->Get<TNamed>(kSnapshotKeyInfo);
+    if (!info || key != info->GetTitle()) {
+        Info("Init", "snapshot %s is not made from the current yaml, remake it", path.Data());
+        return kFALSE;
+    }
+    std::unique_ptr<TClonesArray> det(file->Get<TClonesArray>(kSnapshotKeyDetector));
+    std::unique_ptr<TClonesArray> target(file->Get<TClonesArray>(kSnapshotKeyTarget));
+    if (!det || !target) {
+        Warning("Init", "parameter arrays are not found in the snapshot %s", path.Data());
+        return kFALSE;
+    }
+    file->Close();
+
+    // TGeoManager::Import sets gGeoManager, the geometry is already closed
+    fGeom = TGeoManager::Import(path.Data(), kSnapshotKeyGeometry);
+    if (!fGeom) {
+        Warning("Init", "geometry is not found in the snapshot %s", path.Data());
+        return kFALSE;
+    }
+    fDetParameterArray->AbsorbObjects(det.get());
+    fTargetParameterArray->AbsorbObjects(target.get());
+    return kTRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// The snapshot is written to a temporary file and renamed,
+/// so that the parallel jobs do not read a half-written file.
+
+void TUserGeoInitializer::SaveSnapshot(const TString &path, const TString &key) {
+    const TString tmp_path = Form("%s.%d.tmp", path.Data(), gSystem->GetPid());
+    {
+        TDirectory::TContext context;
+        std::unique_ptr<TFile> file(TFile::Open(tmp_path.Data(), "RECREATE"));
+        if (!file || file->IsZombie()) {
+            Warning("Init", "cannot write the snapshot %s", tmp_path.Data());
+            return;
+        }
+        fGeom->Write(kSnapshotKeyGeometry);
+        fDetParameterArray->Write(kSnapshotKeyDetector, TObject::kSingleKey);
+        fTargetParameterArray->Write(kSnapshotKeyTarget, TObject::kSingleKey);
+        TNamed(kSnapshotKeyInfo, key.Data()).Write();
+        file->Close();
+    }
+    if (gSystem->Rename(tmp_path.Data(), path.Data()) != 0) {
+        Warning("Init", "cannot rename the snapshot to %s", path.Data());
+        gSystem->Unlink(tmp_path.Data());
+        return;
+    }
+    Info("Init", "geometry snapshot is saved to %s", path.Data());
+}
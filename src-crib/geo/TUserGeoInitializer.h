@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-17 21:30:15
- * @note    last modified: 2025-01-08 10:31:04
+ * @note    last modified: 2026-10-18 18:41:26
  * @details
  */
 
@@ -16,9 +16,11 @@
 
 namespace art::crib {
 class TUserGeoInitializer;
+class TDetectorParameter;
 }
 
 class TClonesArray;
+class TGeoMedium;
 
 class art::crib::TUserGeoInitializer : public TProcessor {
   public:
@@ -46,6 +48,11 @@ class art::crib::TUserGeoInitializer : public TProcessor {
     /// @brief Make figure of Detectors of not.
     Bool_t fIsVisible;
 
+    /// @brief Load/save the binary snapshot instead of parsing the yaml file.
+    Bool_t fUseSnapshot;
+    /// @brief Snapshot file name, "<FileName>.snapshot.root" if empty.
+    TString fSnapshotFile;
+
     /// @brief Detector parameter object (art::TDetectorParameter array)
     TClonesArray *fDetParameterArray;
     /// @brief Target parameter object (art::TTargetParameter array)
@@ -56,6 +63,13 @@ class art::crib::TUserGeoInitializer : public TProcessor {
 
   private:
     void GeometryFromYaml(TString yamlfile);
+    TGeoVolume *MakeDetectorVolume(const TString &name, const TString &type, TGeoMedium *med,
+                                   const DoubleVec_t &size, TDetectorParameter *prm);
+
+    /// @brief "v<format version> <md5 of the yaml file>", empty if the file cannot be read
+    TString GetSnapshotKey(const TString &yamlfile) const;
+    Bool_t LoadSnapshot(const TString &path, const TString &key);
+    void SaveSnapshot(const TString &path, const TString &key);
 
     // Copy constructor (prohibited)
     TUserGeoInitializer(const TUserGeoInitializer &) = delete;
@@ -22,17 +22,285 @@
 #include "ROOT/TProcessExecutor.hxx"
 #endif
 
+#include "RVersion.h"
+#include "TH1.h"
+#include "TList.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include <ROOT/TBufferMerger.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 ////////////////////////////////////////////////////////////////////////////////
+// thread-based merge (-t): histograms are merged in memory and trees are cloned into
+// a TBufferMerger which writes the target directly, so no partial file is written.
+
+namespace {
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 26, 0)
+using ROOT::TBufferMerger;
+#else
+using ROOT::Experimental::TBufferMerger;
+#endif
+
+/// @brief objects except trees of the input files, "dir/name" in the order of the keys
+struct MergedObjects {
+    std::vector<std::pair<std::string, std::unique_ptr<TObject>>> fObjects;
+    std::unordered_map<std::string, std::size_t> fIndex;
+
+    void Add(const std::string &path, TObject *obj) {
+        if (fIndex.count(path)) {
+            delete obj;
+            return;
+        }
+        fIndex.emplace(path, fObjects.size());
+        fObjects.emplace_back(path, obj);
+    }
+};
+
+/// @return kFALSE if some keys cannot be read, the other keys are read anyway
+Bool_t ReadDirectory(TDirectory *dir, const std::string &prefix, MergedObjects &out, std::vector<std::string> &trees) {
+    // keys of the same name are in the order of the cycle, use the highest one as TFileMerger
+    Bool_t ok = kTRUE;
+    std::unordered_set<std::string> seen;
+    TIter next(dir->GetListOfKeys());
+    while (auto *key = static_cast<TKey *>(next())) {
+        const std::string name = key->GetName();
+        if (!seen.insert(name).second)
+            continue;
+        const std::string path = prefix.empty() ? name : prefix + "/" + name;
+        TClass *cl = TClass::GetClass(key->GetClassName());
+        if (!cl) {
+            std::cerr << "chadd unknown class " << key->GetClassName() << " of " << path << ", skipped" << std::endl;
+            continue;
+        }
+        if (cl->InheritsFrom(TDirectory::Class())) {
+            TDirectory *sub = dir->GetDirectory(name.c_str());
+            if (!sub) {
+                std::cerr << "chadd cannot read the directory " << path << std::endl;
+                ok = kFALSE;
+                continue;
+            }
+            ok = ReadDirectory(sub, path, out, trees) && ok;
+        } else if (cl->InheritsFrom(TTree::Class())) {
+            trees.emplace_back(path);
+        } else {
+            TObject *obj = key->ReadObj();
+            if (!obj) {
+                std::cerr << "chadd cannot read the object " << path << std::endl;
+                ok = kFALSE;
+                continue;
+            }
+            if (auto *hist = dynamic_cast<TH1 *>(obj))
+                hist->SetDirectory(nullptr);
+            out.Add(path, obj);
+        }
+    }
+    return ok;
+}
+
+/// @brief merges srcs into dst, the objects of the same path are merged at once
+void MergeInto(MergedObjects &dst, std::vector<MergedObjects> &srcs) {
+    std::deque<TList> lists(dst.fObjects.size());
+    for (auto &src : srcs) {
+        for (auto &[path, obj] : src.fObjects) {
+            const auto it = dst.fIndex.find(path);
+            if (it == dst.fIndex.end()) {
+                dst.Add(path, obj.release());
+                lists.emplace_back();
+            } else {
+                lists[it->second].Add(obj.get());
+            }
+        }
+    }
+    for (std::size_t i = 0; i < lists.size(); i++) {
+        if (lists[i].IsEmpty())
+            continue;
+        // objects without Merge (e.g. TNamed) are taken from the first file, as TFileMerger
+        TObject *obj = dst.fObjects[i].second.get();
+        if (ROOT::MergeFunc_t merge = obj->IsA()->GetMerge())
+            merge(obj, &lists[i], nullptr);
+    }
+    // the lists refer to the objects owned by srcs, so they are emptied before srcs is freed
+    lists.clear();
+    srcs.clear();
+}
+
+TDirectory *GetDirectory(TDirectory *top, const std::string &path) {
+    TDirectory *dir = top;
+    std::stringstream ss(path);
+    std::string name;
+    while (std::getline(ss, name, '/')) {
+        TDirectory *sub = dir->GetDirectory(name.c_str());
+        dir = sub ? sub : dir->mkdir(name.c_str());
+    }
+    return dir;
+}
+
+std::pair<std::string, std::string> SplitPath(const std::string &path) {
+    const auto pos = path.rfind('/');
+    if (pos == std::string::npos)
+        return {"", path};
+    return {path.substr(0, pos), path.substr(pos + 1)};
+}
+
+/**
+ * @brief thread-based merge
+ * @param (nThreads) number of threads, each of them accumulates a contiguous range of the files
+ * @param (fanIn) number of the files (or accumulators) merged at once
+ *
+ * Each tree is cloned in full into the in-memory file of TBufferMerger, so a large tree
+ * needs its size in memory per thread until it is written to the target.
+ */
+Bool_t ThreadMerge(const char *target, const std::vector<std::string> &files, Int_t nThreads, Int_t fanIn,
+                   Int_t comp, Bool_t noTrees, Bool_t fastTrees, Bool_t skipErrors, Int_t verbosity) {
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(kFALSE);
+    const Int_t nFiles = files.size();
+    nThreads = std::max(1, std::min(nThreads, nFiles));
+    fanIn = std::max(2, fanIn);
+    std::atomic<bool> failed{false};
+
+    // 1. objects except trees: nThreads accumulators, then a tree reduction of them
+    std::vector<MergedObjects> acc(nThreads);
+    std::vector<std::vector<std::string>> trees(nFiles);
+    auto accumulate = [&](Int_t t) {
+        const Int_t begin = static_cast<Long64_t>(nFiles) * t / nThreads;
+        const Int_t end = static_cast<Long64_t>(nFiles) * (t + 1) / nThreads;
+        std::vector<MergedObjects> batch;
+        for (Int_t i = begin; i < end && !failed; i++) {
+            std::unique_ptr<TFile> file(TFile::Open(files[i].c_str()));
+            if (!file || file->IsZombie()) {
+                std::cerr << "chadd " << (skipErrors ? "skipping file with error: " : "exiting due to error in ")
+                          << files[i] << std::endl;
+                failed = failed || !skipErrors;
+                continue;
+            }
+            batch.emplace_back();
+            if (!ReadDirectory(file.get(), "", batch.back(), trees[i])) {
+                std::cerr << "chadd " << (skipErrors ? "skipping unreadable objects in " : "exiting due to error in ")
+                          << files[i] << std::endl;
+                failed = failed || !skipErrors;
+            }
+            if ((Int_t)batch.size() == fanIn - 1)
+                MergeInto(acc[t], batch);
+        }
+        MergeInto(acc[t], batch);
+    };
+    {
+        std::vector<std::thread> workers;
+        for (Int_t t = 0; t < nThreads; t++)
+            workers.emplace_back(accumulate, t);
+        for (auto &w : workers)
+            w.join();
+    }
+    if (failed)
+        return kFALSE;
+
+    for (Int_t stride = 1; stride < nThreads; stride *= fanIn) {
+        std::vector<std::thread> workers;
+        for (Int_t t = 0; t < nThreads; t += stride * fanIn) {
+            workers.emplace_back([&acc, t, stride, fanIn, nThreads]() {
+                std::vector<MergedObjects> srcs;
+                for (Int_t k = 1; k < fanIn && t + k * stride < nThreads; k++)
+                    srcs.emplace_back(std::move(acc[t + k * stride]));
+                MergeInto(acc[t], srcs);
+            });
+        }
+        for (auto &w : workers)
+            w.join();
+    }
+
+    // 2. write the objects, and the trees in the order of the files
+    TBufferMerger merger(target, "RECREATE", comp);
+    {
+        auto out = merger.GetFile();
+        for (auto &[path, obj] : acc[0].fObjects) {
+            const auto [dir, name] = SplitPath(path);
+            GetDirectory(out.get(), dir)->WriteTObject(obj.get(), name.c_str());
+        }
+        out->Write();
+    }
+    acc.clear();
+    if (noTrees)
+        return kTRUE;
+
+    std::vector<Int_t> treeFiles;
+    for (Int_t i = 0; i < nFiles; i++) {
+        if (!trees[i].empty())
+            treeFiles.emplace_back(i);
+    }
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t turn = 0;
+    auto cloneTrees = [&]() {
+        for (std::size_t k = next++; k < treeFiles.size(); k = next++) {
+            const Int_t i = treeFiles[k];
+            auto out = merger.GetFile();
+            std::unique_ptr<TFile> file(failed ? nullptr : TFile::Open(files[i].c_str()));
+            Bool_t ok = file && !file->IsZombie();
+            for (std::size_t j = 0; ok && j < trees[i].size(); j++) {
+                auto *tree = file->Get<TTree>(trees[i][j].c_str());
+                ok = tree != nullptr;
+                if (ok) {
+                    GetDirectory(out.get(), SplitPath(trees[i][j]).first)->cd();
+                    tree->CloneTree(-1, fastTrees ? "fast" : "");
+                }
+            }
+            if (!ok && !failed) {
+                std::cerr << "chadd " << (skipErrors ? "skipping trees with error: " : "exiting due to error in ")
+                          << files[i] << std::endl;
+                failed = !skipErrors;
+            }
+            // the turn is passed also on error, otherwise the other threads wait forever
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&turn, k]() { return turn == k; });
+            if (ok)
+                out->Write();
+            turn++;
+            lock.unlock();
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (Int_t t = 0; t < nThreads; t++)
+        workers.emplace_back(cloneTrees);
+    for (auto &w : workers)
+        w.join();
+
+    if (verbosity > 1) {
+        std::cout << "chadd merged " << nFiles << " files (" << treeFiles.size() << " with trees) with " << nThreads
+                  << " threads, fan-in " << fanIn << std::endl;
+    }
+    return !failed;
+}
+} // namespace
 
 int main(int argc, char **argv) {
     if (argc < 3 || "-h" == std::string(argv[1]) || "--help" == std::string(argv[1])) {
         std::cerr << "\nusage: hadd [-a] [-f] [-f[0-9]] [-fk] [-ff] [-k] [-O] [-T] [-v V] "
-                  << "[-j J] [-dbg] [-d D] [-n N] [-cachesize CACHESIZE] [-experimental-io-features "
+                  << "[-j J] [-t T] [-fanin F] [-dbg] [-d D] [-n N] [-cachesize CACHESIZE] [-experimental-io-features "
                   << "EXPERIMENTAL_IO_FEATURES] TARGET SOURCES \n\n"
                   << "This program will add histograms, trees and other objects from a list\n"
                   << "of ROOT files and write them to a target ROOT file. The target file is\n"
                   << "newly created and must not exist, or if -f (\" force \") is given, must\n"
                   << "not be one of the source files.\n\n"
+                  << "-t T: merge with T threads (default: number of cores) without temporary files,\n"
+                  << "      histograms are merged in memory F files at a time (-fanin F, default 8)\n"
+                  << "      and trees are written to the target in the order of the sources.\n"
+                  << "      Each input tree is cloned in memory before it is written (up to T trees\n"
+                  << "      at once), so the memory grows with the tree size times the threads.\n\n"
                   << "It is copied from ROOT source file and linked artemis library\n";
         return (argc == 2 && ("-h" == std::string(argv[1]) || "--help" == std::string(argv[1])))
                    ? 0
@@ -48,6 +316,10 @@ int main(int argc, char **argv) {
     Bool_t keepCompressionAsIs = kFALSE;
     Bool_t useFirstInputCompression = kFALSE;
     Bool_t multiproc = kFALSE;
+    Bool_t multithread = kFALSE;
+    Bool_t customWorkingDir = kFALSE;
+    Bool_t ioFeatures = kFALSE;
+    Int_t fanIn = 8;
     Bool_t debug = kFALSE;
     Int_t maxopenedfiles = 0;
     Int_t verbosity = 99;
@@ -55,6 +327,7 @@ int main(int argc, char **argv) {
     SysInfo_t s;
     gSystem->GetSysInfo(&s);
     auto nProcesses = s.fCpus;
+    Int_t nThreads = s.fCpus;
     auto workingDir = gSystem->TempDirectory();
     int outputPlace = 0;
     int ffirst = 2;
@@ -86,6 +359,7 @@ int main(int argc, char **argv) {
                               << ". We will use the system's temporal directory.\n";
                 } else {
                     workingDir = argv[a + 1];
+                    customWorkingDir = kTRUE;
                 }
                 ++a;
                 ++ffirst;
@@ -122,6 +396,36 @@ int main(int argc, char **argv) {
             }
             multiproc = kTRUE;
             ++ffirst;
+        } else if (strcmp(argv[a], "-t") == 0) {
+            // If the number of threads is not specified, use the number of cores.
+            if (a + 1 != argc && isdigit(argv[a + 1][0])) {
+                Long_t request = strtol(argv[a + 1], 0, 10);
+                if (request > 0 && request < kMaxInt) {
+                    nThreads = (Int_t)request;
+                } else {
+                    std::cerr << "Error: could not parse the number of threads passed after -t: " << argv[a + 1]
+                              << ". We will use the default value (number of logical cores).\n";
+                }
+                ++a;
+                ++ffirst;
+            }
+            multithread = kTRUE;
+            ++ffirst;
+        } else if (strcmp(argv[a], "-fanin") == 0) {
+            if (a + 1 >= argc) {
+                std::cerr << "Error: no fan-in was provided after -fanin.\n";
+            } else {
+                Long_t request = strtol(argv[a + 1], 0, 10);
+                if (request >= 2 && request < kMaxInt) {
+                    fanIn = (Int_t)request;
+                } else {
+                    std::cerr << "Error: fan-in passed after -fanin should be 2 or more: " << argv[a + 1]
+                              << ". We will use the default value (8).\n";
+                }
+                ++a;
+                ++ffirst;
+            }
+            ++ffirst;
         } else if (strcmp(argv[a], "-cachesize=") == 0) {
             int size;
             static constexpr size_t arglen = std::char_traits<char>::length("-cachesize=");
@@ -174,6 +478,7 @@ int main(int argc, char **argv) {
                 std::stringstream ss;
                 ss.str(argv[++a]);
                 ++ffirst;
+                ioFeatures = kTRUE;
                 std::string item;
                 while (std::getline(ss, item, ',')) {
                     if (!features.Set(item)) {
@@ -352,6 +657,37 @@ int main(int argc, char **argv) {
         else
             std::cout << "chadd compression setting for all output: " << newcomp << '\n';
     }
+    if (multithread && append) {
+        std::cerr << "chadd -t does not support -a, merging with TFileMerger" << std::endl;
+        multithread = kFALSE;
+    }
+    if (multithread) {
+        // the thread mode reads each file once and writes no partial file
+        if (maxopenedfiles > 0)
+            std::cerr << "chadd -t ignores -n" << std::endl;
+        if (!cacheSize.IsNull())
+            std::cerr << "chadd -t ignores -cachesize" << std::endl;
+        if (customWorkingDir)
+            std::cerr << "chadd -t ignores -d" << std::endl;
+        if (ioFeatures)
+            std::cerr << "chadd -t ignores -experimental-io-features" << std::endl;
+        if (keepCompressionAsIs)
+            std::cerr << "chadd -t ignores -fk, the target is written with the compression " << newcomp
+                      << std::endl;
+        if (!force && !gSystem->AccessPathName(targetname)) {
+            std::cerr << "chadd error opening target file (does " << targetname << " exist?)." << std::endl;
+            std::cerr << "Pass \"-f\" argument to force re-creation of output file." << std::endl;
+            exit(1);
+        }
+        const Bool_t status = ThreadMerge(targetname, allSubfiles, nThreads, fanIn, newcomp, noTrees,
+                                          !reoptimize, skip_errors, verbosity);
+        if (verbosity == 1) {
+            std::cout << "chadd " << (status ? "merged " : "failure during the merge of ") << allSubfiles.size()
+                      << " input files into " << targetname << ".\n";
+        }
+        return status ? 0 : 1;
+    }
+
     if (append) {
         if (!fileMerger.OutputFile(targetname, "UPDATE", newcomp)) {
             std::cerr << "chadd error opening target file for update :" << argv[ffirst - 1] << "." << std::endl;
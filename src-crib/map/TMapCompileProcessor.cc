@@ -0,0 +1,310 @@
+/**
+ * @file    TMapCompileProcessor.cc
+ * @brief   Compile the map files into a flat table and scatter raw hits into TMappedData
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 10:21:40
+ * @note    last modified: 2026-10-18 10:21:40
+ * @details
+ */
+
+#include "TMapCompileProcessor.h"
+#include "../TProcessorUtil.h"
+
+#include "TMappedData.h"
+#include <TRawDataObject.h>
+#include <TSegmentedData.h>
+#include <TSystem.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TMapCompileProcessor);
+
+namespace {
+/// (dev, fp, mod, geo, ch)
+using ChannelKey = std::array<Int_t, 5>;
+/// (dev, fp, mod, geo)
+using ModuleKey = std::array<Int_t, 4>;
+/// (dev, fp, mod)
+using SegmentKey = std::array<Int_t, 3>;
+
+struct MappedChannel {
+    ChannelKey fKey;
+    Int_t fCatID;
+    Int_t fDetID;
+    Int_t fType;
+};
+
+/// remove the comment and leading/trailing spaces
+std::string StripLine(const std::string &line) {
+    std::string str = line.substr(0, line.find('#'));
+    const auto first = str.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return "";
+    const auto last = str.find_last_not_of(" \t\r");
+    return str.substr(first, last - first + 1);
+}
+
+/// map files accept both ',' and white spaces as delimiters
+bool ParseIntegers(std::string line, std::vector<Int_t> &values) {
+    values.clear();
+    for (auto &c : line) {
+        if (c == ',')
+            c = ' ';
+    }
+    std::istringstream iss(line);
+    std::string token;
+    while (iss >> token) {
+        char *end = nullptr;
+        const long val = std::strtol(token.c_str(), &end, 10);
+        if (*end != '\0')
+            return false;
+        values.emplace_back(static_cast<Int_t>(val));
+    }
+    return true;
+}
+} // namespace
+
+namespace art::crib {
+
+TMapCompileProcessor::TMapCompileProcessor() {
+    RegisterInputCollection("SegmentedDataName", "name of the segmented data",
+                            fSegmentedDataName, TString("segdata"));
+    RegisterOutputCollection("OutputCollection", "name of the output mapped data (art::crib::TMappedData)",
+                             fOutputColName, TString("mapdata"));
+
+    RegisterProcessorParameter("MapConfig", "list of the map files (mapper.conf format)",
+                               fMapConfig, TString("mapper.conf"));
+    RegisterProcessorParameter("SegmentList", "segment list yaml file",
+                               fSegmentListFile, TString("conf/seg/seglist.yaml"));
+    RegisterProcessorParameter("ModuleList", "module list yaml file (used for the channel number check)",
+                               fModuleListFile, TString("conf/seg/modulelist.yaml"));
+
+    IntVec_t init_i_vec;
+    RegisterProcessorParameter("CatIDs", "categories to be compiled (all if empty)",
+                               fCatIDs, init_i_vec);
+}
+
+TMapCompileProcessor::~TMapCompileProcessor() {
+    delete fOutData;
+    fOutData = nullptr;
+}
+
+void TMapCompileProcessor::Init(TEventCollection *col) {
+    auto result = util::GetInputObject<TSegmentedData>(
+        col, fSegmentedDataName, "art::TSegmentedData");
+    if (std::holds_alternative<TString>(result)) {
+        SetStateError(std::get<TString>(result));
+        return;
+    }
+    fSegmentedData = std::get<TSegmentedData **>(result);
+
+    delete fOutData;
+    fOutData = new TMappedData;
+
+    if (!CompileMap())
+        return;
+
+    col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+    Info("Init", "%s -> %s, %zu channels in %d categories from %zu segments",
+         fSegmentedDataName.Data(), fOutputColName.Data(),
+         fEntries.size(), fOutData->GetNumCategories(), fSegments.size());
+}
+
+/**
+ * @details
+ * The compilation consists of
+ * 1. module list: module type -> channel number
+ * 2. segment list: (dev, fp, mod, geo) -> channel number
+ * 3. mapper.conf and map files: (dev, fp, mod, geo, ch) -> (cat, det, type)
+ * 4. category buffers and per-segment lookup tables
+ */
+Bool_t TMapCompileProcessor::CompileMap() {
+    FileStat_t info;
+
+    // 1. module list (optional)
+    std::map<std::string, Int_t> module_nch;
+    if (!fModuleListFile.IsNull() && gSystem->GetPathInfo(fModuleListFile.Data(), info) == 0) {
+        YAML::Node yaml_mod = YAML::LoadFile(fModuleListFile.Data());
+        for (const auto &node : yaml_mod) {
+            if (node.second["ch"])
+                module_nch[node.first.as<std::string>()] = node.second["ch"].as<int>();
+        }
+    } else {
+        Warning("CompileMap", "module list '%s' not found, channel range is not checked",
+                fModuleListFile.Data());
+    }
+
+    // 2. segment list
+    if (gSystem->GetPathInfo(fSegmentListFile.Data(), info) != 0) {
+        SetStateError(Form("File %s does not exist.", fSegmentListFile.Data()));
+        return kFALSE;
+    }
+    std::map<ModuleKey, Int_t> known_modules; // value: channel number (0 if unknown)
+    YAML::Node yaml_seg = YAML::LoadFile(fSegmentListFile.Data());
+    for (const auto &node : yaml_seg) {
+        const auto segid = node.second["segid"].as<std::vector<int>>();
+        if (segid.size() != 3) {
+            SetStateError(Form("segid of %s must be [dev, fp, mod]", node.first.as<std::string>().c_str()));
+            return kFALSE;
+        }
+        const std::string type = node.second["type"] ? node.second["type"].as<std::string>() : "";
+        const Int_t nch = module_nch.count(type) ? module_nch[type] : 0;
+        for (const auto &mod : node.second["modules"]) {
+            const auto &id = mod["id"];
+            const Int_t geo = id.IsSequence() ? id[0].as<int>() : id.as<int>();
+            known_modules[{segid[0], segid[1], segid[2], geo}] = nch;
+        }
+    }
+
+    // 3. mapper.conf and map files
+    std::ifstream fconf(fMapConfig.Data());
+    if (!fconf) {
+        SetStateError(Form("File %s does not exist.", fMapConfig.Data()));
+        return kFALSE;
+    }
+
+    std::map<ChannelKey, TString> used_channels; // for the duplication check
+    std::vector<MappedChannel> channels;
+    std::string conf_line;
+    while (std::getline(fconf, conf_line)) {
+        conf_line = StripLine(conf_line);
+        if (conf_line.empty())
+            continue;
+
+        std::istringstream iss(conf_line);
+        std::string map_path;
+        Int_t ncol = 0;
+        if (!(iss >> map_path >> ncol) || ncol <= 0) {
+            SetStateError(Form("mapper.conf format error: %s", conf_line.c_str()));
+            return kFALSE;
+        }
+
+        std::ifstream fmap(map_path);
+        if (!fmap) {
+            SetStateError(Form("File %s does not exist.", map_path.c_str()));
+            return kFALSE;
+        }
+
+        std::string map_line;
+        std::vector<Int_t> values;
+        Int_t line_num = 0;
+        while (std::getline(fmap, map_line)) {
+            ++line_num;
+            map_line = StripLine(map_line);
+            if (map_line.empty())
+                continue;
+            if (!ParseIntegers(map_line, values)) {
+                SetStateError(Form("Invalid format in mapfile: %s:%d", map_path.c_str(), line_num));
+                return kFALSE;
+            }
+            if ((Int_t)values.size() != 2 + 5 * ncol) {
+                SetStateError(Form("Incorrect parameter count in mapfile: %s:%d (expected %d columns)",
+                                   map_path.c_str(), line_num, ncol));
+                return kFALSE;
+            }
+
+            const Int_t catid = values[0];
+            const Int_t detid = values[1];
+            for (Int_t iCol = 0; iCol < ncol; ++iCol) {
+                ChannelKey key;
+                std::copy_n(values.begin() + 2 + 5 * iCol, 5, key.begin());
+                // negative value means "not connected"
+                if (std::any_of(key.begin(), key.end(), [](Int_t v) { return v < 0; }))
+                    continue;
+
+                const TString where = Form("%s:%d[%d]", map_path.c_str(), line_num, iCol);
+                auto [it, inserted] = used_channels.emplace(key, where);
+                if (!inserted) {
+                    SetStateError(Form("duplicate map entries for (%d, %d, %d, %d, %d): %s and %s",
+                                       key[0], key[1], key[2], key[3], key[4],
+                                       it->second.Data(), where.Data()));
+                    return kFALSE;
+                }
+
+                auto mod_it = known_modules.find({key[0], key[1], key[2], key[3]});
+                if (mod_it == known_modules.end()) {
+                    Warning("CompileMap", "module (%d, %d, %d, geo=%d) is not in %s: %s",
+                            key[0], key[1], key[2], key[3], fSegmentListFile.Data(), where.Data());
+                } else if (mod_it->second > 0 && key[4] >= mod_it->second) {
+                    SetStateError(Form("ch %d exceeds the channel number (%d) of the module: %s",
+                                       key[4], mod_it->second, where.Data()));
+                    return kFALSE;
+                }
+
+                if (!fCatIDs.empty() && std::find(fCatIDs.begin(), fCatIDs.end(), catid) == fCatIDs.end())
+                    continue;
+                channels.push_back({key, catid, detid, iCol});
+            }
+        }
+    }
+
+    if (channels.empty()) {
+        SetStateError("no channel is compiled, check MapConfig and CatIDs");
+        return kFALSE;
+    }
+
+    // 4. category buffers and lookup tables
+    std::map<Int_t, std::pair<Int_t, Int_t>> cat_size; // catid -> (ndet, ntype)
+    std::map<SegmentKey, std::pair<Int_t, Int_t>> seg_size; // segment -> (ngeo, nch)
+    for (const auto &ch : channels) {
+        auto &cs = cat_size[ch.fCatID];
+        cs.first = std::max(cs.first, ch.fDetID + 1);
+        cs.second = std::max(cs.second, ch.fType + 1);
+        auto &ss = seg_size[{ch.fKey[0], ch.fKey[1], ch.fKey[2]}];
+        ss.first = std::max(ss.first, ch.fKey[3] + 1);
+        ss.second = std::max(ss.second, ch.fKey[4] + 1);
+    }
+    for (const auto &[catid, size] : cat_size) {
+        fOutData->AddCategory(catid, size.first, size.second);
+    }
+
+    fSegments.clear();
+    std::map<SegmentKey, Int_t> seg_index;
+    for (const auto &[key, size] : seg_size) {
+        seg_index[key] = fSegments.size();
+        fSegments.push_back({key[0], key[1], key[2], size.first, size.second,
+                             std::vector<Int_t>(size.first * size.second, -1)});
+    }
+
+    fEntries.clear();
+    fEntries.reserve(channels.size());
+    for (const auto &ch : channels) {
+        auto &seg = fSegments[seg_index[{ch.fKey[0], ch.fKey[1], ch.fKey[2]}]];
+        seg.fSlot[ch.fKey[3] * seg.fNCh + ch.fKey[4]] = fEntries.size();
+        fEntries.push_back({fOutData->FindCategory(ch.fCatID), ch.fDetID, ch.fType});
+    }
+    return kTRUE;
+}
+
+void TMapCompileProcessor::Process() {
+    fOutData->Clear();
+    if (!fSegmentedData)
+        return;
+
+    for (const auto &seg : fSegments) {
+        const TObjArray *const hits = (*fSegmentedData)->FindSegment(seg.fDev, seg.fFP, seg.fMod);
+        if (!hits)
+            continue;
+
+        for (Int_t iHit = 0, nHit = hits->GetEntriesFast(); iHit != nHit; ++iHit) {
+            const auto *const hit = static_cast<TRawDataObject *>(hits->UncheckedAt(iHit));
+            const Int_t geo = hit->GetGeo();
+            const Int_t ch = hit->GetCh();
+            if (geo < 0 || geo >= seg.fNGeo || ch < 0 || ch >= seg.fNCh)
+                continue;
+            const Int_t idx = seg.fSlot[geo * seg.fNCh + ch];
+            if (idx < 0)
+                continue;
+            const MapEntry &entry = fEntries[idx];
+            fOutData->Fill(entry.fCatIndex, entry.fDetID, entry.fType, hit->GetValue());
+        }
+    }
+}
+
+} // namespace art::crib
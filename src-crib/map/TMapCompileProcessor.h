@@ -0,0 +1,102 @@
+/**
+ * @file    TMapCompileProcessor.h
+ * @brief   Compile the map files into a flat table and scatter raw hits into TMappedData
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 10:21:40
+ * @note    last modified: 2026-10-18 10:21:40
+ * @details
+ */
+
+#ifndef CRIB_TMAPCOMPILEPROCESSOR_H_
+#define CRIB_TMAPCOMPILEPROCESSOR_H_
+
+#include <TProcessor.h>
+
+namespace art {
+class TSegmentedData;
+} // namespace art
+
+namespace art::crib {
+class TMappedData;
+
+/**
+ * @class TMapCompileProcessor
+ * @brief Crib-side map compiler.
+ *
+ * At Init, the map files listed in mapper.conf and the segment list
+ * (conf/seg/seglist.yaml) are read and compiled into one flat table,
+ * (dev, fp, mod, geo, ch) -> (category, detector ID, type).
+ * The consistency checks of pyscripts/map_checker.py are done here:
+ * - wrong number of columns in a map line is an error,
+ * - a channel mapped twice is an error,
+ * - a channel beyond the module channel number is an error,
+ * - a module not listed in the segment list is reported as a warning.
+ *
+ * In the event loop, each compiled segment is scanned once and the hits are
+ * written directly into the per-category buffers of TMappedData.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: mapcompiler
+ *     type: art::crib::TMapCompileProcessor
+ *     parameter:
+ *       SegmentedDataName: segdata            # [TString] input segmented data
+ *       OutputCollection: mapdata             # [TString] output TMappedData
+ *       MapConfig: mapper.conf                # [TString] list of map files
+ *       SegmentList: conf/seg/seglist.yaml    # [TString] segment list
+ *       ModuleList: conf/seg/modulelist.yaml  # [TString] module list (channel number)
+ *       CatIDs: []                            # [IntVec_t] compile only these categories (all if empty)
+ *       OutputTransparency: 1
+ * ```
+ */
+class TMapCompileProcessor : public TProcessor {
+  public:
+    TMapCompileProcessor();
+    ~TMapCompileProcessor() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+
+  private:
+    /// @brief one mapped channel
+    struct MapEntry {
+        Int_t fCatIndex; ///< index of the category in TMappedData
+        Int_t fDetID;
+        Int_t fType;
+    };
+
+    /// @brief lookup table of one (dev, fp, mod) segment
+    struct CompiledSegment {
+        Int_t fDev;
+        Int_t fFP;
+        Int_t fMod;
+        Int_t fNGeo;              ///< max geo + 1
+        Int_t fNCh;               ///< max ch + 1
+        std::vector<Int_t> fSlot; ///< geo * fNCh + ch -> index of fEntries (-1 if not mapped)
+    };
+
+    TString fSegmentedDataName;
+    TString fOutputColName;
+    TString fMapConfig;
+    TString fSegmentListFile;
+    TString fModuleListFile;
+    IntVec_t fCatIDs;
+
+    TSegmentedData **fSegmentedData{nullptr}; //!
+    TMappedData *fOutData{nullptr};           //!
+
+    std::vector<MapEntry> fEntries;         //!
+    std::vector<CompiledSegment> fSegments; //!
+
+    Bool_t CompileMap();
+
+    TMapCompileProcessor(const TMapCompileProcessor &) = delete;
+    TMapCompileProcessor &operator=(const TMapCompileProcessor &) = delete;
+
+    ClassDefOverride(TMapCompileProcessor, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TMAPCOMPILEPROCESSOR_H_
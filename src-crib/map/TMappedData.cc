@@ -0,0 +1,60 @@
+/**
+ * @file    TMappedData.cc
+ * @brief   Flat (struct-of-arrays) container of mapped raw hits
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 10:05:12
+ * @note    last modified: 2026-10-18 10:05:12
+ * @details
+ */
+
+#include "TMappedData.h"
+
+ClassImp(art::crib::TMappedData);
+
+namespace art::crib {
+
+TMappedData::TMappedData() = default;
+
+TMappedData::~TMappedData() = default;
+
+Int_t TMappedData::AddCategory(Int_t catid, Int_t ndet, Int_t ntype) {
+    if (catid < 0 || ndet <= 0 || ntype <= 0)
+        return -1;
+
+    Int_t icat = FindCategory(catid);
+    if (icat >= 0)
+        return icat;
+
+    Category cat;
+    cat.fCatID = catid;
+    cat.fNDet = ndet;
+    cat.fNType = ntype;
+    cat.fFirst.assign(ndet * ntype, kInvalidD);
+    cat.fMult.assign(ndet * ntype, 0);
+    cat.fTouched.reserve(ndet * ntype);
+    cat.fHitDet.reserve(ndet * ntype);
+    cat.fHitType.reserve(ndet * ntype);
+    cat.fHitValue.reserve(ndet * ntype);
+
+    icat = fCategories.size();
+    fCategories.emplace_back(std::move(cat));
+    if ((Int_t)fCatIndex.size() <= catid)
+        fCatIndex.resize(catid + 1, -1);
+    fCatIndex[catid] = icat;
+    return icat;
+}
+
+void TMappedData::Clear(Option_t *) {
+    for (auto &cat : fCategories) {
+        for (const auto slot : cat.fTouched) {
+            cat.fFirst[slot] = kInvalidD;
+            cat.fMult[slot] = 0;
+        }
+        cat.fTouched.clear();
+        cat.fHitDet.clear();
+        cat.fHitType.clear();
+        cat.fHitValue.clear();
+    }
+}
+
+} // namespace art::crib
@@ -0,0 +1,114 @@
+/**
+ * @file    TMappedData.h
+ * @brief   Flat (struct-of-arrays) container of mapped raw hits
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 10:05:12
+ * @note    last modified: 2026-10-18 10:05:12
+ * @details
+ */
+
+#ifndef CRIB_TMAPPEDDATA_H_
+#define CRIB_TMAPPEDDATA_H_
+
+#include <TObject.h>
+#include <constant.h>
+
+#include <vector>
+
+namespace art::crib {
+/**
+ * @class TMappedData
+ * @brief Per-category hit buffers filled by TMapCompileProcessor.
+ *
+ * Each registered category owns
+ * - a dense slot table of size (number of detector IDs) x (number of types),
+ *   holding the first hit value and the multiplicity of each slot, and
+ * - flat hit arrays (detector ID, type, value) in the order the hits were
+ *   found in the segmented data.
+ *
+ * Readers access the buffers by category index (see FindCategory()), so that
+ * no TObjArray hierarchy has to be walked in the event loop.
+ */
+class TMappedData : public TObject {
+  public:
+    /**
+     * @brief Buffers of one category.
+     */
+    struct Category {
+        Int_t fCatID{kInvalidI}; ///< category ID written in the map file
+        Int_t fNDet{0};          ///< number of detector IDs (max ID + 1)
+        Int_t fNType{0};         ///< number of types (columns in the map file)
+
+        std::vector<Double_t> fFirst; ///< first hit value of each slot (kInvalidD if empty)
+        std::vector<Int_t> fMult;     ///< multiplicity of each slot
+        std::vector<Int_t> fTouched;  ///< slots filled in this event (used for cheap clearing)
+
+        std::vector<Int_t> fHitDet;      ///< detector ID of each hit
+        std::vector<Int_t> fHitType;     ///< type of each hit
+        std::vector<Double_t> fHitValue; ///< raw value of each hit
+    };
+
+    TMappedData();
+    ~TMappedData() override;
+
+    /**
+     * @brief Registers a category and allocates its slot table.
+     * @return Index of the category used by the accessors.
+     */
+    Int_t AddCategory(Int_t catid, Int_t ndet, Int_t ntype);
+
+    /**
+     * @brief Returns the category index of the given category ID, or -1.
+     */
+    Int_t FindCategory(Int_t catid) const {
+        return (catid >= 0 && catid < (Int_t)fCatIndex.size()) ? fCatIndex[catid] : -1;
+    }
+
+    Int_t GetNumCategories() const { return fCategories.size(); }
+    const Category &GetCategory(Int_t icat) const { return fCategories[icat]; }
+
+    /**
+     * @brief Stores one hit. Bounds are guaranteed by the compiled map table.
+     */
+    void Fill(Int_t icat, Int_t det, Int_t type, Double_t value) {
+        Category &cat = fCategories[icat];
+        const Int_t slot = det * cat.fNType + type;
+        if (cat.fMult[slot]++ == 0) {
+            cat.fFirst[slot] = value;
+            cat.fTouched.emplace_back(slot);
+        }
+        cat.fHitDet.emplace_back(det);
+        cat.fHitType.emplace_back(type);
+        cat.fHitValue.emplace_back(value);
+    }
+
+    Int_t GetNHit(Int_t icat) const { return fCategories[icat].fHitValue.size(); }
+    Int_t GetHitDetID(Int_t icat, Int_t i) const { return fCategories[icat].fHitDet[i]; }
+    Int_t GetHitType(Int_t icat, Int_t i) const { return fCategories[icat].fHitType[i]; }
+    Double_t GetHitValue(Int_t icat, Int_t i) const { return fCategories[icat].fHitValue[i]; }
+
+    /// @brief first hit value of (det, type), kInvalidD if no hit
+    Double_t GetValue(Int_t icat, Int_t det, Int_t type) const {
+        const Category &cat = fCategories[icat];
+        return cat.fFirst[det * cat.fNType + type];
+    }
+    /// @brief number of hits in (det, type)
+    Int_t GetMultiplicity(Int_t icat, Int_t det, Int_t type) const {
+        const Category &cat = fCategories[icat];
+        return cat.fMult[det * cat.fNType + type];
+    }
+
+    /**
+     * @brief Resets only the slots touched in the previous event.
+     */
+    void Clear(Option_t *opt = "") override;
+
+  private:
+    std::vector<Category> fCategories; //!
+    std::vector<Int_t> fCatIndex;      //! catid -> category index
+
+    ClassDefOverride(TMappedData, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TMAPPEDDATA_H_
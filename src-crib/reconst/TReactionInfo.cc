@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 22:28:15
- * @note    last modified: 2024-09-03 16:15:36
+ * @note    last modified: 2026-10-18 16:02:47
  * @details
  */
 
@@ -21,7 +21,9 @@ TReactionInfo::TReactionInfo()
       fX(kInvalidD),
       fY(kInvalidD),
       fZ(kInvalidD),
-      fExEnergy(kInvalidD) {
+      fExEnergy(kInvalidD),
+      fWeight(1.0),
+      fPolarWeight(1.0) {
     TDataObject::SetID(kInvalidI);
 }
 
@@ -36,7 +38,9 @@ TReactionInfo::TReactionInfo(const TReactionInfo &rhs)
       fX(rhs.fX),
       fY(rhs.fY),
       fZ(rhs.fZ),
-      fExEnergy(rhs.fExEnergy) {
+      fExEnergy(rhs.fExEnergy),
+      fWeight(rhs.fWeight),
+      fPolarWeight(rhs.fPolarWeight) {
 }
 
 TReactionInfo &TReactionInfo::operator=(const TReactionInfo &rhs) {
@@ -57,6 +61,8 @@ void TReactionInfo::Copy(TObject &dest) const {
     cobj.fY = this->GetY();
     cobj.fZ = this->GetZ();
     cobj.fExEnergy = this->GetExEnergy();
+    cobj.fWeight = this->GetWeight();
+    cobj.fPolarWeight = this->GetPolarWeight();
 }
 
 void TReactionInfo::Clear(Option_t *opt) {
@@ -70,4 +76,6 @@ void TReactionInfo::Clear(Option_t *opt) {
     fY = kInvalidD;
     fZ = kInvalidD;
     fExEnergy = kInvalidD;
+    fWeight = 1.0;
+    fPolarWeight = 1.0;
 }
@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 22:27:43
- * @note    last modified: 2025-01-08 10:34:08
+ * @note    last modified: 2026-10-18 16:02:47
  * @details
  */
 
@@ -52,6 +52,11 @@ class art::crib::TReactionInfo : public TDataObject {
     Double_t GetExEnergy() const { return fExEnergy; }
     void SetExEnergy(Double_t arg) { fExEnergy = arg; }
 
+    Double_t GetWeight() const { return fWeight; }
+    void SetWeight(Double_t arg) { fWeight = arg; }
+    Double_t GetPolarWeight() const { return fPolarWeight; }
+    void SetPolarWeight(Double_t arg) { fPolarWeight = arg; }
+
     void Copy(TObject &dest) const override;
     void Clear(Option_t *opt = "") override;
 
@@ -76,7 +81,12 @@ class art::crib::TReactionInfo : public TDataObject {
     /// @brief excited energy of residual nucleus
     Double_t fExEnergy;
 
-    ClassDefOverride(TReactionInfo, 2)
+    /// @brief importance sampling weight of the event (1 if not biased)
+    Double_t fWeight;
+    /// @brief weight of the theta_cm sampling only, used for the distribution in theta_cm
+    Double_t fPolarWeight;
+
+    ClassDefOverride(TReactionInfo, 3)
 };
 
 #endif // end of #ifndef _TREACTIONINFO_H_
@@ -0,0 +1,190 @@
+/**
+ * @file    TBeamPhaseSpace.cc
+ * @brief   Kernel density model of the measured beam phase space (X, Y, A, B)
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 17:52:30
+ * @note    last modified: 2026-10-18 17:52:30
+ * @details
+ */
+
+#include "TBeamPhaseSpace.h"
+
+#include <TClonesArray.h>
+#include <TMath.h>
+#include <TRandom.h>
+#include <TTrack.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TBeamPhaseSpace);
+
+namespace art::crib {
+
+/**
+ * @details
+ * Reservoir sampling with a fixed seed keeps the model reproducible
+ * for the same track file.
+ */
+Int_t TBeamPhaseSpace::Build(TTree *tree, const char *branch, Int_t maxPoints, Double_t bandwidthScale) {
+    if (!tree || maxPoints <= 0) {
+        return 0;
+    }
+    TClonesArray *tracks = nullptr;
+    tree->SetBranchStatus("*", 0);
+    tree->SetBranchStatus(branch, 1);
+    if (tree->SetBranchAddress(branch, &tracks) < 0) {
+        Error("Build", "branch %s not found", branch);
+        return 0;
+    }
+
+    std::vector<Double_t> points;
+    points.reserve(static_cast<std::size_t>(maxPoints) * kDim);
+    std::mt19937_64 engine(12345);
+    Long64_t nValid = 0;
+    for (Long64_t i = 0, n = tree->GetEntries(); i < n; ++i) {
+        tree->GetEntry(i);
+        if (!tracks || tracks->GetEntriesFast() != 1) {
+            continue;
+        }
+        const auto *track = dynamic_cast<const TTrack *>(tracks->At(0));
+        if (!track) {
+            continue;
+        }
+        const Double_t val[kDim] = {track->GetX(), track->GetY(), track->GetA(), track->GetB()};
+        if (!std::isfinite(val[0]) || !std::isfinite(val[1]) || !std::isfinite(val[2]) || !std::isfinite(val[3])) {
+            continue;
+        }
+        Long64_t slot = nValid++;
+        if (slot >= maxPoints) {
+            slot = std::uniform_int_distribution<Long64_t>(0, slot)(engine);
+            if (slot >= maxPoints) {
+                continue;
+            }
+            std::copy(val, val + kDim, points.begin() + slot * kDim);
+        } else {
+            points.insert(points.end(), val, val + kDim);
+        }
+    }
+    tree->ResetBranchAddresses();
+    tree->SetBranchStatus("*", 1);
+    Info("Build", "%lld tracks, %zu points are used", nValid, points.size() / kDim);
+    return Build(points, bandwidthScale);
+}
+
+Int_t TBeamPhaseSpace::Build(const std::vector<Double_t> &points, Double_t bandwidthScale) {
+    const Int_t n = points.size() / kDim;
+    fPoints.assign(points.begin(), points.begin() + n * kDim);
+    std::fill(fMean, fMean + kDim, 0.0);
+    std::fill(fCov, fCov + kDim * kDim, 0.0);
+    std::fill(fChol, fChol + kDim * kDim, 0.0);
+    fBandwidth = 0.0;
+    if (n < 2) {
+        return n;
+    }
+
+    for (Int_t i = 0; i < n; ++i) {
+        for (Int_t k = 0; k < kDim; ++k) {
+            fMean[k] += points[i * kDim + k];
+        }
+    }
+    for (Int_t k = 0; k < kDim; ++k) {
+        fMean[k] /= n;
+    }
+    for (Int_t i = 0; i < n; ++i) {
+        for (Int_t k = 0; k < kDim; ++k) {
+            for (Int_t l = 0; l <= k; ++l) {
+                fCov[k * kDim + l] += (points[i * kDim + k] - fMean[k]) * (points[i * kDim + l] - fMean[l]);
+            }
+        }
+    }
+    for (Int_t k = 0; k < kDim; ++k) {
+        for (Int_t l = 0; l <= k; ++l) {
+            fCov[k * kDim + l] /= n - 1;
+            fCov[l * kDim + k] = fCov[k * kDim + l];
+        }
+    }
+
+    // Silverman's rule of thumb
+    fBandwidth = bandwidthScale * std::pow(4.0 / (kDim + 2.0), 1.0 / (kDim + 4.0)) * std::pow(n, -1.0 / (kDim + 4.0));
+
+    // Cholesky decomposition of bandwidth^2 * cov, a degenerate direction gets no smearing
+    const Double_t h2 = fBandwidth * fBandwidth;
+    for (Int_t k = 0; k < kDim; ++k) {
+        for (Int_t l = 0; l <= k; ++l) {
+            Double_t sum = h2 * fCov[k * kDim + l];
+            for (Int_t m = 0; m < l; ++m) {
+                sum -= fChol[k * kDim + m] * fChol[l * kDim + m];
+            }
+            if (k == l) {
+                fChol[k * kDim + k] = sum > 0.0 ? std::sqrt(sum) : 0.0;
+            } else {
+                fChol[k * kDim + l] = fChol[l * kDim + l] > 0.0 ? sum / fChol[l * kDim + l] : 0.0;
+            }
+        }
+    }
+    return n;
+}
+
+Double_t TBeamPhaseSpace::GetSigma(Int_t k) const {
+    return std::sqrt(fCov[k * kDim + k]);
+}
+
+void TBeamPhaseSpace::Smear(const Float_t *point, const Double_t *z, Double_t *out) const {
+    for (Int_t k = 0; k < kDim; ++k) {
+        Double_t val = point[k];
+        for (Int_t l = 0; l <= k; ++l) {
+            val += fChol[k * kDim + l] * z[l];
+        }
+        out[k] = val;
+    }
+}
+
+void TBeamPhaseSpace::Sample(Double_t *out) const {
+    const Int_t n = GetN();
+    if (n == 0) {
+        std::fill(out, out + kDim, 0.0);
+        return;
+    }
+    const Float_t *point = &fPoints[static_cast<std::size_t>(gRandom->Integer(n)) * kDim];
+    Double_t z[kDim];
+    for (Int_t k = 0; k < kDim; ++k) {
+        z[k] = gRandom->Gaus();
+    }
+    Smear(point, z, out);
+}
+
+/**
+ * @details
+ * The uniform numbers of all the samples are generated at once (RndmArray),
+ * 5 for each sample: one for the point and four for the Gaussians (Box-Muller).
+ */
+void TBeamPhaseSpace::Sample(Int_t n, Double_t *out) const {
+    const Int_t nPoints = GetN();
+    if (nPoints == 0) {
+        std::fill(out, out + n * kDim, 0.0);
+        return;
+    }
+    constexpr Int_t kRndm = kDim + 1;
+    fRndm.resize(static_cast<std::size_t>(n) * kRndm);
+    gRandom->RndmArray(n * kRndm, fRndm.data());
+
+    Double_t z[kDim];
+    for (Int_t i = 0; i < n; ++i) {
+        const Double_t *u = &fRndm[static_cast<std::size_t>(i) * kRndm];
+        const Int_t index = std::min(static_cast<Int_t>(u[0] * nPoints), nPoints - 1);
+        for (Int_t k = 0; k < kDim; k += 2) {
+            // RndmArray does not return 0
+            const Double_t r = std::sqrt(-2.0 * std::log(u[k + 1]));
+            const Double_t phi = TMath::TwoPi() * u[k + 2];
+            z[k] = r * std::cos(phi);
+            z[k + 1] = r * std::sin(phi);
+        }
+        Smear(&fPoints[static_cast<std::size_t>(index) * kDim], z, out + i * kDim);
+    }
+}
+
+} // namespace art::crib
@@ -0,0 +1,79 @@
+/**
+ * @file    TBeamPhaseSpace.h
+ * @brief   Kernel density model of the measured beam phase space (X, Y, A, B)
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 17:52:30
+ * @note    last modified: 2026-10-18 17:52:30
+ * @details
+ */
+
+#ifndef CRIB_TBEAMPHASESPACE_H_
+#define CRIB_TBEAMPHASESPACE_H_
+
+#include <TNamed.h>
+
+#include <vector>
+
+class TTree;
+
+namespace art::crib {
+/**
+ * @class TBeamPhaseSpace
+ * @brief Samples (X, Y, A, B) of the beam from a model made of measured tracks.
+ *
+ * The model is a Gaussian kernel density estimate: a sample point (track) is
+ * chosen uniformly and smeared with a 4D Gaussian whose covariance is
+ * bandwidth^2 x (covariance of the tracks). The kernel keeps the X-A and Y-B
+ * correlations, and the points keep the real (non-Gaussian) shape of the beam.
+ * The bandwidth is Silverman's rule, d = 4: (4 / (d + 2))^(1 / (d + 4)) n^(-1 / (d + 4)),
+ * multiplied by a scale factor; 0 means resampling of the points.
+ *
+ * The object is small (4 floats per point) and can be saved in a ROOT file.
+ * X, Y in mm, A, B in rad (same as art::TTrack).
+ */
+class TBeamPhaseSpace : public TNamed {
+  public:
+    static constexpr Int_t kDim = 4; ///< (X, Y, A, B)
+
+    TBeamPhaseSpace() = default;
+    TBeamPhaseSpace(const char *name, const char *title) : TNamed(name, title) {}
+    ~TBeamPhaseSpace() override = default;
+
+    /**
+     * @brief Builds the model from a TClonesArray of art::TTrack in the tree.
+     * @param (tree) tree of the tracks
+     * @param (branch) name of the TClonesArray branch, events with one track are used
+     * @param (maxPoints) max number of the points kept (subsampled uniformly if more)
+     * @param (bandwidthScale) scale of Silverman's bandwidth, 0: no smearing
+     * @return number of the points (0 if failed)
+     */
+    Int_t Build(TTree *tree, const char *branch, Int_t maxPoints = 100000, Double_t bandwidthScale = 1.0);
+
+    /// @brief builds the model from the points (x[4 * i + k], k = X, Y, A, B)
+    Int_t Build(const std::vector<Double_t> &points, Double_t bandwidthScale = 1.0);
+
+    Int_t GetN() const { return fPoints.size() / kDim; }
+    Double_t GetMean(Int_t k) const { return fMean[k]; }
+    Double_t GetSigma(Int_t k) const;
+    Double_t GetBandwidth() const { return fBandwidth; }
+
+    /// @brief one sample with gRandom, out[4] = (X, Y, A, B)
+    void Sample(Double_t *out) const;
+    /// @brief n samples with gRandom, out[4 * i + k]
+    void Sample(Int_t n, Double_t *out) const;
+
+  private:
+    std::vector<Float_t> fPoints;        ///< sample points, fPoints[4 * i + k]
+    Double_t fMean[kDim]{};              ///< mean of the points
+    Double_t fCov[kDim * kDim]{};        ///< covariance of the points
+    Double_t fChol[kDim * kDim]{};       ///< lower Cholesky factor of the kernel covariance
+    Double_t fBandwidth{0.};             ///< bandwidth (relative to the covariance)
+    mutable std::vector<Double_t> fRndm; //! buffer of the batch sampling
+
+    void Smear(const Float_t *point, const Double_t *z, Double_t *out) const;
+
+    ClassDefOverride(TBeamPhaseSpace, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TBEAMPHASESPACE_H_
@@ -3,12 +3,13 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-18 14:36:43
- * @note    last modified: 2024-09-18 15:57:31
+ * @note    last modified: 2026-10-18 21:43:19
  * @details
  */
 
 #include "TDetectParticleProcessor.h"
 
+#include "../TProcessorUtil.h"
 #include "../geo/TDetectorParameter.h"
 #include "../geo/TTargetParameter.h"
 #include "../telescope/TTelescopeData.h"
@@ -36,6 +37,19 @@ TDetectParticleProcessor::TDetectParticleProcessor()
     RegisterProcessorParameter("EnergyResolution", "energy resolution MeV unit", fEResolution, init_d_vec);
     RegisterProcessorParameter("TimingResolution", "timing resolution ns unit", fTResolution, init_d_vec);
 
+    RegisterOptionalParameter("HitMode",
+                              "0: analytic ray-box intersection, 1: TGeo navigation, 2: analytic with TGeo cross-check",
+                              fHitMode, 0);
+    RegisterOptionalParameter("ResponseMode", "0: energy deposit from the response tables, 1: exact (TSrim)",
+                              fResponseMode, 0);
+    RegisterOptionalParameter("ResponseMaxEnergy", "upper energy of the response tables (MeV)",
+                              fResponseMaxEnergy, 100.0);
+    RegisterOptionalParameter("ResponseMinCos", "lower cos(incident angle) of the response tables",
+                              fResponseMinCos, 0.5);
+    IntVec_t init_size{500, 20, 200};
+    RegisterOptionalParameter("ResponseTableSize", "number of bins of the response tables (energy, cos, gas distance)",
+                              fResponseTableSize, init_size);
+
     RegisterOptionalInputInfo("DetectorParameter", "name of telescope parameter", fDetectorParameterName,
                               TString("prm_detectors"), &fDetectorPrm, "TClonesArray", "art::crib::TDetectorParameter");
     /// currently not use this object
@@ -51,8 +65,12 @@ TDetectParticleProcessor::~TDetectParticleProcessor() {
 }
 
 void TDetectParticleProcessor::Init(TEventCollection *col) {
+    if (fHitMode < kAnalytic || fHitMode > kCrossCheck) {
+        SetStateError(Form("HitMode should be 0, 1 or 2, but %d", fHitMode));
+        return;
+    }
     fInGeom = reinterpret_cast<TGeoManager **>(col->GetObjectRef("geom"));
-    if (!fInGeom) {
+    if (!fInGeom && fHitMode != kAnalytic) {
         SetStateError("gate array not found. Run TUserGeoInitializer before this.");
         return;
     }
@@ -69,16 +87,12 @@ void TDetectParticleProcessor::Init(TEventCollection *col) {
         SetStateError("contents of input array must inherit from art::crib::TParticleInfo");
         return;
     }
-    fInTrackData = reinterpret_cast<TClonesArray **>(col->GetObjectRef(fInputTrackColName.Data()));
-    if (!fInTrackData) {
-        SetStateError(Form("input not found: %s", fInputTrackColName.Data()));
-        return;
-    }
-    const TClass *const cl2 = (*fInTrackData)->GetClass();
-    if (!cl2->InheritsFrom(art::TTrack::Class())) {
-        SetStateError("contents of input array must inherit from art::TTrack");
+    auto result = util::GetInputObject<TClonesArray>(col, fInputTrackColName, "TClonesArray", "art::TTrack");
+    if (std::holds_alternative<TString>(result)) {
+        SetStateError(std::get<TString>(result));
         return;
     }
+    fInTrackData = std::get<TClonesArray **>(result);
 
     if (!fDetectorPrm) {
         SetStateError(Form("not found detector parameter object %s", fDetectorParameterName.Data()));
@@ -87,6 +101,18 @@ void TDetectParticleProcessor::Init(TEventCollection *col) {
     auto det_num = (*fDetectorPrm)->GetEntriesFast();
     Info("Init", "set %d number of detectors", det_num);
 
+    fHitFinder.Clear();
+    for (auto i = 0; i < det_num; i++) {
+        fHitFinder.AddDetector(dynamic_cast<TDetectorParameter *>((*fDetectorPrm)->At(i)));
+    }
+    fNumCrossCheck = 0;
+    fNumMismatch = 0;
+    const char *mode_name[] = {"analytic", "TGeo", "analytic with TGeo cross-check"};
+    Info("Init", "hit mode: %s", mode_name[fHitMode]);
+    if (fHitMode == kCrossCheck) {
+        Info("Init", "TGeo cross-check of the detector cross sections: %d mismatches", CheckShapes());
+    }
+
     // currently not used
     // if (!fTargetPrm) {
     //     SetStateError(Form("not found target parameter object %s", fTargetParameterName.Data()));
@@ -137,23 +163,39 @@ void TDetectParticleProcessor::Init(TEventCollection *col) {
     Info("Init", "\t\"%s\" list loaded.", fTargetName.Data());
 
     StringVec_t material_names;
+    fMaterialNames.assign(det_num, std::vector<std::string>());
+    fMaxDistance = 0.0;
     for (auto i = 0; i < det_num; i++) {
         auto detprm = dynamic_cast<TDetectorParameter *>((*fDetectorPrm)->At(i));
         for (auto j = 0; j < detprm->GetN(); j++) {
             material_names.emplace_back(detprm->GetMaterial(j));
+            fMaterialNames[i].emplace_back(detprm->GetMaterial(j).Data());
         }
+        fMaxDistance = std::max(fMaxDistance, detprm->GetMaxRadius());
     }
+    fTargetNameStr = fTargetName.Data();
     StringVec_t unique_names = GetUniqueElements(material_names);
     for (const auto &str : unique_names) {
         srim->AddElement("srim", 16, Form("%s/%s/range_fit_pol16_%s.txt", tsrim_path, str.Data(), str.Data()));
     }
 
+    if (fResponseMode != 0 && fResponseMode != 1) {
+        SetStateError(Form("ResponseMode should be 0 or 1, but %d", fResponseMode));
+        return;
+    }
+    if (fResponseTableSize.size() != 3) {
+        SetStateError("ResponseTableSize should be [energy bins, cos bins, distance bins]");
+        return;
+    }
+    fLayerTables.clear();
+    fGasTables.clear();
+    Info("Init", "energy deposit: %s", fResponseMode == 0 ? "response table" : "exact");
+
     gRandom->SetSeed(time(nullptr));
 }
 
 void TDetectParticleProcessor::Process() {
     fOutData->Clear("C");
-    TGeoManager *geom = static_cast<TGeoManager *>(*fInGeom);
 
     for (Int_t iData = 0; iData < (*fInData)->GetEntriesFast(); ++iData) {
         const TDataObject *const inData = static_cast<TDataObject *>((*fInData)->At(iData));
@@ -173,52 +215,58 @@ void TDetectParticleProcessor::Process() {
         TVector3 velocity = (Data->GetLorentzVector()).Vect().Unit();
 
         // check if beam particle hits the detector
-        geom->SetCurrentPoint(first_position.X(), first_position.Y(), first_position.Z());
-        geom->SetCurrentDirection(velocity.X(), velocity.Y(), velocity.Z());
-
-        // exclude TOP boundary
-        geom->GetCurrentNode();
-        geom->FindNode();
-
-        // geom->FindNextBoundary(10000.0); // need to set some values??
-        geom->FindNextBoundary();
-        Double_t distance = geom->GetStep();
-        geom->Step();
-        Bool_t isHit = geom->IsStepEntering();
-        if (!isHit) {
-            continue;
+        Int_t det_id = -1;
+        Double_t distance = 0.0;
+        if (fHitMode != kTGeo) {
+            const Double_t pos[3] = {first_position.X(), first_position.Y(), first_position.Z()};
+            const Double_t dir[3] = {velocity.X(), velocity.Y(), velocity.Z()};
+            TDetectorHitFinder::Hit hit;
+            if (fHitFinder.FindHit(pos, dir, hit)) {
+                det_id = hit.fDetID;
+                distance = hit.fDistance;
+            }
         }
-
-        TString hitname = geom->GetPath(); // ex. hitname = /TOP_1/tel1_0, /TOP_1/tel4_3
-        auto index_hitpath = hitname.Last('_');
-        TString det_id = hitname(index_hitpath + 1, hitname.Length()); // get last number /TOP_1/tel1_0 -> 0
-        if (hitname.Length() < 8 || det_id.Atoi() >= (*fDetectorPrm)->GetEntriesFast()) {
-            // /TOP_1/ -> length = 7
+        if (fHitMode != kAnalytic) {
+            Double_t geo_distance = 0.0;
+            const Int_t geo_id = FindHitTGeo(first_position, velocity, geo_distance);
+            if (fHitMode == kTGeo) {
+                det_id = geo_id;
+                distance = geo_distance;
+            } else {
+                fNumCrossCheck++;
+                if (geo_id != det_id || (det_id >= 0 && TMath::Abs(geo_distance - distance) > 1.0e-3)) {
+                    fNumMismatch++;
+                }
+            }
+        }
+        if (det_id < 0) {
             continue;
         }
 
+        const Int_t z = Data->GetAtomicNumber();
+        const Int_t a = Data->GetMassNumber();
         if (fTargetIsGas) {
-            energy = srim->EnergyNew(Data->GetAtomicNumber(), Data->GetMassNumber(), energy,
-                                     std::string(fTargetName.Data()), distance, fTargetPressure, 300.0);
+            energy = GetGasEnergy(z, a, energy, distance);
             if (energy < 0.01) {
                 continue; // stop in the target
             }
         }
 
-        outData->SetTelID(det_id.Atoi() + 1); /// 1 start (not 0)
+        outData->SetTelID(det_id + 1); /// 1 start (not 0)
         TVector3 det_position(distance * velocity.X(), distance * velocity.Y(), distance * velocity.Z());
         det_position += first_position;
         outData->SetPosition(det_position);
 
-        TParameterObject *inPrm = static_cast<TParameterObject *>((*fDetectorPrm)->At(det_id.Atoi()));
+        TParameterObject *inPrm = static_cast<TParameterObject *>((*fDetectorPrm)->At(det_id));
         TDetectorParameter *Prm = dynamic_cast<TDetectorParameter *>(inPrm);
         outData->SetN(Prm->GetN());
 
-        det_position -= TVector3(Prm->GetCenterRotPos(0), Prm->GetCenterRotPos(1), Prm->GetCenterRotPos(2));
-        det_position.RotateY(-Prm->GetAngle());
+        const Double_t hit_pos[3] = {det_position.X(), det_position.Y(), det_position.Z()};
+        Double_t local_x = 0.0, local_y = 0.0;
+        fHitFinder.GetLocalPosition(det_id, hit_pos, local_x, local_y);
 
-        outData->SetXID(GetStripID(det_position.X(), Prm->GetStripNum(0), Prm->GetSize(0)));
-        outData->SetYID(GetStripID(det_position.Y(), Prm->GetStripNum(1), Prm->GetSize(1)));
+        outData->SetXID(TDetectorHitFinder::GetStripID(local_x, Prm->GetStripNum(0), Prm->GetSize(0)));
+        outData->SetYID(TDetectorHitFinder::GetStripID(local_y, Prm->GetStripNum(1), Prm->GetSize(1)));
         if (outData->GetXID() == -1 || outData->GetYID() == -1) {
             continue; /// hit from side, so not caliculate energy
         }
@@ -227,22 +275,19 @@ void TDetectParticleProcessor::Process() {
         Double_t ion_mass = amdc::Mass(Data->GetAtomicNumber(), Data->GetMassNumber()) * amdc::amu;                // MeV
         Double_t duration = distance / (TMath::Sqrt(1.0 - TMath::Power(ion_mass / (ion_mass + energy), 2.0)) * c); // ns
         duration += Data->GetDurationTime();
-        outData->PushTimingArray(gRandom->Gaus(duration, fTResolution[det_id.Atoi()]));
+        outData->PushTimingArray(gRandom->Gaus(duration, fTResolution[det_id]));
 
         // caliculate energy
+        const Double_t dir[3] = {velocity.X(), velocity.Y(), velocity.Z()};
+        const Double_t cos_inc = fHitFinder.GetCosIncidence(det_id, dir);
+        fDeposits.resize(Prm->GetN() + 1);
+        GetLayerResponse(z, a, det_id, energy, cos_inc, fDeposits.data());
         Double_t energy_total = 0.0;
         for (auto iMat = 0; iMat < Prm->GetN(); iMat++) {
-            if (energy > 0.01) {
-                Double_t new_energy = srim->EnergyNew(Data->GetAtomicNumber(), Data->GetMassNumber(), energy,
-                                                      std::string((Prm->GetMaterial(iMat)).Data()), Prm->GetThickness(iMat));
-                energy_total += energy - new_energy;
-                outData->PushEnergyArray(energy - new_energy);
-                energy = new_energy;
-            } else {
-                outData->PushEnergyArray(0.0);
-            }
+            energy_total += fDeposits[iMat];
+            outData->PushEnergyArray(fDeposits[iMat]);
         }
-        outData->SetEtotal(gRandom->Gaus(energy_total, fEResolution[det_id.Atoi()]));
+        outData->SetEtotal(gRandom->Gaus(energy_total, fEResolution[det_id]));
 
         // caliculate LAB angle
         const TDataObject *const inTrackData = static_cast<TDataObject *>((*fInTrackData)->At(0));
@@ -267,18 +312,160 @@ std::vector<TString> TDetectParticleProcessor::GetUniqueElements(const std::vect
     return result;
 }
 
-Int_t TDetectParticleProcessor::GetStripID(Double_t pos, Int_t max_strip, Double_t size) {
-    Int_t result = -1;
-    for (Int_t i = 0; i < max_strip; i++) {
-        if (size * ((Double_t)i / max_strip - 0.5) < pos && pos < size * ((Double_t)(i + 1) / max_strip - 0.5)) {
-            result = i;
-            break;
+/**
+ * @details
+ * Energy loss in the layers of the detector, the effective thickness is thickness / cos_inc.
+ * `out` has N + 1 elements: deposit of each layer and the residual energy.
+ */
+void TDetectParticleProcessor::CalcLayerResponse(Int_t z, Int_t a, Int_t det_id, Double_t energy, Double_t cos_inc,
+                                                 Double_t *out) {
+    const auto *const prm = static_cast<const TDetectorParameter *>((*fDetectorPrm)->At(det_id));
+    const Int_t n = prm->GetN();
+    for (auto iMat = 0; iMat < n; iMat++) {
+        if (energy > 0.01) {
+            Double_t new_energy = srim->EnergyNew(z, a, energy, fMaterialNames[det_id][iMat],
+                                                  prm->GetThickness(iMat) / cos_inc);
+            out[iMat] = energy - new_energy;
+            energy = new_energy;
+        } else {
+            out[iMat] = 0.0;
         }
     }
-    // if(result == -1) std::cout << "warning, stripID is incorrect" << std::endl;
+    out[n] = energy;
+}
+
+/**
+ * @details
+ * The table of (Z, A, detector) is made when the particle first hits the detector.
+ * Outside of the table, the exact calculation is used.
+ */
+void TDetectParticleProcessor::GetLayerResponse(Int_t z, Int_t a, Int_t det_id, Double_t energy, Double_t cos_inc,
+                                                Double_t *out) {
+    if (fResponseMode == 1) {
+        CalcLayerResponse(z, a, det_id, energy, cos_inc, out);
+        return;
+    }
+    TResponseTable &table = fLayerTables[std::make_tuple(z, a, det_id)];
+    if (!table.IsBuilt()) {
+        const Int_t n = static_cast<const TDetectorParameter *>((*fDetectorPrm)->At(det_id))->GetN();
+        table.Build(n + 1, 0.0, fResponseMaxEnergy, fResponseTableSize[0], fResponseMinCos, 1.0,
+                    fResponseTableSize[1],
+                    [&](Double_t e, Double_t cs, Double_t *res) { CalcLayerResponse(z, a, det_id, e, cs, res); });
+        Info("Process", "response table of (Z, A) = (%d, %d) for detector %d is prepared", z, a, det_id);
+    }
+    if (!table.Eval(energy, cos_inc, out)) {
+        CalcLayerResponse(z, a, det_id, energy, cos_inc, out);
+    }
+}
+
+Double_t TDetectParticleProcessor::GetGasEnergy(Int_t z, Int_t a, Double_t energy, Double_t distance) {
+    auto exact = [&](Double_t e, Double_t d) {
+        return srim->EnergyNew(z, a, e, fTargetNameStr, d, fTargetPressure, 300.0);
+    };
+    if (fResponseMode == 1) {
+        return exact(energy, distance);
+    }
+    TResponseTable &table = fGasTables[std::make_pair(z, a)];
+    if (!table.IsBuilt()) {
+        table.Build(1, 0.0, fResponseMaxEnergy, fResponseTableSize[0], 0.0, fMaxDistance, fResponseTableSize[2],
+                    [&](Double_t e, Double_t d, Double_t *res) { res[0] = e > 0.0 ? exact(e, d) : 0.0; });
+        Info("Process", "gas target table of (Z, A) = (%d, %d) is prepared", z, a);
+    }
+    Double_t result = 0.0;
+    if (!table.Eval(energy, distance, &result)) {
+        return exact(energy, distance);
+    }
     return result;
 }
 
+/**
+ * @details
+ * TGeo navigation from `pos` along `dir` (validation of the analytic intersection).
+ * The detector index is taken from the node name, ex. /TOP_1/tel1_0 -> 0.
+ * @return detector index, or -1 if no detector is entered
+ */
+Int_t TDetectParticleProcessor::FindHitTGeo(const TVector3 &pos, const TVector3 &dir, Double_t &distance) {
+    TGeoManager *geom = static_cast<TGeoManager *>(*fInGeom);
+    geom->SetCurrentPoint(pos.X(), pos.Y(), pos.Z());
+    geom->SetCurrentDirection(dir.X(), dir.Y(), dir.Z());
+
+    // exclude TOP boundary
+    geom->GetCurrentNode();
+    geom->FindNode();
+
+    // geom->FindNextBoundary(10000.0); // need to set some values??
+    geom->FindNextBoundary();
+    distance = geom->GetStep();
+    geom->Step();
+    Bool_t isHit = geom->IsStepEntering();
+    if (!isHit) {
+        return -1;
+    }
+
+    TString hitname = geom->GetPath(); // ex. hitname = /TOP_1/tel1_0, /TOP_1/tel4_3
+    auto index_hitpath = hitname.Last('_');
+    TString det_id = hitname(index_hitpath + 1, hitname.Length()); // get last number /TOP_1/tel1_0 -> 0
+    if (hitname.Length() < 8 || det_id.Atoi() >= (*fDetectorPrm)->GetEntriesFast()) {
+        // /TOP_1/ -> length = 7
+        return -1;
+    }
+    return det_id.Atoi();
+}
+
+/**
+ * @details
+ * Rays along the normal of each tube or trapezoid detector are sent to a grid of points
+ * of its bounding box, and the analytic hit is compared with the TGeo navigation,
+ * so that a cross section in the wrong orientation (e.g. an asymmetric trapezoid)
+ * is found before the loop.
+ * @return number of the rays which hit different detectors
+ */
+Int_t TDetectParticleProcessor::CheckShapes() {
+    constexpr Int_t ngrid = 21;
+    Int_t nmismatch = 0;
+    for (Int_t id = 0; id < fHitFinder.GetN(); id++) {
+        const auto *prm = static_cast<TDetectorParameter *>((*fDetectorPrm)->At(id));
+        if (prm->GetShape() == TDetectorParameter::kBox) {
+            continue;
+        }
+        // corner 0 is (-u, -v, -n), and the bits 0, 1 and 2 flip u, v and n
+        Double_t corners[8][3];
+        fHitFinder.GetCorners(id, corners);
+        const TVector3 origin(corners[0]);
+        const TVector3 edge_u = TVector3(corners[1]) - origin;
+        const TVector3 edge_v = TVector3(corners[2]) - origin;
+        const TVector3 edge_n = TVector3(corners[4]) - origin;
+        const TVector3 dir = edge_n.Unit();
+
+        Int_t nbad = 0;
+        for (Int_t iu = 0; iu < ngrid; iu++) {
+            for (Int_t iv = 0; iv < ngrid; iv++) {
+                // start one thickness in front of the front face
+                const TVector3 pos = origin + ((iu + 0.5) / ngrid) * edge_u + ((iv + 0.5) / ngrid) * edge_v - edge_n;
+                const Double_t p[3] = {pos.X(), pos.Y(), pos.Z()};
+                const Double_t d[3] = {dir.X(), dir.Y(), dir.Z()};
+                TDetectorHitFinder::Hit hit;
+                const Int_t ana_id = fHitFinder.FindHit(p, d, hit) ? hit.fDetID : -1;
+                Double_t geo_distance = 0.0;
+                if (FindHitTGeo(pos, dir, geo_distance) != ana_id) {
+                    nbad++;
+                }
+            }
+        }
+        if (nbad > 0) {
+            Warning("Init", "detector %d: %d of %d rays differ between analytic and TGeo", id, nbad, ngrid * ngrid);
+        }
+        nmismatch += nbad;
+    }
+    return nmismatch;
+}
+
+void TDetectParticleProcessor::PostLoop() {
+    if (fHitMode == kCrossCheck) {
+        Info("PostLoop", "TGeo cross-check: %ld mismatches in %ld tracks", fNumMismatch, fNumCrossCheck);
+    }
+}
+
 // ===========================================
 // kinematics
 // tof
@@ -3,17 +3,22 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 22:34:15
- * @note    last modified: 2025-01-08 10:34:55
+ * @note    last modified: 2026-10-18 21:43:19
  * @details
  */
 
 #ifndef _CRIB_TDETECTPARTICLEPROCESSOR_H_
 #define _CRIB_TDETECTPARTICLEPROCESSOR_H_
 
+#include "TDetectorHitFinder.h"
+#include "TResponseTable.h"
 #include <TGeoManager.h>
 #include <TProcessor.h>
 #include <TSrim.h> // TSrim library
 
+#include <map>
+#include <tuple>
+
 namespace art::crib {
 class TDetectParticleProcessor;
 } // namespace art::crib
@@ -27,6 +32,12 @@ class art::crib::TDetectParticleProcessor : public TProcessor {
 
     void Init(TEventCollection *col) override;
     void Process() override;
+    void PostLoop() override;
+
+    /// @brief detector hit engine (HitMode)
+    enum EHitMode { kAnalytic = 0,
+                    kTGeo = 1,
+                    kCrossCheck = 2 };
 
   protected:
     TString fInputColName;
@@ -51,11 +62,36 @@ class art::crib::TDetectParticleProcessor : public TProcessor {
 
     TSrim *srim;
 
+    Int_t fHitMode;
+    TDetectorHitFinder fHitFinder; //!
+    Long_t fNumCrossCheck;         //!
+    Long_t fNumMismatch;           //!
+
+    /// @brief energy deposit, 0: response tables, 1: exact
+    Int_t fResponseMode;
+    Double_t fResponseMaxEnergy;
+    Double_t fResponseMinCos;
+    IntVec_t fResponseTableSize;
+    /// (Z, A, detector id) -> (energy, cos) -> (deposits, residual energy)
+    std::map<std::tuple<Int_t, Int_t, Int_t>, TResponseTable> fLayerTables; //!
+    /// (Z, A) -> (energy, distance) -> residual energy in the gas target
+    std::map<std::pair<Int_t, Int_t>, TResponseTable> fGasTables; //!
+    std::vector<std::vector<std::string>> fMaterialNames;        //! [detector id][layer]
+    std::string fTargetNameStr;                                   //!
+    Double_t fMaxDistance = 0.0;                                  //! upper distance of the gas tables
+    DoubleVec_t fDeposits;                                        //!
+
     const Double_t c = 299.792458; // mm/ns
 
   private:
     std::vector<TString> GetUniqueElements(const std::vector<TString> &input);
-    Int_t GetStripID(Double_t pos, Int_t max_strip, Double_t size);
+    Int_t FindHitTGeo(const TVector3 &pos, const TVector3 &dir, Double_t &distance);
+    /// @brief compares the analytic and TGeo hits on the tube and trapezoid detectors
+    Int_t CheckShapes();
+
+    void CalcLayerResponse(Int_t z, Int_t a, Int_t det_id, Double_t energy, Double_t cos_inc, Double_t *out);
+    void GetLayerResponse(Int_t z, Int_t a, Int_t det_id, Double_t energy, Double_t cos_inc, Double_t *out);
+    Double_t GetGasEnergy(Int_t z, Int_t a, Double_t energy, Double_t distance);
 
     TDetectParticleProcessor(const TDetectParticleProcessor &rhs) = delete;
     TDetectParticleProcessor &operator=(const TDetectParticleProcessor &rhs) = delete;
@@ -0,0 +1,149 @@
+/**
+ * @file    TDetectorHitFinder.cc
+ * @brief   Analytic ray-box intersection with the detectors of TUserGeoInitializer
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 15:10:22
+ * @note    last modified: 2026-10-18 21:43:19
+ * @details
+ */
+
+#include "TDetectorHitFinder.h"
+
+#include "../geo/TDetectorParameter.h"
+#include <TMath.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace art::crib {
+
+void TDetectorHitFinder::Clear() {
+    for (auto *vec : {&fCx, &fCy, &fCz, &fCos, &fSin, &fHalfU, &fHalfV, &fHalfN, &fRx, &fRy, &fRz, &fShapeA,
+                      &fShapeB}) {
+        vec->clear();
+    }
+    fShape.clear();
+}
+
+void TDetectorHitFinder::AddDetector(const TDetectorParameter *prm) {
+    const Double_t angle = prm->GetAngle();
+    const Double_t cs = TMath::Cos(angle);
+    const Double_t sn = TMath::Sin(angle);
+
+    // same as TVector3::RotateY(angle) in TUserGeoInitializer
+    const Double_t x = prm->GetOffset(0);
+    const Double_t y = prm->GetOffset(1);
+    const Double_t z = prm->GetDistance() + prm->GetOffset(2);
+    fCx.emplace_back(cs * x + sn * z + prm->GetCenterRotPos(0));
+    fCy.emplace_back(y + prm->GetCenterRotPos(1));
+    fCz.emplace_back(-sn * x + cs * z + prm->GetCenterRotPos(2));
+    fCos.emplace_back(cs);
+    fSin.emplace_back(sn);
+
+    // TGeoRotation(90, angle, 0): local x -> y, local y -> -(in-plane axis), local z -> normal
+    fHalfU.emplace_back(prm->GetSize(1) / 2.0);
+    fHalfV.emplace_back(prm->GetSize(0) / 2.0);
+    fHalfN.emplace_back(prm->GetSize(2) / 2.0);
+
+    fRx.emplace_back(prm->GetCenterRotPos(0));
+    fRy.emplace_back(prm->GetCenterRotPos(1));
+    fRz.emplace_back(prm->GetCenterRotPos(2));
+
+    // size is the bounding box, the cross section is in the shape parameter
+    const Int_t shape = prm->GetShape();
+    fShape.emplace_back(shape);
+    if (shape == TDetectorParameter::kTube) {
+        fShapeA.emplace_back(prm->GetShapeParameter(0) * prm->GetShapeParameter(0));
+        fShapeB.emplace_back(prm->GetShapeParameter(1) * prm->GetShapeParameter(1));
+    } else if (shape == TDetectorParameter::kTrapezoid) {
+        fShapeA.emplace_back(prm->GetShapeParameter(0) / 2.0);
+        fShapeB.emplace_back(prm->GetShapeParameter(1) / 2.0);
+    } else {
+        fShapeA.emplace_back(0.0);
+        fShapeB.emplace_back(0.0);
+    }
+}
+
+Bool_t TDetectorHitFinder::IsInside(Int_t id, Double_t u, Double_t v) const {
+    switch (fShape[id]) {
+    case TDetectorParameter::kTube: {
+        const Double_t r2 = u * u + v * v;
+        return r2 >= fShapeA[id] && r2 <= fShapeB[id];
+    }
+    case TDetectorParameter::kTrapezoid: {
+        // TGeoTrap local y is along -u, local x is along v (y axis),
+        // so the bottom width (local y = -h) is at u = +fHalfU
+        const Double_t t = 0.5 * (1.0 - u / fHalfU[id]);
+        const Double_t half_width = fShapeA[id] + t * (fShapeB[id] - fShapeA[id]);
+        return TMath::Abs(v) <= half_width;
+    }
+    default:
+        return kTRUE;
+    }
+}
+
+Bool_t TDetectorHitFinder::FindHit(const Double_t *pos, const Double_t *dir, Hit &hit) const {
+    constexpr Double_t kInf = std::numeric_limits<Double_t>::infinity();
+    // 1/0 gives inf, so the slab test also works for the ray parallel to a face
+    const Double_t inv_dy = 1.0 / dir[1];
+
+    const Int_t n = GetN();
+    Double_t best = kInf;
+    Int_t best_id = -1;
+    for (Int_t i = 0; i < n; i++) {
+        const Double_t ox = pos[0] - fCx[i];
+        const Double_t oy = pos[1] - fCy[i];
+        const Double_t oz = pos[2] - fCz[i];
+
+        const Double_t ou = ox * fCos[i] - oz * fSin[i];
+        const Double_t du = dir[0] * fCos[i] - dir[2] * fSin[i];
+        const Double_t on = ox * fSin[i] + oz * fCos[i];
+        const Double_t dn = dir[0] * fSin[i] + dir[2] * fCos[i];
+
+        const Double_t inv_du = 1.0 / du;
+        const Double_t inv_dn = 1.0 / dn;
+        const Double_t tu1 = (-fHalfU[i] - ou) * inv_du, tu2 = (fHalfU[i] - ou) * inv_du;
+        const Double_t tv1 = (-fHalfV[i] - oy) * inv_dy, tv2 = (fHalfV[i] - oy) * inv_dy;
+        const Double_t tn1 = (-fHalfN[i] - on) * inv_dn, tn2 = (fHalfN[i] - on) * inv_dn;
+
+        const Double_t t_near = std::max({std::min(tu1, tu2), std::min(tv1, tv2), std::min(tn1, tn2)});
+        const Double_t t_far = std::min({std::max(tu1, tu2), std::max(tv1, tv2), std::max(tn1, tn2)});
+
+        // entering from outside of the box
+        Bool_t is_hit = t_near > 0.0 && t_near <= t_far && t_near < best;
+        if (is_hit && fShape[i] != TDetectorParameter::kBox) {
+            is_hit = IsInside(i, ou + t_near * du, oy + t_near * dir[1]);
+        }
+        best = is_hit ? t_near : best;
+        best_id = is_hit ? i : best_id;
+    }
+    if (best_id < 0)
+        return kFALSE;
+
+    hit.fDetID = best_id;
+    hit.fDistance = best;
+    for (Int_t k = 0; k < 3; k++) {
+        hit.fPos[k] = pos[k] + best * dir[k];
+    }
+    GetLocalPosition(best_id, hit.fPos, hit.fLocalX, hit.fLocalY);
+    return kTRUE;
+}
+
+void TDetectorHitFinder::GetCorners(Int_t id, Double_t corners[8][3]) const {
+    for (Int_t k = 0; k < 8; k++) {
+        const Double_t su = (k & 1) ? fHalfU[id] : -fHalfU[id];
+        const Double_t sv = (k & 2) ? fHalfV[id] : -fHalfV[id];
+        const Double_t sn = (k & 4) ? fHalfN[id] : -fHalfN[id];
+        corners[k][0] = fCx[id] + su * fCos[id] + sn * fSin[id];
+        corners[k][1] = fCy[id] + sv;
+        corners[k][2] = fCz[id] - su * fSin[id] + sn * fCos[id];
+    }
+}
+
+void TDetectorHitFinder::GetLocalPosition(Int_t id, const Double_t *pos, Double_t &x, Double_t &y) const {
+    // same as TVector3::RotateY(-angle) of (pos - center_rotation)
+    x = (pos[0] - fRx[id]) * fCos[id] - (pos[2] - fRz[id]) * fSin[id];
+    y = pos[1] - fRy[id];
+}
+
+} // namespace art::crib
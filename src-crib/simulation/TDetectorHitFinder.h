@@ -0,0 +1,105 @@
+/**
+ * @file    TDetectorHitFinder.h
+ * @brief   Analytic ray-box intersection with the detectors of TUserGeoInitializer
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 15:10:22
+ * @note    last modified: 2026-10-18 21:43:19
+ * @details
+ */
+
+#ifndef CRIB_TDETECTORHITFINDER_H_
+#define CRIB_TDETECTORHITFINDER_H_
+
+#include <Rtypes.h>
+
+#include <vector>
+
+namespace art::crib {
+class TDetectorParameter;
+
+/**
+ * @class TDetectorHitFinder
+ * @brief Finds the detector box that a straight track enters first.
+ *
+ * The boxes are placed in the same way as TUserGeoInitializer does for TGeo:
+ * the center is (offset.x, offset.y, distance + offset.z) rotated by `angle` around
+ * the y axis about the center_rotation point, and the box is rotated by
+ * TGeoRotation(90, angle, 0), so that the box x size is along the y axis.
+ * The center, axes and half sizes are stored as arrays so that
+ * all detectors are tested in a single loop (slab method).
+ *
+ * Tube and trapezoid detectors are tested with their bounding box, and the entry point
+ * is then checked against the cross section (ring or trapezoid) in the detector plane.
+ * This is exact for the tracks entering from the front or back face, which is
+ * the case for the thin detectors.
+ *
+ * The strip coordinates follow TDetectParticleProcessor: the hit position
+ * relative to the center_rotation point, rotated back by `angle`.
+ */
+class TDetectorHitFinder {
+  public:
+    /// @brief result of FindHit
+    struct Hit {
+        Int_t fDetID;       ///< index in the detector parameter array
+        Double_t fDistance; ///< distance from the start point (mm)
+        Double_t fPos[3];   ///< hit position in the LAB frame (mm)
+        Double_t fLocalX;   ///< x of the strip coordinate (mm)
+        Double_t fLocalY;   ///< y of the strip coordinate (mm)
+    };
+
+    TDetectorHitFinder() = default;
+
+    void Clear();
+    /// @brief adds a detector; the index is the order of the call
+    void AddDetector(const TDetectorParameter *prm);
+    Int_t GetN() const { return fCx.size(); }
+
+    /**
+     * @brief Finds the first detector entered by the ray pos + t * dir (t > 0).
+     * @param (dir) unit vector
+     * @return kFALSE if the ray does not enter any detector
+     */
+    Bool_t FindHit(const Double_t *pos, const Double_t *dir, Hit &hit) const;
+
+    /// @brief strip coordinate of the LAB position on the detector
+    void GetLocalPosition(Int_t id, const Double_t *pos, Double_t &x, Double_t &y) const;
+
+    /// @brief LAB positions of the 8 corners of the detector box
+    void GetCorners(Int_t id, Double_t corners[8][3]) const;
+
+    /// @brief |cos| of the angle between `dir` (unit vector) and the detector normal
+    Double_t GetCosIncidence(Int_t id, const Double_t *dir) const {
+        const Double_t cs = dir[0] * fSin[id] + dir[2] * fCos[id];
+        return cs < 0.0 ? -cs : cs;
+    }
+
+    /**
+     * @brief Strip ID of the position (-1 if outside), `size` is centered at 0.
+     */
+    static Int_t GetStripID(Double_t pos, Int_t max_strip, Double_t size) {
+        const Double_t f = (pos / size + 0.5) * max_strip;
+        if (!(f > 0.0) || !(f < max_strip))
+            return -1;
+        return static_cast<Int_t>(f);
+    }
+
+  private:
+    /// @brief the point (u, v) in the detector plane is inside the cross section
+    Bool_t IsInside(Int_t id, Double_t u, Double_t v) const;
+
+    // box center
+    std::vector<Double_t> fCx, fCy, fCz;
+    // in-plane axis perpendicular to y, (cos, 0, -sin), and the normal, (sin, 0, cos)
+    std::vector<Double_t> fCos, fSin;
+    // half sizes along the in-plane axis, y and the normal
+    std::vector<Double_t> fHalfU, fHalfV, fHalfN;
+    // origin of the strip coordinate (center_rotation)
+    std::vector<Double_t> fRx, fRy, fRz;
+    // TDetectorParameter::EShape and the cross section
+    // tube: (rmin^2, rmax^2), trapezoid: half width along y at u = +fHalfU and -fHalfU
+    std::vector<Int_t> fShape;
+    std::vector<Double_t> fShapeA, fShapeB;
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TDETECTORHITFINDER_H_
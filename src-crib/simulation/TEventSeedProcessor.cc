@@ -0,0 +1,65 @@
+/**
+ * @file    TEventSeedProcessor.cc
+ * @brief   Reseed the random generator for each event from its global event number
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 16:31:05
+ * @note    last modified: 2026-10-18 16:31:05
+ * @details
+ */
+
+#include "TEventSeedProcessor.h"
+
+#include <TRandomGen.h>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TEventSeedProcessor);
+
+namespace art::crib {
+
+TEventSeedProcessor::TEventSeedProcessor() {
+    RegisterProcessorParameter("Seed", "base seed of the simulation", fSeed, 1L);
+    RegisterOptionalParameter("FirstEventNum", "global event number of the first event of this job", fFirstEventNum,
+                              0L);
+}
+
+TEventSeedProcessor::~TEventSeedProcessor() {
+    if (fRandom && gRandom == fRandom) {
+        gRandom = fPrevRandom;
+    }
+    delete fRandom;
+    fRandom = nullptr;
+}
+
+/**
+ * @details
+ * MixMax is used since its seeding is cheap compared with TRandom3 (Mersenne Twister),
+ * and it accepts a 64 bit seed.
+ */
+void TEventSeedProcessor::Init(TEventCollection *) {
+    if (!fRandom) {
+        fRandom = new TRandomMixMax();
+        fPrevRandom = gRandom;
+    }
+    gRandom = fRandom;
+    fEventNum = fFirstEventNum;
+    Info("Init", "seed %ld, first event %ld", fSeed, fFirstEventNum);
+}
+
+void TEventSeedProcessor::Process() {
+    fRandom->SetSeed(GetEventSeed(fSeed, fEventNum));
+    ++fEventNum;
+}
+
+/**
+ * @details
+ * splitmix64 finalizer, neighbouring event numbers give uncorrelated seeds.
+ */
+ULong64_t TEventSeedProcessor::GetEventSeed(ULong64_t seed, ULong64_t event) {
+    ULong64_t z = seed + (event + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 1; // 0 means a time based seed in ROOT
+}
+
+} // namespace art::crib
@@ -0,0 +1,68 @@
+/**
+ * @file    TEventSeedProcessor.h
+ * @brief   Reseed the random generator for each event from its global event number
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 16:31:05
+ * @note    last modified: 2026-10-18 16:31:05
+ * @details
+ */
+
+#ifndef CRIB_TEVENTSEEDPROCESSOR_H_
+#define CRIB_TEVENTSEEDPROCESSOR_H_
+
+#include <TProcessor.h>
+
+class TRandom;
+
+namespace art::crib {
+/**
+ * @class TEventSeedProcessor
+ * @brief Makes the random numbers of each event independent of the event loop.
+ *
+ * The simulation processors use gRandom. This processor replaces gRandom by its
+ * own generator and reseeds it at every event with a hash of (Seed, event number),
+ * where the event number counts from FirstEventNum.
+ * Each event then gets the same random sequence whichever job processes it,
+ * so that a long simulation can be split into several jobs (see simparallel.sh),
+ * and the merged output is the same as the single job output.
+ *
+ * Put this processor just after the event store, before any processor using gRandom.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: seed
+ *     type: art::crib::TEventSeedProcessor
+ *     parameter:
+ *       Seed: 1  # [Long_t] base seed of the simulation
+ *       FirstEventNum: 0  # [Long_t] global event number of the first event of this job
+ * ```
+ */
+class TEventSeedProcessor : public TProcessor {
+  public:
+    TEventSeedProcessor();
+    ~TEventSeedProcessor() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+
+    /// @brief seed of the event (non-zero)
+    static ULong64_t GetEventSeed(ULong64_t seed, ULong64_t event);
+
+  private:
+    Long_t fSeed;          ///< base seed
+    Long_t fFirstEventNum; ///< global event number of the first event
+    Long_t fEventNum{0};   //! current global event number
+
+    TRandom *fRandom{nullptr};     //! generator used as gRandom
+    TRandom *fPrevRandom{nullptr}; //! gRandom before Init
+
+    TEventSeedProcessor(const TEventSeedProcessor &rhs) = delete;
+    TEventSeedProcessor &operator=(const TEventSeedProcessor &rhs) = delete;
+
+    ClassDefOverride(TEventSeedProcessor, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TEVENTSEEDPROCESSOR_H_
@@ -3,26 +3,62 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 22:36:36
- * @note    last modified: 2024-10-30 16:22:33
+ * @note    last modified: 2026-10-18 22:21:08
  * @details for (angle) constant cross section
  */
 
 #include "TNBodyReactionProcessor.h"
 
+#include "../geo/TDetectorParameter.h"
 #include "../reconst/TReactionInfo.h"
+#include "TDetectorHitFinder.h"
 #include "TParticleInfo.h"
 #include <Mass.h> // TSrim library
 #include <TRandom.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
-#include <regex>
+#include <sstream>
 
 using art::crib::TNBodyReactionProcessor;
 
 ClassImp(TNBodyReactionProcessor);
 
+namespace {
+/// linear interpolation of a table on a uniform grid, t is the position in units of the grid step
+Double_t EvalTable(const std::vector<Double_t> &table, Double_t t) {
+    const Int_t n = table.size() - 1;
+    if (!(t > 0.0))
+        return table.front();
+    if (t >= n)
+        return table.back();
+    const Int_t k = static_cast<Int_t>(t);
+    return table[k] + (t - k) * (table[k + 1] - table[k]);
+}
+
+/// tabulate the inverse of the piecewise linear non-decreasing function (x, y) on n bins of [y.front(), y.back()]
+void FillInverseTable(const std::vector<Double_t> &x, const std::vector<Double_t> &y, Int_t n,
+                      std::vector<Double_t> &table) {
+    const Int_t npoint = x.size();
+    const Double_t step = (y.back() - y.front()) / n;
+    table.resize(n + 1);
+    Int_t seg = 0;
+    for (Int_t k = 0; k <= n; k++) {
+        const Double_t val = y.front() + k * step;
+        while (seg < npoint - 2 && y[seg + 1] < val) {
+            seg++;
+        }
+        const Double_t dy = y[seg + 1] - y[seg];
+        const Double_t t = dy > 0.0 ? std::clamp((val - y[seg]) / dy, 0.0, 1.0) : 0.0;
+        table[k] = x[seg] + t * (x[seg + 1] - x[seg]);
+    }
+}
+} // namespace
+
 TNBodyReactionProcessor::TNBodyReactionProcessor()
-    : fInData(nullptr), fOutData(nullptr), fOutReacData(nullptr), srim(nullptr) {
+    : fInData(nullptr), fOutData(nullptr), fOutReacData(nullptr), srim(nullptr),
+      fBeamMass(0.0), fTargetMass(0.0), fTwoBodySum2(0.0), fTwoBodyDiff2(0.0), fDetectorPrm(nullptr),
+      fGenMin(0.0), fGenStep(1.0), fInvStep(1.0) {
     RegisterInputCollection("InputCollection", "input branch (collection) name", fInputColName, TString("input"));
     RegisterOutputCollection("OutputCollection", "output branch (collection) name", fOutputColName,
                              TString("reaction_particles"));
@@ -52,19 +88,27 @@ TNBodyReactionProcessor::TNBodyReactionProcessor()
     RegisterProcessorParameter("CrossSectionPath", "path to the cross section data file", fCSDataPath, TString(""));
     RegisterProcessorParameter("CrossSectionType",
                                "energy format, 0: LAB energy like TALYS, 1: LAB at inverse kinematics, 2: Ecm", fCSType, 0);
+    RegisterOptionalParameter("AngularDistributionPath",
+                              "(theta_cm (deg), dsigma/dOmega) of id=0 particle for two-body reaction, empty: isotropic",
+                              fAngDistPath, TString(""));
+    RegisterOptionalParameter("ForcedDetection",
+                              "emit the particle of this id only toward the detectors, with event weight (-1: off)",
+                              fForcedID, -1);
+    RegisterOptionalParameter("ForcedDetectionMargin", "margin of the detector cone (deg)", fForcedMargin, 2.0);
+    RegisterOptionalInputInfo("DetectorParameter", "name of telescope parameter (used for ForcedDetection)",
+                              fDetectorParameterName, TString("prm_detectors"), &fDetectorPrm, "TClonesArray",
+                              "art::crib::TDetectorParameter");
+    RegisterOptionalParameter("SamplingGridSize", "number of bins of the reaction position sampling tables",
+                              fGridSize, 8192);
 }
 
 TNBodyReactionProcessor::~TNBodyReactionProcessor() {
     delete fOutData;
     delete fOutReacData;
     delete srim;
-    delete gr_generating_func;
-    delete gr_generating_func_inv;
     fOutData = nullptr;
     fOutReacData = nullptr;
     srim = nullptr;
-    gr_generating_func = nullptr;
-    gr_generating_func_inv = nullptr;
 }
 
 void TNBodyReactionProcessor::Init(TEventCollection *col) {
@@ -88,6 +132,43 @@ void TNBodyReactionProcessor::Init(TEventCollection *col) {
              amdc::GetEl(fReacAtmNum[i]).c_str(), fReacMassNum[i], fReacAtmNum[i], fExciteLevel[i]);
     }
 
+    // masses are fixed during the loop (MeV)
+    fBeamMass = amdc::Mass(fBeamNucleus[0], fBeamNucleus[1]) * amdc::amu;
+    fTargetMass = amdc::Mass(fTargetAtmNum, fTargetMassNum) * amdc::amu;
+    fReacMass.assign(fDecayNum, 0.0);
+    fReacMassGeV.assign(fDecayNum, 0.0);
+    Double_t qvalue = fBeamMass + fTargetMass;
+    for (Int_t i = 0; i < fDecayNum; i++) {
+        fReacMass[i] = amdc::Mass(fReacAtmNum[i], fReacMassNum[i]) * amdc::amu + fExciteLevel[i];
+        fReacMassGeV[i] = fReacMass[i] * 0.001;
+        qvalue -= fReacMass[i];
+    }
+    Info("Init", "Q-value: %lf MeV", qvalue);
+    fNForbidden = 0;
+    fTargetNameStr = fTargetName.Data();
+
+    if (fDecayNum == 2) {
+        fTwoBodySum2 = (fReacMass[0] + fReacMass[1]) * (fReacMass[0] + fReacMass[1]);
+        fTwoBodyDiff2 = (fReacMass[0] - fReacMass[1]) * (fReacMass[0] - fReacMass[1]);
+        const Double_t s = (fBeamMass + fTargetMass) * (fBeamMass + fTargetMass) + 2.0 * fTargetMass * fBeamEnergy;
+        if (s > fTwoBodySum2) {
+            const Double_t p_cm = TMath::Sqrt((s - fTwoBodySum2) * (s - fTwoBodyDiff2) / s) / 2.0;
+            Info("Init", "two-body kinematics, p_cm = %lf MeV/c at the beam energy %lf MeV", p_cm, fBeamEnergy);
+        } else {
+            Warning("Init", "two-body kinematics, below the threshold at the beam energy %lf MeV", fBeamEnergy);
+        }
+        if (!InitAngularDistribution() || !InitForcedDetection()) {
+            return;
+        }
+    } else {
+        if (fAngDistPath != "") {
+            Warning("Init", "AngularDistributionPath is used only for two-body reaction, ignored");
+        }
+        if (fForcedID >= 0) {
+            Warning("Init", "ForcedDetection is used only for two-body reaction, ignored");
+        }
+    }
+
     fInData = reinterpret_cast<TClonesArray **>(col->GetObjectRef(fInputColName.Data()));
     if (!fInData) {
         SetStateError(TString::Format("input not found: %s", fInputColName.Data()));
@@ -136,21 +217,16 @@ void TNBodyReactionProcessor::Process() {
     const TDataObject *const inData = static_cast<TDataObject *>((*fInData)->At(0));
     const TParticleInfo *const Data = dynamic_cast<const TParticleInfo *>(inData);
 
-    Double_t target_mass = amdc::Mass(fTargetAtmNum, fTargetMassNum) * amdc::amu; // MeV
-    TLorentzVector target_vec(0., 0., 0., target_mass);
     TLorentzVector beam_vec = Data->GetLorentzVector();
-    Double_t beam_mass = amdc::Mass(fBeamNucleus[0], fBeamNucleus[1]) * amdc::amu; // MeV
     Double_t beam_energy = Data->GetEnergy();
 
     // calculate reaction position
     // target should be set at z=0 (entrance of gas target)
     Double_t range;
     if (fTargetIsGas) {
-        range = srim->Range(fBeamNucleus[0], fBeamNucleus[1], beam_energy,
-                            std::string(fTargetName.Data()), fTargetPressure, 300.0);
+        range = srim->Range(fBeamNucleus[0], fBeamNucleus[1], beam_energy, fTargetNameStr, fTargetPressure, 300.0);
     } else {
-        range = srim->Range(fBeamNucleus[0], fBeamNucleus[1], beam_energy,
-                            std::string(fTargetName.Data()));
+        range = srim->Range(fBeamNucleus[0], fBeamNucleus[1], beam_energy, fTargetNameStr);
     }
 
     // determine using random number
@@ -158,10 +234,10 @@ void TNBodyReactionProcessor::Process() {
     Double_t beam_energy_new = 0.0;
     if (fTargetIsGas) {
         beam_energy_new = srim->EnergyNew(fBeamNucleus[0], fBeamNucleus[1], beam_energy,
-                                          std::string(fTargetName.Data()), reac_distance, fTargetPressure, 300.0);
+                                          fTargetNameStr, reac_distance, fTargetPressure, 300.0);
     } else {
         beam_energy_new = srim->EnergyNew(fBeamNucleus[0], fBeamNucleus[1], beam_energy,
-                                          std::string(fTargetName.Data()), reac_distance);
+                                          fTargetNameStr, reac_distance);
     }
 
     Double_t reac_posz = 0.0;
@@ -170,114 +246,487 @@ void TNBodyReactionProcessor::Process() {
     }
     Double_t reac_posx = Data->GetTrack().GetX(reac_posz);
     Double_t reac_posy = Data->GetTrack().GetY(reac_posz);
+    const TVector3 reac_pos(reac_posx, reac_posy, reac_posz);
 
     beam_vec = GetLossEnergyVector(beam_vec, beam_energy - beam_energy_new);
 
     // calculate tof in the target (mean value)
     Double_t duration_beam = 0.0;
     if (fTargetIsGas) {
-        duration_beam += reac_distance / (TMath::Sqrt(1.0 - TMath::Power(beam_mass / beam_vec.E(), 2.0)) * c);
+        duration_beam += reac_distance / (TMath::Sqrt(1.0 - TMath::Power(fBeamMass / beam_vec.E(), 2.0)) * c);
     } // if solid target, tof is almost zero
 
-    DoubleVec_t reac_masses;
-    for (Int_t iPart = 0; iPart < fDecayNum; iPart++) {
-        Double_t mass = amdc::Mass(fReacAtmNum[iPart], fReacMassNum[iPart]) * amdc::amu; // MeV
-        mass += fExciteLevel[iPart];
-        reac_masses.emplace_back(mass);
-    }
+    Double_t energy_cm = 0.0;
+    Double_t theta_cm = 0.0;
+    fEventWeight = fWeight;
+    if (fDecayNum == 2) {
+        // two-body: analytic kinematics in the CM system
+        const Double_t e_tot = beam_vec.E() + fTargetMass;
+        const Double_t px = beam_vec.Px(), py = beam_vec.Py(), pz = beam_vec.Pz();
+        const Double_t p_beam = TMath::Sqrt(px * px + py * py + pz * pz);
+        const Double_t s = e_tot * e_tot - p_beam * p_beam;
+        const Double_t sqrt_s = TMath::Sqrt(s);
+        energy_cm = sqrt_s - fBeamMass - fTargetMass;
+        // below the threshold, the event is kept with the products at rest in the CM system
+        const Bool_t is_forbidden = s <= fTwoBodySum2;
+        if (is_forbidden) {
+            CountForbidden();
+        }
+        const Double_t p_cm =
+            is_forbidden ? 0.0 : TMath::Sqrt((s - fTwoBodySum2) * (s - fTwoBodyDiff2)) / (2.0 * sqrt_s);
+        Double_t e_cm[2] = {fReacMass[0], fReacMass[1]};
+        if (!is_forbidden) {
+            e_cm[0] = (s + fReacMass[0] * fReacMass[0] - fReacMass[1] * fReacMass[1]) / (2.0 * sqrt_s);
+            e_cm[1] = (s + fReacMass[1] * fReacMass[1] - fReacMass[0] * fReacMass[0]) / (2.0 * sqrt_s);
+        }
 
-    TLorentzVector compound_vec = beam_vec + target_vec;
+        // emission angle of id=0 particle with respect to the beam direction
+        const Double_t cos_cm = SampleCosThetaCM(energy_cm, fEventWeight);
+        const Double_t sin_cm = TMath::Sqrt(std::max(0.0, 1.0 - cos_cm * cos_cm));
+        const Double_t phi = SamplePhiCM();
+        const Double_t lx = sin_cm * TMath::Cos(phi), ly = sin_cm * TMath::Sin(phi), lz = cos_cm;
+        theta_cm = TMath::ACos(cos_cm) / deg2rad;
+
+        // rotate to the LAB axes (same as TVector3::RotateUz)
+        Double_t ux = 0.0, uy = 0.0, uz = 1.0;
+        if (p_beam > 0.0) {
+            ux = px / p_beam;
+            uy = py / p_beam;
+            uz = pz / p_beam;
+        }
+        Double_t nx = lx, ny = ly, nz = lz;
+        const Double_t up = TMath::Sqrt(ux * ux + uy * uy);
+        if (up > 0.0) {
+            nx = (ux * uz * lx - uy * ly) / up + ux * lz;
+            ny = (uy * uz * lx + ux * ly) / up + uy * lz;
+            nz = -up * lx + uz * lz;
+        } else if (uz < 0.0) {
+            nx = -lx;
+            nz = -lz;
+        }
 
-    // to CM system (only beam_vec and target_vec)
-    TVector3 beta_vec = compound_vec.BoostVector();
-    beam_vec.Boost(-beta_vec);
-    target_vec.Boost(-beta_vec);
-    Double_t energy_cm = (beam_vec.E() - beam_vec.M()) + (target_vec.E() - target_mass);
+        // boost to the LAB system, beta = p_beam / e_tot
+        const Double_t gamma = e_tot / sqrt_s;
+        const Double_t bx = px / e_tot, by = py / e_tot, bz = pz / e_tot;
+        const Double_t gamma2 = gamma * gamma / (1.0 + gamma);
+        for (Int_t iPart = 0; iPart < 2; ++iPart) {
+            const Double_t sign = iPart == 0 ? 1.0 : -1.0;
+            const Double_t qx = sign * p_cm * nx, qy = sign * p_cm * ny, qz = sign * p_cm * nz;
+            const Double_t bq = bx * qx + by * qy + bz * qz;
+            const Double_t factor = gamma2 * bq + gamma * e_cm[iPart];
+            const TLorentzVector reac_vec(qx + factor * bx, qy + factor * by, qz + factor * bz,
+                                          gamma * (e_cm[iPart] + bq));
+            FillParticle(iPart, reac_vec, TMath::ACos(sign * nz) / deg2rad,
+                         TMath::ATan2(sign * ny, sign * nx) / deg2rad, reac_pos, reac_distance, duration_beam);
+        }
+    } else {
+        TLorentzVector target_vec(0., 0., 0., fTargetMass);
+        TLorentzVector compound_vec = beam_vec + target_vec;
+
+        // to CM system (only beam_vec and target_vec)
+        TVector3 beta_vec = compound_vec.BoostVector();
+        beam_vec.Boost(-beta_vec);
+        target_vec.Boost(-beta_vec);
+        energy_cm = (beam_vec.E() - beam_vec.M()) + (target_vec.E() - fTargetMass);
+
+        // need to change MeV to GeV
+        compound_vec *= 0.001;
+        Bool_t isOkay = event.SetDecay(compound_vec, fDecayNum, fReacMassGeV.data());
+        if (!isOkay) {
+            CountForbidden();
+        }
+        event.Generate();
+
+        for (Int_t iPart = 0; iPart < fDecayNum; ++iPart) {
+            TLorentzVector reac_vec = *event.GetDecay(iPart);
+            // need to change GeV to MeV
+            reac_vec *= 1000.;
+
+            // compound_vec and reac_vec is LAB system, convert to CM system
+            TLorentzVector cm_vec = reac_vec;
+            cm_vec.Boost(-beta_vec);
+            FillParticle(iPart, reac_vec, cm_vec.Theta() / deg2rad, cm_vec.Phi() / deg2rad, reac_pos,
+                         reac_distance, duration_beam);
+            if (iPart == 0) {
+                theta_cm = (Data->GetLorentzVector()).Angle(cm_vec.Vect()) / deg2rad;
+            }
+        }
+    }
+
+    TReactionInfo *outReacData = static_cast<TReactionInfo *>(fOutReacData->ConstructedAt(0));
+    outReacData->SetID(0);
+    outReacData->SetExEnergy(fExciteLevel[0]);
+    outReacData->SetEnergy(energy_cm);
+    outReacData->SetTheta(theta_cm);
+    outReacData->SetXYZ(reac_posx, reac_posy, reac_posz);
+    outReacData->SetWeight(fEventWeight);
+    outReacData->SetPolarWeight(fPolarWeight);
+}
 
-    // need to change MeV to GeV
-    compound_vec *= 0.001;
-    DoubleVec_t GeVMass;
-    for (decltype(reac_masses.size()) i = 0; i < reac_masses.size(); i++) {
-        GeVMass.emplace_back(reac_masses[i] * 0.001);
+void TNBodyReactionProcessor::PostLoop() {
+    if (fNForbidden > 0) {
+        Warning("PostLoop", "%lld events with forbidden kinematics", fNForbidden);
     }
+}
 
-    Bool_t isOkay = event.SetDecay(compound_vec, fDecayNum, GeVMass.data());
-    if (!isOkay) {
-        std::cerr << "forbidden kinematics" << std::endl;
+/**
+ * @details
+ * Only the first event is reported, the total is printed at PostLoop.
+ */
+void TNBodyReactionProcessor::CountForbidden() {
+    if (fNForbidden++ == 0) {
+        Warning("Process", "forbidden kinematics, the event is kept (only the first one is reported)");
     }
-    event.Generate();
+}
 
-    Double_t theta_cm = 0.0;
-    for (Int_t iPart = 0; iPart < fDecayNum; ++iPart) {
-        TLorentzVector reac_vec = *event.GetDecay(iPart);
-        // need to change GeV to MeV
-        reac_vec *= 1000.;
-
-        TParticleInfo *outData = static_cast<TParticleInfo *>(fOutData->ConstructedAt(iPart));
-        outData->SetID(iPart);
-        outData->SetMassNumber(fReacMassNum[iPart]);
-        outData->SetAtomicNumber(fReacAtmNum[iPart]);
-        outData->SetCharge(fReacAtmNum[iPart]); // no need?
-        outData->SetTrack(reac_posx, reac_posy, reac_posz, TMath::ATan(reac_vec.Px() / reac_vec.Pz()),
-                          TMath::ATan(reac_vec.Py() / reac_vec.Pz()));
-        if (fTargetIsGas) {
-            outData->SetLorentzVector(reac_vec);
-            outData->SetEnergy(reac_vec.E() - reac_masses[iPart]);
-            outData->SetCurrentZ(reac_posz);
-            outData->SetZeroTime(); // initialize
-            outData->AddTime(duration_beam);
+/**
+ * @details
+ * Stores the reaction product (LAB four-momentum `reac_vec` at the reaction position).
+ * For the solid target, the energy loss in the rest of the target is applied.
+ */
+void TNBodyReactionProcessor::FillParticle(Int_t iPart, const TLorentzVector &reac_vec, Double_t theta_cm,
+                                           Double_t phi_cm, const TVector3 &reac_pos, Double_t reac_distance,
+                                           Double_t duration_beam) {
+    TParticleInfo *outData = static_cast<TParticleInfo *>(fOutData->ConstructedAt(iPart));
+    outData->SetID(iPart);
+    outData->SetMassNumber(fReacMassNum[iPart]);
+    outData->SetAtomicNumber(fReacAtmNum[iPart]);
+    outData->SetCharge(fReacAtmNum[iPart]); // no need?
+    outData->SetTrack(reac_pos.X(), reac_pos.Y(), reac_pos.Z(), TMath::ATan(reac_vec.Px() / reac_vec.Pz()),
+                      TMath::ATan(reac_vec.Py() / reac_vec.Pz()));
+    if (fTargetIsGas) {
+        outData->SetLorentzVector(reac_vec);
+        outData->SetEnergy(reac_vec.E() - fReacMass[iPart]);
+        outData->SetCurrentZ(reac_pos.Z());
+        outData->SetZeroTime(); // initialize
+        outData->AddTime(duration_beam);
+    } else {
+        // for the solid target, ignore the angle
+        Double_t first_energy = reac_vec.E() - fReacMass[iPart];
+        if (first_energy > 0.01) {
+            Double_t out_thickness = fTargetThickness - reac_distance;
+            if (out_thickness < 0.0) {
+                out_thickness = 0.0;
+            }
+            TLorentzVector out_vec =
+                GetLossEnergyVector(reac_vec,
+                                    first_energy - srim->EnergyNew(fReacAtmNum[iPart], fReacMassNum[iPart], first_energy, fTargetNameStr, out_thickness));
+
+            outData->SetLorentzVector(out_vec);
+            outData->SetEnergy(out_vec.E() - fReacMass[iPart]);
+            outData->SetCurrentZ(fTargetThickness);
+            outData->SetZeroTime();
         } else {
-            // for the solid target, ignore the angle
-            Double_t first_energy = reac_vec.E() - reac_masses[iPart];
-            if (first_energy > 0.01) {
-                Double_t out_thickness = fTargetThickness - reac_distance;
-                if (out_thickness < 0.0) {
-                    out_thickness = 0.0;
+            outData->SetLorentzVector(0.0, 0.0, 0.0, fReacMass[iPart]);
+            outData->SetEnergy(0.0);
+            outData->SetCurrentZ(reac_pos.Z());
+            outData->SetZeroTime();
+        }
+    }
+    outData->SetThetaCM(theta_cm);
+    outData->SetPhiCM(phi_cm);
+    outData->SetWeight(fEventWeight);
+}
+
+/**
+ * @details
+ * The file has (theta_cm (deg), dsigma/dOmega) lines for id=0 particle.
+ * Since dOmega = dcos dphi, the distribution of cos(theta_cm) is integrated
+ * and its inverse is tabulated on a uniform grid.
+ * @return kFALSE if the file is given but cannot be used
+ */
+Bool_t TNBodyReactionProcessor::InitAngularDistribution() {
+    fCosTable.clear();
+    if (fAngDistPath == "") {
+        Info("Init", "isotropic angular distribution in the CM system");
+        return kTRUE;
+    }
+    std::ifstream fin(fAngDistPath.Data());
+    if (!fin) {
+        SetStateError(TString::Format("cannot open angular distribution file: %s", fAngDistPath.Data()));
+        return kFALSE;
+    }
+
+    std::vector<std::pair<Double_t, Double_t>> points; // (cos, dsigma/dOmega)
+    std::string line;
+    while (std::getline(fin, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        Double_t theta = 0.0, dcs = 0.0;
+        if (!(iss >> theta >> dcs)) {
+            continue;
+        }
+        points.emplace_back(TMath::Cos(theta * deg2rad), std::max(dcs, 0.0));
+    }
+    if (points.size() < 2) {
+        SetStateError(TString::Format("at least 2 points are needed in %s", fAngDistPath.Data()));
+        return kFALSE;
+    }
+    std::stable_sort(points.begin(), points.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+    const Int_t npoint = points.size();
+    std::vector<Double_t> cos_val(npoint), cdf(npoint);
+    Double_t sum = 0.0;
+    for (Int_t i = 0; i < npoint; i++) {
+        if (i > 0) {
+            sum += 0.5 * (points[i - 1].second + points[i].second) * (points[i].first - points[i - 1].first);
+        }
+        cos_val[i] = points[i].first;
+        cdf[i] = sum;
+    }
+    if (!(sum > 0.0)) {
+        SetStateError(TString::Format("angular distribution in %s is empty", fAngDistPath.Data()));
+        return kFALSE;
+    }
+    FillInverseTable(cos_val, cdf, fGridSize, fCosTable);
+    Info("Init", "angular distribution: %s (%d points, %lf mb)", fAngDistPath.Data(), npoint,
+         TMath::TwoPi() * sum);
+    return kTRUE;
+}
+
+/**
+ * @details
+ * Cumulative probability of cos(theta_cm) of id=0 particle (inverse of the sampling).
+ */
+Double_t TNBodyReactionProcessor::GetCosCDF(Double_t cos) const {
+    if (fCosTable.empty())
+        return std::clamp((cos + 1.0) / 2.0, 0.0, 1.0);
+    if (cos <= fCosTable.front())
+        return 0.0;
+    if (cos >= fCosTable.back())
+        return 1.0;
+    const auto k = std::distance(fCosTable.begin(), std::upper_bound(fCosTable.begin(), fCosTable.end(), cos));
+    const Double_t dc = fCosTable[k] - fCosTable[k - 1];
+    const Double_t t = dc > 0.0 ? (cos - fCosTable[k - 1]) / dc : 0.0;
+    return (k - 1 + t) / fGridSize;
+}
+
+/**
+ * @details
+ * Without ForcedDetection, the emission is sampled in the full solid angle with weight 1.
+ * With ForcedDetection, the LAB directions from the reaction points on the beam axis
+ * to the edges of each detector box give the polar and azimuthal ranges of the detector cone.
+ * The polar range is converted to the theta_cm range of the particle using the two-body
+ * kinematics for the beam energies up to 1.1 x BeamEnergy, and the sampling of id=0
+ * particle is restricted to the corresponding cos(theta_cm) and phi ranges.
+ * The event weight is the probability of the restricted region in the original distribution.
+ */
+Bool_t TNBodyReactionProcessor::InitForcedDetection() {
+    fCosUMin = 0.0;
+    fCosUMax = 1.0;
+    fPhiRange.assign(1, std::make_pair(-TMath::Pi(), TMath::Pi()));
+    fPhiTotal = TMath::TwoPi();
+    fWeight = 1.0;
+    fPolarWeight = 1.0;
+    if (fForcedID < 0) {
+        return kTRUE;
+    }
+    if (fForcedID > 1) {
+        SetStateError("ForcedDetection should be 0 or 1 (particle id) for two-body reaction");
+        return kFALSE;
+    }
+    if (!fDetectorPrm || (*fDetectorPrm)->GetEntriesFast() == 0) {
+        SetStateError(Form("ForcedDetection needs detector parameter %s, run TUserGeoInitializer before this",
+                           fDetectorParameterName.Data()));
+        return kFALSE;
+    }
+
+    // LAB cone of each detector seen from the reaction points
+    const Double_t margin = fForcedMargin * deg2rad;
+    const Int_t nz = fTargetIsGas ? 11 : 1;
+    const Int_t nedge = 20;
+    std::vector<std::pair<Double_t, Double_t>> lab_theta; // (min, max) for each detector
+    std::vector<std::pair<Double_t, Double_t>> lab_phi;   // (min, max) for each detector, can exceed [-pi, pi]
+    Bool_t is_full_phi = kFALSE;
+    for (Int_t iDet = 0; iDet < (*fDetectorPrm)->GetEntriesFast(); iDet++) {
+        TDetectorHitFinder finder;
+        finder.AddDetector(static_cast<const TDetectorParameter *>((*fDetectorPrm)->At(iDet)));
+        Double_t corners[8][3];
+        finder.GetCorners(0, corners);
+
+        Double_t tmin = TMath::Pi(), tmax = 0.0;
+        Double_t pmin = TMath::Pi(), pmax = -TMath::Pi();
+        Bool_t on_axis = kFALSE;
+        Double_t phi_ref = 0.0;
+        for (Int_t iz = 0; iz < nz; iz++) {
+            const Double_t z = nz > 1 ? fTargetThickness * iz / (nz - 1) : 0.0;
+            const Double_t pos[3] = {0.0, 0.0, z};
+            const Double_t axis[3] = {0.0, 0.0, 1.0};
+            TDetectorHitFinder::Hit hit;
+            if (finder.FindHit(pos, axis, hit)) {
+                on_axis = kTRUE;
+            }
+            // sample the 12 edges of the box
+            for (Int_t a = 0; a < 8; a++) {
+                for (Int_t bit = 1; bit < 8; bit <<= 1) {
+                    if (a & bit) {
+                        continue;
+                    }
+                    const Int_t b = a | bit;
+                    for (Int_t i = 0; i <= nedge; i++) {
+                        const Double_t t = (Double_t)i / nedge;
+                        const Double_t x = corners[a][0] + t * (corners[b][0] - corners[a][0]);
+                        const Double_t y = corners[a][1] + t * (corners[b][1] - corners[a][1]);
+                        const Double_t dz = corners[a][2] + t * (corners[b][2] - corners[a][2]) - z;
+                        const Double_t theta = TMath::ATan2(TMath::Sqrt(x * x + y * y), dz);
+                        Double_t phi = TMath::ATan2(y, x);
+                        if (tmin > tmax) {
+                            phi_ref = phi; // first point, phi is measured around this value
+                        }
+                        phi = phi_ref + TMath::ATan2(TMath::Sin(phi - phi_ref), TMath::Cos(phi - phi_ref));
+                        tmin = std::min(tmin, theta);
+                        tmax = std::max(tmax, theta);
+                        pmin = std::min(pmin, phi);
+                        pmax = std::max(pmax, phi);
+                    }
                 }
-                TLorentzVector out_vec =
-                    GetLossEnergyVector(reac_vec,
-                                        first_energy - srim->EnergyNew(fReacAtmNum[iPart], fReacMassNum[iPart], first_energy, std::string(fTargetName.Data()), out_thickness));
-
-                outData->SetLorentzVector(out_vec);
-                outData->SetEnergy(out_vec.E() - reac_masses[iPart]);
-                outData->SetCurrentZ(fTargetThickness);
-                outData->SetZeroTime();
-            } else {
-                // outData->SetLorentzVector(reac_vec);
-                outData->SetLorentzVector(0.0, 0.0, 0.0, reac_masses[iPart]);
-                outData->SetEnergy(0.0);
-                outData->SetCurrentZ(reac_posz);
-                outData->SetZeroTime();
             }
         }
+        if (on_axis) {
+            tmin = 0.0;
+            is_full_phi = kTRUE;
+        }
+        lab_theta.emplace_back(std::max(tmin - margin, 0.0), std::min(tmax + margin, TMath::Pi()));
+        lab_phi.emplace_back(pmin - margin, pmax + margin);
+        Info("Init", "ForcedDetection: detector %d, theta_lab %.1lf -- %.1lf deg, phi %.1lf -- %.1lf deg", iDet,
+             lab_theta.back().first / deg2rad, lab_theta.back().second / deg2rad, lab_phi.back().first / deg2rad,
+             lab_phi.back().second / deg2rad);
+    }
 
-        // compound_vec and reac_vec is LAB system, convert to CM system
-        reac_vec.Boost(-beta_vec);
-        outData->SetThetaCM(reac_vec.Theta() / deg2rad);
-        outData->SetPhiCM(reac_vec.Phi() / deg2rad);
-        if (iPart == 0) {
-            theta_cm = (Data->GetLorentzVector()).Angle(reac_vec.Vect()) / deg2rad;
+    // theta_cm of the forced particle which can reach the detectors
+    const Int_t ntheta = 3600;
+    const Int_t nenergy = 60;
+    const Int_t id = fForcedID;
+    Int_t imin = ntheta + 1, imax = -1;
+    Int_t nallowed = 0;
+    for (Int_t ie = 1; ie <= nenergy; ie++) {
+        const Double_t t_beam = 1.1 * fBeamEnergy * ie / nenergy;
+        const Double_t s = (fBeamMass + fTargetMass) * (fBeamMass + fTargetMass) + 2.0 * fTargetMass * t_beam;
+        if (s <= fTwoBodySum2) {
+            continue;
         }
+        nallowed++;
+        const Double_t sqrt_s = TMath::Sqrt(s);
+        const Double_t p_cm = TMath::Sqrt((s - fTwoBodySum2) * (s - fTwoBodyDiff2)) / (2.0 * sqrt_s);
+        const Double_t e_cm = (s + fReacMass[id] * fReacMass[id] - fReacMass[1 - id] * fReacMass[1 - id]) /
+                              (2.0 * sqrt_s);
+        const Double_t gamma = (t_beam + fBeamMass + fTargetMass) / sqrt_s;
+        const Double_t beta_gamma = TMath::Sqrt(t_beam * t_beam + 2.0 * t_beam * fBeamMass) / sqrt_s;
+        for (Int_t i = 0; i <= ntheta; i++) {
+            const Double_t theta_cm = TMath::Pi() * i / ntheta;
+            const Double_t pz = gamma * p_cm * TMath::Cos(theta_cm) + beta_gamma * e_cm;
+            const Double_t theta_lab = TMath::ATan2(p_cm * TMath::Sin(theta_cm), pz);
+            for (const auto &range : lab_theta) {
+                if (range.first <= theta_lab && theta_lab <= range.second) {
+                    imin = std::min(imin, i);
+                    imax = std::max(imax, i);
+                    break;
+                }
+            }
+        }
+    }
+    if (nallowed == 0) {
+        SetStateError(Form("ForcedDetection: forbidden kinematics up to the beam energy %lf MeV", 1.1 * fBeamEnergy));
+        return kFALSE;
+    }
+    if (imax < 0) {
+        SetStateError("ForcedDetection: no emission angle reaches the detectors");
+        return kFALSE;
+    }
+    const Double_t theta_lo = TMath::Pi() * std::max(imin - 1, 0) / ntheta;
+    const Double_t theta_hi = TMath::Pi() * std::min(imax + 1, ntheta) / ntheta;
+
+    // convert to id=0 particle: theta_0 = pi - theta_1, phi_0 = phi_1 + pi
+    Double_t cos_lo = TMath::Cos(theta_hi), cos_hi = TMath::Cos(theta_lo);
+    Double_t phi_shift = 0.0;
+    if (id == 1) {
+        cos_lo = -TMath::Cos(theta_lo);
+        cos_hi = -TMath::Cos(theta_hi);
+        phi_shift = TMath::Pi();
+    }
+    fCosUMin = GetCosCDF(cos_lo);
+    fCosUMax = GetCosCDF(cos_hi);
+    if (!(fCosUMax > fCosUMin)) {
+        SetStateError("ForcedDetection: the cross section is zero in the detector cone");
+        return kFALSE;
     }
 
-    TReactionInfo *outReacData = static_cast<TReactionInfo *>(fOutReacData->ConstructedAt(0));
-    outReacData->SetID(0);
-    outReacData->SetExEnergy(fExciteLevel[0]);
-    outReacData->SetEnergy(energy_cm);
-    outReacData->SetTheta(theta_cm);
-    outReacData->SetXYZ(reac_posx, reac_posy, reac_posz);
+    if (!is_full_phi) {
+        // union of the phi ranges in [-pi, pi)
+        std::vector<std::pair<Double_t, Double_t>> ranges;
+        for (const auto &range : lab_phi) {
+            if (range.second - range.first >= TMath::TwoPi()) {
+                is_full_phi = kTRUE;
+                break;
+            }
+            Double_t lo = range.first + phi_shift;
+            Double_t hi = range.second + phi_shift;
+            const Double_t shift = TMath::TwoPi() * std::floor((lo + TMath::Pi()) / TMath::TwoPi());
+            lo -= shift;
+            hi -= shift;
+            if (hi > TMath::Pi()) {
+                ranges.emplace_back(lo, TMath::Pi());
+                ranges.emplace_back(-TMath::Pi(), hi - TMath::TwoPi());
+            } else {
+                ranges.emplace_back(lo, hi);
+            }
+        }
+        if (!is_full_phi) {
+            std::sort(ranges.begin(), ranges.end());
+            fPhiRange.clear();
+            for (const auto &range : ranges) {
+                if (!fPhiRange.empty() && range.first <= fPhiRange.back().second) {
+                    fPhiRange.back().second = std::max(fPhiRange.back().second, range.second);
+                } else {
+                    fPhiRange.emplace_back(range);
+                }
+            }
+            fPhiTotal = 0.0;
+            for (const auto &range : fPhiRange) {
+                fPhiTotal += range.second - range.first;
+            }
+        }
+    }
+
+    fPolarWeight = fCosUMax - fCosUMin;
+    fWeight = fPolarWeight * fPhiTotal / TMath::TwoPi();
+    Info("Init", "ForcedDetection: id=%d, theta_cm %.1lf -- %.1lf deg, %zu phi range(s), weight %lf", id,
+         theta_lo / deg2rad, theta_hi / deg2rad, fPhiRange.size(), fWeight);
+    return kTRUE;
 }
 
-void TNBodyReactionProcessor::InitGeneratingFunc() {
-    gr_generating_func = new TGraph();
-    gr_generating_func_inv = new TGraph();
+/**
+ * @details
+ * From the angular distribution (isotropic if not given), restricted by ForcedDetection.
+ * The weight of the restriction is already in fWeight, so `weight` is not changed.
+ */
+Double_t TNBodyReactionProcessor::SampleCosThetaCM(Double_t, Double_t &) const {
+    const Double_t u = fCosUMin + (fCosUMax - fCosUMin) * gRandom->Uniform();
+    if (fCosTable.empty())
+        return 2.0 * u - 1.0;
+    return EvalTable(fCosTable, u * fGridSize);
+}
+
+Double_t TNBodyReactionProcessor::SamplePhiCM() const {
+    Double_t r = fPhiTotal * gRandom->Uniform();
+    for (const auto &range : fPhiRange) {
+        const Double_t width = range.second - range.first;
+        if (r <= width) {
+            return range.first + r;
+        }
+        r -= width;
+    }
+    return fPhiRange.back().second;
+}
 
+void TNBodyReactionProcessor::InitGeneratingFunc() {
     // simplize range
     auto get_range = [&](Double_t e) {
         if (fTargetIsGas) {
-            return srim->Range(fBeamNucleus[0], fBeamNucleus[1], e, std::string(fTargetName.Data()), fTargetPressure, 300.0);
+            return srim->Range(fBeamNucleus[0], fBeamNucleus[1], e, fTargetNameStr, fTargetPressure, 300.0);
         } else {
-            return srim->Range(fBeamNucleus[0], fBeamNucleus[1], e, std::string(fTargetName.Data()));
+            return srim->Range(fBeamNucleus[0], fBeamNucleus[1], e, fTargetNameStr);
         }
     };
 
@@ -288,20 +737,18 @@ void TNBodyReactionProcessor::InitGeneratingFunc() {
         return 1.0 / dxde;
     };
 
-    auto gr_density_func = new TGraph();
-    Int_t index = 0; // index for TGraph
-    Double_t xmin = 0.0, xmax = 0.0;
+    // (range, density) points, density = cross section * dE/dx
+    std::vector<std::pair<Double_t, Double_t>> density;
     Bool_t is_exist = std::filesystem::exists(fCSDataPath.Data());
-    if (!is_exist) {
+    if (!is_exist && fUniformDepth) {
+        Info("Init", "no input cross section file, use uniform depth distribution");
+        for (auto e = 0.0; e < fBeamEnergy * 1.5; e += 0.5) {
+            density.emplace_back(get_range(e), 1.0);
+        }
+    } else if (!is_exist) {
         Info("Init", "no input cross section file, use uniform energy distribution");
         for (auto e = 0.0; e < fBeamEnergy * 1.5; e += 0.5) {
-            Double_t range = get_range(e);
-            gr_density_func->SetPoint(index, range, dedx(e));
-            index++;
-            xmax = range;
-            if (index == 1) {
-                xmin = range;
-            }
+            density.emplace_back(get_range(e), dedx(e));
         }
     } else {
         std::ifstream fin(fCSDataPath.Data());
@@ -320,72 +767,102 @@ void TNBodyReactionProcessor::InitGeneratingFunc() {
         }
 
         std::string line;
-        std::regex commentRegex("#.*");
         while (std::getline(fin, line)) {
-            if (line.empty() || line[0] == '#') {
+            line = line.substr(0, line.find('#'));
+            std::istringstream iss(line);
+            Double_t e_val = 0.0, cs_val = 0.0;
+            if (!(iss >> e_val >> cs_val)) {
                 continue;
             }
-            line = std::regex_replace(line, commentRegex, "");
-
-            std::vector<TString> values;
-            TString line_copy = line;
-            while (line_copy.Contains(' ')) {
-                Int_t index = line_copy.First(' ');
-                TString line_val, line_remain;
-                line_val = line_copy(0, index);
-                line_remain = line_copy(index + 1, line_copy.Length());
-                line_copy = line_remain;
-                if (line_val == "") {
-                    continue;
-                }
-                values.emplace_back(line_val);
-            }
-            Double_t e = ene_factor * values[0].Atof();
-            Double_t cs = values[1].Atof() / ene_factor;
-            Double_t range = get_range(e);
-            gr_density_func->SetPoint(index, range, cs * dedx(e));
-            index++;
-            xmax = range;
-            if (index == 1) {
-                xmin = range;
-            }
+            Double_t e = ene_factor * e_val;
+            Double_t cs = cs_val / ene_factor;
+            density.emplace_back(get_range(e), cs * dedx(e));
         }
     }
 
-    auto f = new TF1("f", [&](double *x, double *p) { return p[0] * gr_density_func->Eval(x[0], nullptr, "S"); }, xmin, xmax, 1);
-    f->SetParameter(0, 1.0);
-
-    Info("Init", "suppressing the error message in this initialization process");
-    Info("Init", "please wait for a moment...");
+    if (density.size() < 2) {
+        SetStateError("at least 2 points are needed to make the generating function");
+        return;
+    }
+    std::stable_sort(density.begin(), density.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+    // single pass cumulative integration (trapezoidal rule) over the density points,
+    // negative density is treated as 0 so that the generating function is monotone
+    const Int_t npoint = density.size();
+    std::vector<Double_t> gen_range(npoint), gen_value(npoint);
+    Double_t sum = 0.0;
+    for (Int_t i = 0; i < npoint; i++) {
+        if (i > 0) {
+            const Double_t y0 = std::max(density[i - 1].second, 0.0);
+            const Double_t y1 = std::max(density[i].second, 0.0);
+            sum += 0.5 * (y0 + y1) * (density[i].first - density[i - 1].first);
+        }
+        gen_range[i] = density[i].first;
+        gen_value[i] = sum;
+    }
+    if (!(sum > 0.0) || !(gen_range.back() > gen_range.front())) {
+        SetStateError("the generating function is empty, check the cross section file");
+        return;
+    }
+    if (fGridSize < 2) {
+        SetStateError("SamplingGridSize should be >= 2");
+        return;
+    }
 
-    // suppress error message when calculating the integral value
-    __attribute__((unused)) auto *_dev_null = std::freopen("/dev/null", "w", stderr);
-    index = 0;
-    Double_t x_step = (xmax - xmin) / 1000.0; // 1000 steps
-    for (auto x = xmin; x < xmax; x += x_step) {
-        gr_generating_func->SetPoint(index, x, f->Integral(xmin, x));
-        gr_generating_func_inv->SetPoint(index, f->Integral(xmin, x), x);
-        index++;
+    // resample the generating function and its inverse on uniform grids (O(1) lookup)
+    fGenTable.resize(fGridSize + 1);
+    fGenMin = gen_range.front();
+    fGenStep = (gen_range.back() - gen_range.front()) / fGridSize;
+    Int_t seg = 0;
+    for (Int_t k = 0; k <= fGridSize; k++) {
+        const Double_t x = fGenMin + k * fGenStep;
+        while (seg < npoint - 2 && gen_range[seg + 1] < x) {
+            seg++;
+        }
+        const Double_t dx = gen_range[seg + 1] - gen_range[seg];
+        const Double_t t = dx > 0.0 ? std::clamp((x - gen_range[seg]) / dx, 0.0, 1.0) : 1.0;
+        fGenTable[k] = gen_value[seg] + t * (gen_value[seg + 1] - gen_value[seg]);
     }
-    __attribute__((unused)) auto *_dev_tty = std::freopen("/dev/tty", "w", stderr);
 
+    fInvStep = sum / fGridSize;
+    FillInverseTable(gen_range, gen_value, fGridSize, fInvTable);
+
+    Info("Init", "generating function: %d points, range %lf -- %lf mm, %d bins", npoint, gen_range.front(),
+         gen_range.back(), fGridSize);
     Info("Init", "total cross section (arbitrary unit or mb)");
-    Info("Init", "\t%lf", gr_generating_func->Eval(get_range(fBeamEnergy), nullptr, "S"));
+    Info("Init", "\t%lf", EvalGeneratingFunc(get_range(fBeamEnergy)));
+}
+
+Double_t TNBodyReactionProcessor::EvalGeneratingFunc(Double_t range) const {
+    return EvalTable(fGenTable, (range - fGenMin) / fGenStep);
+}
+
+Double_t TNBodyReactionProcessor::InvertGeneratingFunc(Double_t value) const {
+    return EvalTable(fInvTable, value / fInvStep);
+}
+
+/**
+ * @details
+ * The generating function is truncated to [range - thickness, range]
+ * (or [0, range] if the beam stops in the target) and sampled with the inverse table.
+ */
+Double_t TNBodyReactionProcessor::GetDistance(Double_t range, Double_t random) const {
+    const Double_t max_x = EvalGeneratingFunc(range);
+    const Double_t min_x = range < fTargetThickness ? 0.0 : EvalGeneratingFunc(range - fTargetThickness);
+    return range - InvertGeneratingFunc(min_x + (max_x - min_x) * random);
 }
 
 Double_t TNBodyReactionProcessor::GetRandomReactionDistance(Double_t range) {
-    Double_t random_x = 0.0;
-    Double_t max_x = gr_generating_func->Eval(range, nullptr, "S");
-    if (range < fTargetThickness) {
-        random_x = max_x * gRandom->Uniform();
-    } else {
-        Double_t limit_range = range - fTargetThickness;
-        Double_t min_x = gr_generating_func->Eval(limit_range, nullptr, "S");
-        random_x = gRandom->Uniform(min_x, max_x);
-    }
-    Double_t distance = gr_generating_func_inv->Eval(random_x, nullptr, "S");
+    return GetDistance(range, gRandom->Uniform());
+}
 
-    return range - distance;
+void TNBodyReactionProcessor::GetRandomReactionDistance(const Double_t *range, Double_t *distance, Int_t n) {
+    // fill the random numbers first, then convert them in a plain loop
+    gRandom->RndmArray(n, distance);
+    for (Int_t i = 0; i < n; i++) {
+        distance[i] = GetDistance(range[i], distance[i]);
+    }
 }
 
 TLorentzVector TNBodyReactionProcessor::GetLossEnergyVector(TLorentzVector vec, Double_t eloss) {
@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 13:11:23
- * @note    last modified: 2025-01-08 10:35:04
+ * @note    last modified: 2026-10-18 22:21:08
  * @details
  */
 
@@ -11,7 +11,6 @@
 #define _CRIB_TNBODYREACTIONPROCESSOR_H_
 
 #include <TGenPhaseSpace.h>
-#include <TGraph.h>
 #include <TProcessor.h>
 #include <TSrim.h> // TSrim library
 
@@ -28,6 +27,14 @@ class art::crib::TNBodyReactionProcessor : public TProcessor {
 
     void Init(TEventCollection *col) override;
     void Process() override;
+    void PostLoop() override;
+
+    /**
+     * @brief batch version of GetRandomReactionDistance
+     * @param (range) ranges of the beams (n elements)
+     * @param (distance) output, distances of the beam travel before the reaction (n elements)
+     */
+    void GetRandomReactionDistance(const Double_t *range, Double_t *distance, Int_t n);
 
   protected:
     TString fInputColName;
@@ -54,14 +61,42 @@ class art::crib::TNBodyReactionProcessor : public TProcessor {
     DoubleVec_t fExciteLevel;
     TString fCSDataPath;
     Int_t fCSType;
+    TString fAngDistPath; ///< dsigma/dOmega file for two-body reaction
+    Int_t fGridSize;      ///< number of bins of the sampling tables
 
-    TGenPhaseSpace event;
+    TGenPhaseSpace event; /// used for N >= 3
 
     TSrim *srim; /// SRIM table
 
+    /// @brief masses (MeV) and two-body constants cached at Init
+    Double_t fBeamMass;         //!
+    Double_t fTargetMass;       //!
+    DoubleVec_t fReacMass;      //! including excited energy
+    DoubleVec_t fReacMassGeV;   //! for TGenPhaseSpace
+    Double_t fTwoBodySum2;      //! (m0 + m1)^2, threshold of s
+    Double_t fTwoBodyDiff2;     //! (m0 - m1)^2
+    std::string fTargetNameStr; //! target name for TSrim
+
+    /// @brief forced detection (importance sampling of the emission angle)
+    Int_t fForcedID;                ///< id of the particle to be detected, -1: off
+    Double_t fForcedMargin;         ///< margin of the detector cone (deg)
+    TString fDetectorParameterName; ///< detector parameter from TUserGeoInitializer
+    TClonesArray **fDetectorPrm;    //!
+
     const Double_t deg2rad = TMath::DegToRad();
     const Double_t c = 299.792458; // mm/ns
 
+    /**
+     * @brief samples cos(theta_cm) of id=0 particle for two-body reaction
+     * @param (energy_cm) CM energy of the event (MeV)
+     * @param (weight) event weight, multiplied by the weight of the sampling
+     */
+    virtual Double_t SampleCosThetaCM(Double_t energy_cm, Double_t &weight) const;
+
+    /// @brief without CrossSectionPath, draw the reaction depth uniformly in distance
+    /// instead of uniformly in energy (for the classes weighting the events by the cross section)
+    Bool_t fUniformDepth = false; //!
+
   private:
     //! 1. cross section function:    (x, y) = (beam LAB energy (MeV), arbitrary unit)
     //! 2. convert x using range:     (x, y) = (range (mm), arbitrary unit)
@@ -69,9 +104,37 @@ class art::crib::TNBodyReactionProcessor : public TProcessor {
     //! 4. inversed 3. function:      (x, y) = (arbitrary unit, range (mm))
     //! 5. get pos with random number: uniform X -> get Y value
     //! 6. get reac pos with the Y value: init_range - Y => distance
-    TGraph *gr_generating_func;     //! 3. function
-    TGraph *gr_generating_func_inv; //! 4. function
-    void InitGeneratingFunc(void);  //! read from data file and set 3. 4. functions
+    //! 3. and 4. are tabulated on uniform grids and evaluated by linear interpolation
+    std::vector<Double_t> fGenTable; //! 3. function, fGenTable[k] at range fGenMin + k * fGenStep
+    std::vector<Double_t> fInvTable; //! 4. function, fInvTable[k] at k * fInvStep
+    Double_t fGenMin;                //!
+    Double_t fGenStep;               //!
+    Double_t fInvStep;               //!
+    void InitGeneratingFunc(void);   //! read from data file and set 3. 4. functions
+    Double_t EvalGeneratingFunc(Double_t range) const;
+    Double_t InvertGeneratingFunc(Double_t value) const;
+    Double_t GetDistance(Double_t range, Double_t random) const;
+
+    /// @brief inverse of the cos(theta_cm) distribution of id=0 particle, empty for isotropic
+    std::vector<Double_t> fCosTable; //!
+    Bool_t InitAngularDistribution();
+    Double_t GetCosCDF(Double_t cos) const;
+
+    /// @brief sampling region of id=0 particle, the whole solid angle if ForcedDetection is off
+    Double_t fCosUMin = 0.0;                               //! range of the cumulative probability of cos
+    Double_t fCosUMax = 1.0;                               //!
+    std::vector<std::pair<Double_t, Double_t>> fPhiRange; //! phi ranges (rad) in [-pi, pi]
+    Double_t fPhiTotal = 0.0;                              //!
+    Double_t fWeight = 1.0;                                //! event weight
+    Double_t fPolarWeight = 1.0;                           //! weight of the theta_cm sampling
+    Double_t fEventWeight = 1.0;                           //! weight of the current event
+    Long64_t fNForbidden = 0;                              //! events below the threshold
+    Bool_t InitForcedDetection();
+    Double_t SamplePhiCM() const;
+    void CountForbidden();
+
+    void FillParticle(Int_t iPart, const TLorentzVector &reac_vec, Double_t theta_cm, Double_t phi_cm,
+                      const TVector3 &reac_pos, Double_t reac_distance, Double_t duration_beam);
 
     /**
      * @fn random generator
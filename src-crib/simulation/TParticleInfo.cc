@@ -3,7 +3,7 @@
  * @brief   particle information class
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-05-08 18:07:50
- * @note    last modified: 2024-08-23 21:17:03
+ * @note    last modified: 2026-10-18 16:02:47
  * @details
  */
 
@@ -18,7 +18,7 @@ ClassImp(TParticleInfo);
 TParticleInfo::TParticleInfo()
     : fMassNumber(kInvalidI), fAtomicNumber(kInvalidI), fCharge(kInvalidI),
       fEnergy(kInvalidD), fCurrentZ(kInvalidD), fTime(kInvalidD),
-      fTheta_cm(kInvalidD), fPhi_cm(kInvalidD) {
+      fTheta_cm(kInvalidD), fPhi_cm(kInvalidD), fWeight(1.0) {
     TDataObject::SetID(kInvalidI);
     SetTrack(0., 0., 0., 0., 0.);
     fVec.SetXYZT(0., 0., 0., 0.);
@@ -37,7 +37,8 @@ TParticleInfo::TParticleInfo(const TParticleInfo &rhs)
       fTrack(rhs.fTrack),
       fVec(rhs.fVec),
       fTheta_cm(rhs.fTheta_cm),
-      fPhi_cm(rhs.fPhi_cm) {
+      fPhi_cm(rhs.fPhi_cm),
+      fWeight(rhs.fWeight) {
 }
 
 TParticleInfo &TParticleInfo::operator=(const TParticleInfo &rhs) {
@@ -61,6 +62,7 @@ void TParticleInfo::Copy(TObject &dest) const {
     cobj.fVec = this->GetLorentzVector();
     cobj.fTheta_cm = this->GetThetaCM();
     cobj.fPhi_cm = this->GetPhiCM();
+    cobj.fWeight = this->GetWeight();
 }
 
 void TParticleInfo::Clear(Option_t *opt) {
@@ -75,6 +77,7 @@ void TParticleInfo::Clear(Option_t *opt) {
     fTime = kInvalidD;
     fTheta_cm = kInvalidD;
     fPhi_cm = kInvalidD;
+    fWeight = 1.0;
 
     SetTrack(0., 0., 0., 0., 0.);
     fVec.SetXYZT(0., 0., 0., 0.);
@@ -3,7 +3,7 @@
  * @brief   particle information class
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-05-08 18:07:32
- * @note    last modified: 2025-01-08 10:35:12
+ * @note    last modified: 2026-10-18 16:02:47
  * @details
  */
 
@@ -60,6 +60,9 @@ class art::crib::TParticleInfo : public TDataObject {
     void SetPhiCM(Double_t val) { fPhi_cm = val; }
     Double_t GetPhiCM() const { return fPhi_cm; }
 
+    void SetWeight(Double_t val) { fWeight = val; }
+    Double_t GetWeight() const { return fWeight; }
+
     void Copy(TObject &dest) const override;
     void Clear(Option_t *opt = "") override;
 
@@ -78,7 +81,9 @@ class art::crib::TParticleInfo : public TDataObject {
     Double_t fTheta_cm; // theta angle (deg) in CM system
     Double_t fPhi_cm;   // phi angle (deg) in CM system
 
-    ClassDefOverride(TParticleInfo, 1);
+    Double_t fWeight; // importance sampling weight (1 if not biased)
+
+    ClassDefOverride(TParticleInfo, 2);
 };
 
 #endif // end of #ifndef _TPARTICLEINFO_H_
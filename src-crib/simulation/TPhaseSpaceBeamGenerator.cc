@@ -0,0 +1,193 @@
+/**
+ * @file    TPhaseSpaceBeamGenerator.cc
+ * @brief   Beam generator sampling the measured beam phase space
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 17:52:30
+ * @note    last modified: 2026-10-18 17:52:30
+ * @details
+ */
+
+#include "TPhaseSpaceBeamGenerator.h"
+
+#include "TBeamPhaseSpace.h"
+#include "TParticleInfo.h"
+#include <Mass.h> // TSrim library
+#include <TArtemisUtil.h>
+#include <TFile.h>
+#include <TRandom.h>
+#include <TSystem.h>
+#include <TTree.h>
+
+#include <memory>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TPhaseSpaceBeamGenerator);
+
+namespace art::crib {
+
+TPhaseSpaceBeamGenerator::TPhaseSpaceBeamGenerator() {
+    RegisterOutputCollection("OutputCollection", "simulation result collection", fOutputColName, TString("beam"));
+    RegisterOutputCollection("OutputTrackCollection", "simulation tracking information", fOutputTrackColName,
+                             TString("track"));
+
+    RegisterProcessorParameter("MassNum", "beam mass number", fMassNum, 0);
+    RegisterProcessorParameter("AtomicNum", "beam atomic number", fAtmNum, 0);
+    RegisterProcessorParameter("ChargeNum", "beam charge number", fChargeNum, 0);
+    RegisterProcessorParameter("IniEnergy", "beam energy (MeV)", fBeamEnergy, 100.0);
+    RegisterProcessorParameter("Esigma", "dispersion of beam energy (MeV)", fEsigma, 1.0);
+
+    RegisterProcessorParameter("ModelFile", "ROOT file of the beam phase space model", fModelFile, TString(""));
+    RegisterOptionalParameter("ModelName", "object name of the model", fModelName, TString("beam_phase_space"));
+    RegisterOptionalParameter("TrackFile", "track file used to build the model", fTrackFile, TString(""));
+    RegisterOptionalParameter("TreeName", "tree name of the track file", fTreeName, TString("tree"));
+    RegisterOptionalParameter("TrackBranch", "TClonesArray of art::TTrack", fTrackBranch, TString("f3ppac"));
+    RegisterOptionalParameter("MaxPoints", "max number of the points in the model", fMaxPoints, 100000);
+    RegisterOptionalParameter("BandwidthScale", "kernel width relative to Silverman's rule (0: resampling)",
+                              fBandwidthScale, 1.0);
+    RegisterOptionalParameter("BatchSize", "number of the samples generated at once", fBatchSize, 1);
+}
+
+TPhaseSpaceBeamGenerator::~TPhaseSpaceBeamGenerator() {
+    delete fOutData;
+    fOutData = nullptr;
+    delete fOutTrackData;
+    fOutTrackData = nullptr;
+    delete fModel;
+    fModel = nullptr;
+}
+
+void TPhaseSpaceBeamGenerator::Init(TEventCollection *col) {
+    Info("Init", "making => %s, %s", fOutputColName.Data(), fOutputTrackColName.Data());
+
+    /// using TSrim library
+    fMass = amdc::Mass(fAtmNum, fMassNum) * amdc::amu; // MeV
+    Info("Init", "beam: (Z, A, M) = (%d, %d, %.5lf)", fAtmNum, fMassNum, fMass / amdc::amu);
+
+    if (!LoadModel()) {
+        return;
+    }
+    Info("Init", "model: %d points, bandwidth %.3lf", fModel->GetN(), fModel->GetBandwidth());
+    Info("Init", "\tX = %.2lf +- %.2lf mm, Y = %.2lf +- %.2lf mm", fModel->GetMean(0), fModel->GetSigma(0),
+         fModel->GetMean(1), fModel->GetSigma(1));
+    Info("Init", "\tA = %.2lf +- %.2lf mrad, B = %.2lf +- %.2lf mrad", 1e3 * fModel->GetMean(2),
+         1e3 * fModel->GetSigma(2), 1e3 * fModel->GetMean(3), 1e3 * fModel->GetSigma(3));
+
+    if (fBatchSize < 1) {
+        fBatchSize = 1;
+    }
+    fBuffer.resize(static_cast<std::size_t>(fBatchSize) * TBeamPhaseSpace::kDim);
+    fBufferPos = fBatchSize; // empty
+
+    fOutData = new TClonesArray("art::crib::TParticleInfo");
+    fOutData->SetName(fOutputColName);
+    col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+
+    fOutTrackData = new TClonesArray("art::TTrack");
+    fOutTrackData->SetName(fOutputTrackColName);
+    col->Add(fOutputTrackColName, fOutTrackData, fOutputIsTransparent);
+}
+
+/**
+ * @details
+ * Reads the model from ModelFile, or builds it from TrackFile and saves it.
+ */
+Bool_t TPhaseSpaceBeamGenerator::LoadModel() {
+    delete fModel;
+    fModel = nullptr;
+
+    if (fModelFile != "" && !gSystem->AccessPathName(fModelFile)) {
+        std::unique_ptr<TFile> file(TFile::Open(fModelFile));
+        if (file && !file->IsZombie()) {
+            auto *model = dynamic_cast<TBeamPhaseSpace *>(file->Get(fModelName));
+            if (model) {
+                fModel = static_cast<TBeamPhaseSpace *>(model->Clone());
+                Info("Init", "model is loaded from %s", fModelFile.Data());
+                return kTRUE;
+            }
+        }
+        SetStateError(Form("%s is not found in %s", fModelName.Data(), fModelFile.Data()));
+        return kFALSE;
+    }
+
+    if (fTrackFile == "") {
+        SetStateError(Form("model file %s does not exist and TrackFile is not given", fModelFile.Data()));
+        return kFALSE;
+    }
+    std::unique_ptr<TFile> file(TFile::Open(fTrackFile));
+    if (!file || file->IsZombie()) {
+        SetStateError(Form("cannot open %s", fTrackFile.Data()));
+        return kFALSE;
+    }
+    auto *tree = dynamic_cast<TTree *>(file->Get(fTreeName));
+    if (!tree) {
+        SetStateError(Form("tree %s is not found in %s", fTreeName.Data(), fTrackFile.Data()));
+        return kFALSE;
+    }
+    fModel = new TBeamPhaseSpace(fModelName, Form("beam phase space of %s", fTrackFile.Data()));
+    if (fModel->Build(tree, fTrackBranch, fMaxPoints, fBandwidthScale) < 2) {
+        SetStateError(Form("not enough tracks in %s:%s", fTrackFile.Data(), fTrackBranch.Data()));
+        return kFALSE;
+    }
+    file->Close();
+
+    if (fModelFile != "") {
+        Util::PrepareDirectoryFor(fModelFile);
+        std::unique_ptr<TFile> out(TFile::Open(fModelFile, "recreate"));
+        if (out && !out->IsZombie()) {
+            out->WriteTObject(fModel, fModelName);
+            Info("Init", "model is saved in %s", fModelFile.Data());
+        } else {
+            Warning("Init", "cannot write %s, the model is not saved", fModelFile.Data());
+        }
+    }
+    return kTRUE;
+}
+
+void TPhaseSpaceBeamGenerator::Process() {
+    fOutData->Clear("C");
+    fOutTrackData->Clear("C");
+
+    if (fBufferPos >= fBatchSize) {
+        if (fBatchSize == 1) {
+            fModel->Sample(fBuffer.data());
+        } else {
+            fModel->Sample(fBatchSize, fBuffer.data());
+        }
+        fBufferPos = 0;
+    }
+    const Double_t *xyab = &fBuffer[static_cast<std::size_t>(fBufferPos++) * TBeamPhaseSpace::kDim];
+    const Double_t posx = xyab[0];
+    const Double_t posy = xyab[1];
+    const Double_t angx = xyab[2];
+    const Double_t angy = xyab[3];
+    const Double_t energy = gRandom->Gaus(fBeamEnergy, fEsigma);
+
+    TParticleInfo *outData = static_cast<TParticleInfo *>(fOutData->ConstructedAt(0));
+    outData->SetMassNumber(fMassNum);
+    outData->SetAtomicNumber(fAtmNum);
+    outData->SetCharge(fChargeNum);
+
+    Double_t beta = TMath::Sqrt(1.0 - TMath::Power(fMass / (fMass + energy), 2)); // kinematics
+    Double_t norm =
+        TMath::Sqrt(TMath::Tan(angx) * TMath::Tan(angx) + TMath::Tan(angy) * TMath::Tan(angy) + 1.0); // kinematics
+    Double_t beta_x = beta * TMath::Tan(angx) / norm;
+    Double_t beta_y = beta * TMath::Tan(angy) / norm;
+    Double_t beta_z = beta * 1.0 / norm;
+
+    TLorentzVector beam(0., 0., 0., fMass);
+    beam.Boost(beta_x, beta_y, beta_z);
+
+    outData->SetID(0);
+    outData->SetLorentzVector(beam);
+    outData->SetEnergy(energy);
+    outData->SetCurrentZ(0.);
+    outData->SetZeroTime();
+    outData->SetTrack(posx, posy, 0., angx, angy);
+
+    TTrack *outTrackData = static_cast<TTrack *>(fOutTrackData->ConstructedAt(0));
+    outTrackData->SetID(0);
+    outTrackData->SetPos(posx, posy, 0.);
+    outTrackData->SetAngle(angx, angy);
+}
+
+} // namespace art::crib
@@ -0,0 +1,102 @@
+/**
+ * @file    TPhaseSpaceBeamGenerator.h
+ * @brief   Beam generator sampling the measured beam phase space
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 17:52:30
+ * @note    last modified: 2026-10-18 17:52:30
+ * @details
+ */
+
+#ifndef CRIB_TPHASESPACEBEAMGENERATOR_H_
+#define CRIB_TPHASESPACEBEAMGENERATOR_H_
+
+#include <TProcessor.h>
+
+#include <vector>
+
+class TClonesArray;
+
+namespace art::crib {
+class TBeamPhaseSpace;
+
+/**
+ * @class TPhaseSpaceBeamGenerator
+ * @brief Generates the beam from a TBeamPhaseSpace model instead of replaying a track tree.
+ *
+ * The model is loaded from ModelFile if it exists. Otherwise it is built from
+ * the track branch of TrackFile once and saved to ModelFile, so the following runs
+ * do not read the track file. The outputs are the same as art::crib::TRandomBeamGenerator
+ * (beam particle and track), and it is used with art::TRandomNumberEventStore.
+ *
+ * With BatchSize > 1, the samples are generated in blocks. The random sequence of an event
+ * then depends on the block, so keep BatchSize: 1 with art::crib::TEventSeedProcessor.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: beam_generator
+ *     type: art::crib::TPhaseSpaceBeamGenerator
+ *     parameter:
+ *       OutputCollection: beam
+ *       OutputTrackCollection: track
+ *       MassNum: 26
+ *       AtomicNum: 14
+ *       ChargeNum: 14
+ *       IniEnergy: 55.36  # [Double_t] MeV
+ *       Esigma: 1.7  # [Double_t] MeV
+ *       TrackFile: output/run/beam.root  # [TString] used only when the model is built
+ *       TreeName: tree
+ *       TrackBranch: f3ppac
+ *       ModelFile: prm/beam/si26.model.root  # [TString] saved model
+ *       MaxPoints: 100000  # [Int_t] points kept in the model
+ *       BandwidthScale: 1.0  # [Double_t] kernel width relative to Silverman's rule
+ *       BatchSize: 1  # [Int_t] number of samples generated at once
+ * ```
+ */
+class TPhaseSpaceBeamGenerator : public TProcessor {
+  public:
+    TPhaseSpaceBeamGenerator();
+    ~TPhaseSpaceBeamGenerator() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+
+  private:
+    TString fOutputColName;
+    TString fOutputTrackColName;
+    TClonesArray *fOutData{nullptr};      //!
+    TClonesArray *fOutTrackData{nullptr}; //!
+
+    Int_t fMassNum;
+    Int_t fAtmNum;
+    Int_t fChargeNum;
+    Double_t fBeamEnergy;
+    Double_t fEsigma;
+    Double_t fMass{0.0}; //! beam particle mass (MeV)
+
+    TString fTrackFile;
+    TString fTreeName;
+    TString fTrackBranch;
+    TString fModelFile;
+    TString fModelName;
+    Int_t fMaxPoints;
+    Double_t fBandwidthScale;
+    Int_t fBatchSize;
+
+    TBeamPhaseSpace *fModel{nullptr}; //!
+    std::vector<Double_t> fBuffer;    //! (X, Y, A, B) of the block
+    Int_t fBufferPos{0};              //!
+
+    Bool_t LoadModel();
+
+    // Copy constructor (prohibited)
+    TPhaseSpaceBeamGenerator(const TPhaseSpaceBeamGenerator &rhs) = delete;
+    // Assignment operator (prohibited)
+    TPhaseSpaceBeamGenerator &operator=(const TPhaseSpaceBeamGenerator &rhs) = delete;
+
+    ClassDefOverride(TPhaseSpaceBeamGenerator, 1);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TPHASESPACEBEAMGENERATOR_H_
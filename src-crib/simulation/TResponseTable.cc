@@ -0,0 +1,61 @@
+/**
+ * @file    TResponseTable.cc
+ * @brief   Tabulated vector-valued function of two variables
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 15:38:04
+ * @note    last modified: 2026-10-18 15:38:04
+ * @details
+ */
+
+#include "TResponseTable.h"
+
+#include <algorithm>
+
+namespace art::crib {
+
+void TResponseTable::Build(Int_t nout, Double_t xmin, Double_t xmax, Int_t nx, Double_t ymin, Double_t ymax,
+                           Int_t ny, const Func_t &func) {
+    fNOut = nout;
+    fNx = std::max(nx, 1);
+    fNy = std::max(ny, 1);
+    fXmin = xmin;
+    fXmax = xmax;
+    fXstep = (xmax - xmin) / fNx;
+    fYmin = ymin;
+    fYmax = ymax;
+    fYstep = (ymax - ymin) / fNy;
+
+    fData.assign(static_cast<std::size_t>(fNx + 1) * (fNy + 1) * fNOut, 0.0);
+    for (Int_t ix = 0; ix <= fNx; ix++) {
+        for (Int_t iy = 0; iy <= fNy; iy++) {
+            func(fXmin + ix * fXstep, fYmin + iy * fYstep, &fData[(ix * (fNy + 1) + iy) * fNOut]);
+        }
+    }
+}
+
+Bool_t TResponseTable::Eval(Double_t x, Double_t y, Double_t *out) const {
+    if (fData.empty() || !(x >= fXmin && x <= fXmax) || !(y >= fYmin && y <= fYmax))
+        return kFALSE;
+
+    const Double_t tx = (x - fXmin) / fXstep;
+    const Double_t ty = (y - fYmin) / fYstep;
+    const Int_t ix = std::min(static_cast<Int_t>(tx), fNx - 1);
+    const Int_t iy = std::min(static_cast<Int_t>(ty), fNy - 1);
+    const Double_t fx = tx - ix;
+    const Double_t fy = ty - iy;
+
+    const Double_t *const p00 = &fData[(ix * (fNy + 1) + iy) * fNOut];
+    const Double_t *const p01 = p00 + fNOut;
+    const Double_t *const p10 = p00 + (fNy + 1) * fNOut;
+    const Double_t *const p11 = p10 + fNOut;
+    const Double_t w00 = (1.0 - fx) * (1.0 - fy);
+    const Double_t w01 = (1.0 - fx) * fy;
+    const Double_t w10 = fx * (1.0 - fy);
+    const Double_t w11 = fx * fy;
+    for (Int_t k = 0; k < fNOut; k++) {
+        out[k] = w00 * p00[k] + w01 * p01[k] + w10 * p10[k] + w11 * p11[k];
+    }
+    return kTRUE;
+}
+
+} // namespace art::crib
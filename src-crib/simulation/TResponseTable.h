@@ -0,0 +1,59 @@
+/**
+ * @file    TResponseTable.h
+ * @brief   Tabulated vector-valued function of two variables
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 15:38:04
+ * @note    last modified: 2026-10-18 15:38:04
+ * @details
+ */
+
+#ifndef CRIB_TRESPONSETABLE_H_
+#define CRIB_TRESPONSETABLE_H_
+
+#include <Rtypes.h>
+
+#include <functional>
+#include <vector>
+
+namespace art::crib {
+/**
+ * @class TResponseTable
+ * @brief f(x, y) -> (out[0], ..., out[n-1]) on a uniform grid with bilinear interpolation.
+ *
+ * Used by TDetectParticleProcessor to replace the energy loss calculation:
+ * (incident energy, cos of the incident angle) -> (deposit of each layer, residual energy),
+ * and (energy, distance) -> (residual energy) in the gas target.
+ */
+class TResponseTable {
+  public:
+    /// @brief function to be tabulated, fills `out` (GetNOutput() elements)
+    using Func_t = std::function<void(Double_t x, Double_t y, Double_t *out)>;
+
+    TResponseTable() = default;
+
+    /**
+     * @brief Evaluates `func` at (nx + 1) x (ny + 1) grid points.
+     */
+    void Build(Int_t nout, Double_t xmin, Double_t xmax, Int_t nx, Double_t ymin, Double_t ymax, Int_t ny,
+               const Func_t &func);
+
+    Bool_t IsBuilt() const { return !fData.empty(); }
+    Int_t GetNOutput() const { return fNOut; }
+
+    /**
+     * @brief Bilinear interpolation.
+     * @return kFALSE if (x, y) is outside of the table (`out` is not filled)
+     */
+    Bool_t Eval(Double_t x, Double_t y, Double_t *out) const;
+
+  private:
+    Int_t fNOut{0};
+    Int_t fNx{0}, fNy{0};
+    Double_t fXmin{0.}, fXmax{0.}, fXstep{1.};
+    Double_t fYmin{0.}, fYmax{0.}, fYstep{1.};
+    /// fData[(ix * (fNy + 1) + iy) * fNOut + k]
+    std::vector<Double_t> fData;
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TRESPONSETABLE_H_
@@ -0,0 +1,86 @@
+/**
+ * @file    TRutherfordScattering.cc
+ * @brief   elastic scattering generator following the Rutherford cross section
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 18:12:40
+ * @note    last modified: 2026-10-18 22:21:08
+ * @details
+ */
+
+#include "TRutherfordScattering.h"
+
+#include <TRandom.h>
+
+using art::crib::TRutherfordScattering;
+
+ClassImp(TRutherfordScattering);
+
+namespace {
+constexpr Double_t kCoulombConst = 1.439964; // e^2 / (4 pi epsilon_0) (MeV fm)
+constexpr Double_t kFm2ToMb = 10.0;          // 1 fm^2 = 10 mb
+} // namespace
+
+TRutherfordScattering::TRutherfordScattering()
+    : fInvXMin(0.0), fInvXDiff(0.0), fCoulomb(0.0) {
+    RegisterProcessorParameter("ThetaMin", "minimum theta_cm of the scattered beam (deg)", fThetaMin, 5.0);
+    RegisterProcessorParameter("ThetaMax", "maximum theta_cm of the scattered beam (deg)", fThetaMax, 175.0);
+}
+
+TRutherfordScattering::~TRutherfordScattering() = default;
+
+void TRutherfordScattering::Init(TEventCollection *col) {
+    if (fBeamNucleus.size() != 2) {
+        SetStateError("fBeamNucleus format need (Z, A): ex (2, 4)");
+        return;
+    }
+    if (!(fThetaMin > 0.0) || !(fThetaMax <= 180.0) || !(fThetaMin < fThetaMax)) {
+        SetStateError("ThetaMin and ThetaMax should be 0 < ThetaMin < ThetaMax <= 180 (deg)");
+        return;
+    }
+    if (fForcedID >= 0) {
+        Warning("Init", "ForcedDetection is not used, the angle is limited by ThetaMin and ThetaMax");
+        fForcedID = -1;
+    }
+    if (fAngDistPath != "") {
+        Warning("Init", "AngularDistributionPath is ignored, Rutherford distribution is used");
+        fAngDistPath = "";
+    }
+    if (fCSDataPath != "") {
+        Warning("Init", "CrossSectionPath is ignored, the events are weighted by the Rutherford cross section");
+        fCSDataPath = "";
+    }
+    fUniformDepth = kTRUE;
+
+    // elastic scattering: id=0 is the scattered beam, id=1 is the recoil
+    fDecayNum = 2;
+    fReacMassNum = {fBeamNucleus[1], fTargetMassNum};
+    fReacAtmNum = {fBeamNucleus[0], fTargetAtmNum};
+    fExciteLevel = {0.0, 0.0};
+
+    TNBodyReactionProcessor::Init(col);
+    if (IsError())
+        return;
+
+    const Double_t sin_min = TMath::Sin(0.5 * fThetaMin * deg2rad);
+    const Double_t sin_max = TMath::Sin(0.5 * fThetaMax * deg2rad);
+    fInvXMin = 1.0 / (sin_min * sin_min);
+    fInvXDiff = fInvXMin - 1.0 / (sin_max * sin_max);
+    fCoulomb = fBeamNucleus[0] * fTargetAtmNum * kCoulombConst;
+
+    const Double_t a = fCoulomb / (fBeamEnergy * fTargetMass / (fBeamMass + fTargetMass));
+    Info("Init", "Rutherford: theta_cm %.1lf -- %.1lf deg, %lf mb at the beam energy %lf MeV", fThetaMin,
+         fThetaMax, TMath::Pi() * a * a / 4.0 * fInvXDiff * kFm2ToMb, fBeamEnergy);
+}
+
+/**
+ * @details
+ * With x = sin^2(theta_cm / 2), dsigma = (pi a^2 / 4) dx / x^2, so the inverse CDF is
+ * 1/x = 1/xmin - u (1/xmin - 1/xmax), and the integrated cross section is (pi a^2 / 4) (1/xmin - 1/xmax).
+ */
+Double_t TRutherfordScattering::SampleCosThetaCM(Double_t energy_cm, Double_t &weight) const {
+    const Double_t a = fCoulomb / energy_cm; // fm
+    weight *= TMath::Pi() * a * a / 4.0 * fInvXDiff * kFm2ToMb;
+
+    const Double_t x = 1.0 / (fInvXMin - gRandom->Uniform() * fInvXDiff);
+    return 1.0 - 2.0 * x;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file    TRutherfordScattering.h
+ * @brief   elastic scattering generator following the Rutherford cross section
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 18:12:40
+ * @note    last modified: 2026-10-18 22:21:08
+ * @details
+ */
+
+#ifndef _CRIB_TRUTHERFORDSCATTERING_H_
+#define _CRIB_TRUTHERFORDSCATTERING_H_
+
+#include "TNBodyReactionProcessor.h"
+
+namespace art::crib {
+class TRutherfordScattering;
+} // namespace art::crib
+
+/**
+ * @class art::crib::TRutherfordScattering
+ * @brief TNBodyReactionProcessor for the elastic scattering with the Rutherford angular distribution
+ *
+ * The reaction position, beam energy loss and output (TParticleInfo, TReactionInfo) are the same as
+ * TNBodyReactionProcessor. The reaction products are fixed to (beam, target) in the ground states,
+ * and theta_cm of id=0 (scattered beam) is sampled in [ThetaMin, ThetaMax] with the inverse CDF
+ * of dsigma/dOmega = (a/4)^2 / sin^4(theta/2), a = Z1 Z2 e^2 / Ecm.
+ * The reaction depth is drawn uniformly in distance (CrossSectionPath is not used) and each event
+ * is weighted by the integrated cross section (mb) in [ThetaMin, ThetaMax] at its Ecm,
+ * so the sum of the weights is proportional to the yield (integral of sigma dx).
+ */
+class art::crib::TRutherfordScattering : public TNBodyReactionProcessor {
+  public:
+    TRutherfordScattering();
+    ~TRutherfordScattering() override;
+
+    void Init(TEventCollection *col) override;
+
+  protected:
+    Double_t SampleCosThetaCM(Double_t energy_cm, Double_t &weight) const override;
+
+  private:
+    Double_t fThetaMin; ///< minimum theta_cm of id=0 particle (deg)
+    Double_t fThetaMax; ///< maximum theta_cm of id=0 particle (deg)
+
+    /// @brief x = sin^2(theta_cm / 2), the distribution is proportional to 1 / x^2
+    Double_t fInvXMin;  //! 1 / x at ThetaMin
+    Double_t fInvXDiff; //! 1 / x(ThetaMin) - 1 / x(ThetaMax)
+    Double_t fCoulomb;  //! Z1 Z2 e^2 (MeV fm)
+
+    TRutherfordScattering(const TRutherfordScattering &rhs) = delete;
+    TRutherfordScattering &operator=(const TRutherfordScattering &rhs) = delete;
+
+    ClassDefOverride(TRutherfordScattering, 1)
+};
+
+#endif // end of #ifndef _CRIB_TRUTHERFORDSCATTERING_H_
@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-01-18 22:37:37
- * @note    last modified: 2024-08-23 21:20:12
+ * @note    last modified: 2026-10-18 21:28:12
  * @details
  */
 
@@ -31,6 +31,22 @@
 /// If we fix the Ecm of the reaction, the reaction point is also fixed.
 /// So with given Ecm, we can calculate the Solid angle by Monte Carlo method.
 ///
+/// ### Forced detection
+///
+/// With `ForcedDetection` of art::crib::TNBodyReactionProcessor, the particles
+/// are emitted only toward the detector cone, and each event has a weight
+/// (probability of the cone in the full solid angle).
+/// The detected histograms are filled with this weight, and the angle
+/// normalization histograms are filled with the weight of the theta_cm sampling,
+/// so that the ratio is the same as the full solid angle sampling with much
+/// fewer events. The bins outside the cone are empty (not detectable).
+///
+/// ### Split jobs
+///
+/// The detected (hit_*) and normalization (norm_*) histograms are also saved,
+/// so that the outputs of split jobs (simparallel.sh) can be added with hadd and the
+/// solid angle recalculated from the sums by macro/solidangle.C.
+///
 
 #include "TSolidAngleProcessor.h"
 
@@ -130,6 +146,11 @@ void TSolidAngleProcessor::Init(TEventCollection *col) {
     h1_e = new TH1D("Ecm", "Ecm", fNbin_energy, fRange_energy[0], fRange_energy[1]);
     h2 = new TH2D("2D", "2D", fNbin_energy, fRange_energy[0], fRange_energy[1],
                   fNbin_angle, fRange_angle[0], fRange_angle[1]);
+
+    // events can be weighted (forced detection)
+    for (TH1 *h : {(TH1 *)h1_a_all, (TH1 *)h1_e_all, (TH1 *)h2_all, (TH1 *)h1_a, (TH1 *)h1_e, (TH1 *)h2}) {
+        h->Sumw2();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -149,17 +170,20 @@ void TSolidAngleProcessor::Process() {
 
     const TDataObject *const inData = static_cast<TDataObject *>((*fInReacData)->At(0));
     const TReactionInfo *const Data = dynamic_cast<const TReactionInfo *>(inData);
-    h1_a_all->Fill(Data->GetTheta());
+    // theta_cm is sampled only in the cone with forced detection
+    const Double_t polar_weight = Data->GetPolarWeight();
+    const Double_t weight = Data->GetWeight();
+    h1_a_all->Fill(Data->GetTheta(), polar_weight);
     h1_e_all->Fill(Data->GetEnergy());
-    h2_all->Fill(Data->GetEnergy(), Data->GetTheta());
+    h2_all->Fill(Data->GetEnergy(), Data->GetTheta(), polar_weight);
 
     // detected of not
     const TDataObject *const inDetData = static_cast<TDataObject *>((*fInData)->At(0));
     const TTelescopeData *const DetData = dynamic_cast<const TTelescopeData *>(inDetData);
     if (DetData->GetTelID() > 0) {
-        h1_a->Fill(Data->GetTheta());
-        h1_e->Fill(Data->GetEnergy());
-        h2->Fill(Data->GetEnergy(), Data->GetTheta());
+        h1_a->Fill(Data->GetTheta(), weight);
+        h1_e->Fill(Data->GetEnergy(), weight);
+        h2->Fill(Data->GetEnergy(), Data->GetTheta(), weight);
     }
 }
 
@@ -176,6 +200,14 @@ void TSolidAngleProcessor::EndOfRun() {
         return;
     }
 
+    // raw counts for merging split jobs
+    for (TH1 *h : {(TH1 *)h1_a, (TH1 *)h1_e, (TH1 *)h2}) {
+        h->Write(Form("hit_%s", h->GetName()));
+    }
+    h1_a_all->Write();
+    h1_e_all->Write();
+    h2_all->Write();
+
     h1_a->Divide(h1_a_all);
     h1_a->Scale(4.0 * TMath::Pi());
     h1_a->SetTitle("Solid Angle;Angle CM (deg);");
@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 11:08:17
- * @note    last modified: 2025-01-08 10:35:36
+ * @note    last modified: 2026-10-18 16:02:47
  * @details
  */
 
@@ -3,12 +3,13 @@
  * @brief
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-06-09 15:57:01
- * @note    last modified: 2025-01-09 21:03:47
+ * @note    last modified: 2026-10-18 17:24:12
  * @details
  */
 
 #include "TTreeBeamGenerator.h"
 
+#include "../TProcessorUtil.h"
 #include "TParticleInfo.h"
 #include <Mass.h> // TSrim library
 #include <TRandom.h>
@@ -40,15 +41,12 @@ void TTreeBeamGenerator::Init(TEventCollection *col) {
     fMass = amdc::Mass(fAtmNum, fMassNum) * amdc::amu; // MeV
     Info("Init", "beam: (Z, A, M) = (%d, %d, %.5lf)", fAtmNum, fMassNum, fMass / amdc::amu);
 
-    fInData = reinterpret_cast<TClonesArray **>(col->GetObjectRef(fInputColName.Data()));
-    if (!fInData) {
-        SetStateError(TString::Format("input not found: %s", fInputColName.Data()));
+    auto result = util::GetInputObject<TClonesArray>(col, fInputColName, "TClonesArray", "art::TTrack");
+    if (std::holds_alternative<TString>(result)) {
+        SetStateError(std::get<TString>(result));
         return;
     }
-    const TClass *const cl = (*fInData)->GetClass();
-    if (!cl->InheritsFrom(art::TTrack::Class())) {
-        SetStateError("contents of input array must inherit from art::TTrack");
-    }
+    fInData = std::get<TClonesArray **>(result);
 
     fOutData = new TClonesArray("art::crib::TParticleInfo");
     fOutData->SetName(fOutputColName);
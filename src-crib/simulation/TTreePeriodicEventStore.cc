@@ -3,29 +3,83 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2023-08-01 22:36:36
- * @note    last modified: 2025-03-04 19:20:39
+ * @note    last modified: 2026-10-18 22:15:27
  * @details just modify the process() from TTreeEventStore to return 0
  */
 
 #include "TTreePeriodicEventStore.h"
 
+#include <TBranchElement.h>
 #include <TChain.h>
+#include <TDirectory.h>
+#include <TEnv.h>
 #include <TEventHeader.h>
 #include <TLeaf.h>
-#include <TObjString.h>
 #include <TSystem.h>
 
+#include <glob.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <sstream>
+
 /// ROOT macro for class implementation
 ClassImp(art::crib::TTreePeriodicEventStore);
 
+namespace {
+/// files matching the whitespace-separated shell patterns, older first (same order as `ls -tr`)
+std::vector<std::string> GlobFiles(const char *patterns) {
+    std::vector<std::string> files;
+    std::istringstream iss(patterns);
+    std::string pattern;
+    while (iss >> pattern) {
+        glob_t result;
+        if (glob(pattern.c_str(), GLOB_TILDE | GLOB_BRACE, nullptr, &result) == 0) {
+            files.insert(files.end(), result.gl_pathv, result.gl_pathv + result.gl_pathc);
+        }
+        globfree(&result);
+    }
+
+    std::vector<std::pair<std::filesystem::file_time_type, std::string>> sorted;
+    for (auto &file : files) {
+        std::error_code ec;
+        sorted.emplace_back(std::filesystem::last_write_time(file, ec), std::move(file));
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    files.clear();
+    for (auto &item : sorted) {
+        files.emplace_back(std::move(item.second));
+    }
+    return files;
+}
+} // namespace
+
 namespace art::crib {
 
 TTreePeriodicEventStore::TTreePeriodicEventStore() {
     RegisterProcessorParameter("FileName", "The name of input file", fFileName, fFileName);
     RegisterProcessorParameter("TreeName", "The name of input tree", fTreeName, fTreeName);
     RegisterProcessorParameter("MaxEventNum", "The maximum event number to be analyzed.", fMaxEventNum, 0L);
+    RegisterOptionalParameter("FirstEventNum", "Global event number of the first event (for split jobs)",
+                              fFirstEventNum, 0L);
+    RegisterOptionalParameter("MemoryBudget", "Max size (MB) of the in-memory copy of the tree (0: not used)",
+                              fMemoryBudget, 512.0);
+    RegisterOptionalParameter("CacheSize", "TTreeCache size (MB) when the tree is read from the files",
+                              fCacheSize, 256.0);
+    RegisterOptionalParameter("AsyncPrefetch", "Prefetch the baskets asynchronously when read from the files",
+                              fAsyncPrefetch, kFALSE);
+    RegisterOptionalParameter("Shuffle", "Replay the entries in a shuffled order (different for each cycle)",
+                              fShuffle, kFALSE);
+    RegisterOptionalParameter("ShuffleSeed", "Seed of the shuffled order", fShuffleSeed, 1L);
+    RegisterOptionalParameter("ActiveBranches", "Branches to be read, every branch used by any processor (empty: all)",
+                              fActiveBranches, StringVec_t());
 }
 TTreePeriodicEventStore::~TTreePeriodicEventStore() {
+    delete fMemTree;
+    fMemTree = nullptr;
     fTree = nullptr;
 }
 
@@ -33,10 +87,12 @@ TTreePeriodicEventStore::~TTreePeriodicEventStore() {
  * @details
  * Init method:
  *  1) Retrieve fCondition from TEventCollection
- *  2) Get file list from shell command
+ *  2) Get file list from the glob pattern (older file first)
  *  3) Build TChain if necessary
  *  4) Set branch addresses (primitive or class objects)
  *  5) Load the first entry and get total entry counts
+ * The branch selection and the memory copy are done in PreLoop,
+ * after all the processors are initialized.
  */
 void TTreePeriodicEventStore::Init(TEventCollection *col) {
     // 1) Get fCondition pointer from TEventCollection (for TLoop control)
@@ -61,9 +117,10 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
     }
 
     // 2) Get the list of files
-    auto filelist = gSystem->GetFromPipe(Form("ls -tr %s", fFileName.Data()));
-    auto *allfiles = filelist.Tokenize("\n");
-    if (!allfiles) {
+    TString patterns = fFileName;
+    gSystem->ExpandPathName(patterns);
+    const auto allfiles = GlobFiles(patterns.Data());
+    if (allfiles.empty()) {
         SetStateError(Form("No files matched '%s'", fFileName.Data()));
         if (fCondition)
             (*fCondition)->Set(TLoop::kStopLoop);
@@ -80,13 +137,13 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
 
     // 3) Build TChain if fTree is not created yet
     if (!fTree) {
+        if (fAsyncPrefetch) {
+            gEnv->SetValue("TFile.AsyncPrefetching", 1);
+        }
         auto *chain = new TChain(fTreeName);
-        for (int i = 0, n = allfiles->GetEntriesFast(); i < n; ++i) {
-            auto *strObj = dynamic_cast<TObjString *>(allfiles->At(i));
-            if (!strObj)
-                continue;
-            Info("Init", "Add '%s'", (strObj->GetString()).Data());
-            chain->Add(strObj->GetString());
+        for (const auto &file : allfiles) {
+            Info("Init", "Add '%s'", file.c_str());
+            chain->Add(file.c_str());
         }
         fTree = chain;
     }
@@ -101,6 +158,8 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
     // Initialize event counters
     fEventNum = 0;
     fCurrentNum = 0;
+    fIsPrepared = kFALSE;
+    fBranchNames.clear();
 
     // 4) Explore each branch and set addresses
     std::vector<TBranch *> useBranch;
@@ -155,34 +214,27 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
             }
             fTree->SetBranchAddress(br->GetName(), *objRef);
             useBranch.emplace_back(br);
+            fBranchNames.emplace_back(br->GetName());
             Info("Init", "branch : %s (type=%s, size=%d)",
                  br->GetName(), TDataType::GetTypeName(dtype), arrSize);
         }
         // Case B: Class type (including TClonesArray)
         else {
-            // Check TClonesArray
+            // Check TClonesArray, the element class is known from the branch without reading
+            TClass *realcls = nullptr;
             if (cl == TClonesArray::Class()) {
-                TClonesArray *arr = nullptr;
-                // Temporarily enable only this branch to check its class info
-                fTree->SetBranchStatus("*", 0);
-                fTree->SetBranchStatus(br->GetName(), 1);
-                fTree->SetBranchAddress(br->GetName(), &arr);
-                fTree->GetEntry(0);
-
-                if (arr) {
-                    TClass *realcls = arr->GetClass();
-                    if (!realcls || !realcls->GetNew()) {
-                        // If the class cannot be instantiated, skip
-                        cl = nullptr;
-                    }
+                auto *brElement = dynamic_cast<TBranchElement *>(br);
+                realcls = brElement ? TClass::GetClass(brElement->GetClonesName()) : nullptr;
+                if (!realcls || !realcls->GetNew()) {
+                    // If the class cannot be instantiated, skip
+                    cl = nullptr;
                 }
-                br->ResetAddress();
             }
 
             // If still valid, create an instance and set address
             if (cl) {
                 // Create a new object of this class
-                auto *obj = static_cast<TObject *>(cl->New());
+                auto *obj = realcls ? new TClonesArray(realcls) : static_cast<TObject *>(cl->New());
                 col->Add(br->GetName(), obj, kTRUE);
 
                 void **tmpRef = col->Get(br->GetName())->GetObjectRef();
@@ -209,10 +261,12 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
                 fTree->SetBranchAddress(br->GetName(), objRef);
 
                 useBranch.emplace_back(br);
+                fBranchNames.emplace_back(br->GetName());
 
                 // If it's TEventHeader, store pointer in fEventHeader
                 if (cl == TEventHeader::Class()) {
                     fEventHeader = static_cast<art::TEventHeader *>(obj);
+                    fHeaderBranchName = br->GetName();
                 }
                 Info("Init", "Branch: %s (class=%s)", br->GetName(), cl->GetName());
             }
@@ -237,6 +291,140 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
     fTreeEventNum = fTree->GetEntries();
 }
 
+/**
+ * @details
+ * PreLoop method: called after Init of all the processors
+ *  1) Disable the branches not in ActiveBranches
+ *  2) Copy the entries to memory, or set TTreeCache
+ *  3) Set the start entry (and the shuffled order)
+ */
+void TTreePeriodicEventStore::PreLoop() {
+    if (fIsPrepared || !fTree || fTreeEventNum <= 0) {
+        return;
+    }
+    fIsPrepared = kTRUE;
+
+    SelectBranches();
+    LoadEntries();
+
+    // a split job starts from the same entry as the single job would read for this event
+    fCycle = fFirstEventNum / fTreeEventNum;
+    fCurrentNum = fFirstEventNum % fTreeEventNum;
+    if (fFirstEventNum > 0) {
+        Info("PreLoop", "start from entry %ld (event %ld)", fCurrentNum, fFirstEventNum);
+    }
+    if (fShuffle) {
+        Shuffle();
+    }
+}
+
+/**
+ * @details
+ * A branch is kept if it is listed in ActiveBranches or it is the event header.
+ * The other processors may take their inputs by `col->GetObjectRef`, which cannot
+ * be seen from here, so nothing is disabled with the empty list.
+ * The saved size per entry is estimated from the current file.
+ */
+void TTreePeriodicEventStore::SelectBranches() {
+    if (fActiveBranches.empty()) {
+        return;
+    }
+    for (const auto &name : fActiveBranches) {
+        if (std::find(fBranchNames.begin(), fBranchNames.end(), name) == fBranchNames.end()) {
+            Warning("PreLoop", "ActiveBranches: branch %s is not in the tree", name.Data());
+        }
+    }
+    Double_t savedTot = 0.0, savedZip = 0.0;
+    Int_t nDisabled = 0;
+    for (const auto &name : fBranchNames) {
+        const Bool_t isUsed = name == fHeaderBranchName ||
+                              std::find(fActiveBranches.begin(), fActiveBranches.end(), name) != fActiveBranches.end();
+        if (isUsed) {
+            Info("PreLoop", "read branch: %s", name.Data());
+            continue;
+        }
+        fTree->SetBranchStatus(name, 0);
+        ++nDisabled;
+        if (auto *br = fTree->GetBranch(name); br && br->GetEntries() > 0) {
+            savedTot += static_cast<Double_t>(br->GetTotBytes("*")) / br->GetEntries();
+            savedZip += static_cast<Double_t>(br->GetZipBytes("*")) / br->GetEntries();
+        }
+        Info("PreLoop", "skip branch: %s", name.Data());
+    }
+    if (nDisabled > 0) {
+        Info("PreLoop", "%d branch(es) disabled, %.0lf bytes/entry (%.0lf bytes/entry compressed) saved", nDisabled,
+             savedTot, savedZip);
+    }
+}
+
+/**
+ * @details
+ * The enabled branches of all entries are copied to a tree without file.
+ * Its baskets stay in memory uncompressed, so the replay does not read
+ * nor decompress the files again. The memory tree shares the branch addresses
+ * with the chain, so the objects in TEventCollection are filled in the same way.
+ * If the copy exceeds MemoryBudget, it is discarded and the chain is read
+ * through a TTreeCache instead.
+ */
+void TTreePeriodicEventStore::LoadEntries() {
+    if (fMemTree) {
+        fTree->GetEntry(0);
+        return;
+    }
+    const Long64_t budget = static_cast<Long64_t>(fMemoryBudget * 1024 * 1024);
+    if (budget > 0) {
+        TTree *memTree = nullptr;
+        {
+            TDirectory::TContext ctx(nullptr); // not attached to any file
+            memTree = fTree->CloneTree(0);
+        }
+        if (memTree) {
+            memTree->SetAutoFlush(0);
+            memTree->SetAutoSave(0);
+            Bool_t isFit = kTRUE;
+            for (Long64_t i = 0; i < fTreeEventNum; ++i) {
+                fTree->GetEntry(i);
+                memTree->Fill();
+                if (memTree->GetTotBytes() > budget) {
+                    isFit = kFALSE;
+                    break;
+                }
+            }
+            if (isFit) {
+                Info("Init", "%lld entries are kept in memory (%.1lf MB)", fTreeEventNum,
+                     memTree->GetTotBytes() / 1024.0 / 1024.0);
+                fMemTree = memTree;
+                fTree = fMemTree;
+                fTree->GetEntry(0);
+                return;
+            }
+            Info("Init", "the tree exceeds MemoryBudget %.0lf MB, read from the files", fMemoryBudget);
+            delete memTree;
+        }
+    }
+
+    const Long64_t cacheSize = static_cast<Long64_t>(fCacheSize * 1024 * 1024);
+    if (cacheSize > 0) {
+        fTree->SetCacheSize(cacheSize);
+        fTree->AddBranchToCache("*", kTRUE);
+        fTree->StopCacheLearningPhase();
+        Info("Init", "TTreeCache %.0lf MB%s", fCacheSize, fAsyncPrefetch ? " with async prefetching" : "");
+    }
+    fTree->GetEntry(0);
+}
+
+/**
+ * @details
+ * The order of a cycle depends only on (ShuffleSeed, cycle number), so that
+ * split jobs read the same entries as the single job.
+ */
+void TTreePeriodicEventStore::Shuffle() {
+    fOrder.resize(fTreeEventNum);
+    std::iota(fOrder.begin(), fOrder.end(), 0);
+    std::mt19937_64 engine(static_cast<ULong64_t>(fShuffleSeed) * 0x9E3779B97F4A7C15ULL + fCycle);
+    std::shuffle(fOrder.begin(), fOrder.end(), engine);
+}
+
 /**
  * @details
  * Process method: called for each event
@@ -246,13 +434,17 @@ void TTreePeriodicEventStore::Init(TEventCollection *col) {
  *  - Stop if reaching fMaxEventNum
  */
 void TTreePeriodicEventStore::Process() {
-    fTree->GetEntry(fCurrentNum);
+    fTree->GetEntry(fOrder.empty() ? fCurrentNum : fOrder[fCurrentNum]);
     ++fCurrentNum;
     ++fEventNum;
 
     // Wrap around if we reach the end of the tree
     if (fCurrentNum == fTreeEventNum) {
         fCurrentNum = 0;
+        ++fCycle;
+        if (fShuffle) {
+            Shuffle();
+        }
     }
     // Stop if we reached the maximum events
     if (fMaxEventNum == fEventNum) {
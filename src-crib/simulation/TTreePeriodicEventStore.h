@@ -3,7 +3,7 @@
  * @brief   Declaration of TTreePeriodicEventStore for periodic event handling in a TTree
  * @author  Kodai Okawa<okawa@cns.s.u-tokyo.ac.jp>
  * @date    2024-07-16 15:16:56
- * @note    last modified: 2025-01-08 20:03:50
+ * @note    last modified: 2026-10-18 22:15:27
  * @details
  */
 
@@ -13,6 +13,8 @@
 #include "IEventStore.h"
 #include "TProcessor.h"
 
+#include <vector>
+
 namespace art {
 class TEventHeader;
 } // namespace art
@@ -29,6 +31,16 @@ namespace art::crib {
  * TTree. The user can configure the input file name, tree name, and number of
  * events to process through various parameters.
  *
+ * The enabled branches are copied once into a tree in memory if they fit in
+ * MemoryBudget, and the following cycles are served from there. Otherwise the
+ * files are read through a TTreeCache of CacheSize. With Shuffle, each cycle
+ * replays the entries in a different random order.
+ *
+ * If ActiveBranches is given, only those branches (and the event header) are read.
+ * The list must contain every branch read by any processor, including the artemis
+ * core processors, histograms and tree output, since a disabled branch keeps the
+ * contents of the first entry. With the empty list, all the branches are read.
+ *
  * ### Example Steering File
  *
  * ```yaml
@@ -36,9 +48,16 @@ namespace art::crib {
  *   - name: MyTTreePeriodicEventStore
  *     type: art::crib::TTreePeriodicEventStore
  *     parameter:
- *       FileName: temp.root  # [TString] The name of input file
+ *       ActiveBranches: []  # [StringVec_t] branches to read, must list every branch any processor reads (empty: all)
+ *       AsyncPrefetch: false  # [Bool_t] prefetch the baskets asynchronously (file reading)
+ *       CacheSize: 256  # [Double_t] TTreeCache size (MB) when the tree is read from the files
+ *       FileName: temp.root  # [TString] The name of input file (space-separated glob patterns are allowed)
+ *       FirstEventNum: 0  # [Long_t] global event number of the first event (for split jobs)
  *       MaxEventNum: 0  # [Long_t] The maximum event number to be analyzed.
+ *       MemoryBudget: 512  # [Double_t] max size (MB) of the in-memory tree (0: not used)
  *       OutputTransparency: 0  # [Bool_t] Output is persistent if false (default)
+ *       Shuffle: false  # [Bool_t] replay the entries in a shuffled order
+ *       ShuffleSeed: 1  # [Long_t] seed of the shuffled order
  *       TreeName: tree  # [TString] The name of input tree
  *       Verbose: 1  # [Int_t] verbose level (default 1 : non quiet)
  * ```
@@ -69,6 +88,11 @@ class TTreePeriodicEventStore : public TProcessor, public IEventStore {
      */
     void Process() override;
 
+    /**
+     * @brief Selects the branches to be read and prepares the replay, after all processors are initialized.
+     */
+    void PreLoop() override;
+
     /**
      * @brief Returns the run number of the current event.
      * @return The run number if available, otherwise 0.
@@ -93,12 +117,41 @@ class TTreePeriodicEventStore : public TProcessor, public IEventStore {
     TTree *fTree{nullptr};          ///<! Pointer to the TTree object that holds event data.
     Long_t fEventNum{0};            ///< The current event number within the run.
     Long_t fMaxEventNum{0};         ///< The maximum number of events to process.
+    Long_t fFirstEventNum{0};       ///< Global event number of the first event, the entry is this modulo the entries.
     Long_t fTreeEventNum{0};        ///< The total number of events in the TTree.
     Long_t fCurrentNum{0};          ///< The current entry index in the TTree.
 
     TEventHeader *fEventHeader{nullptr}; ///<! Pointer to the TEventHeader object read from the TTree.
 
-    ClassDefOverride(TTreePeriodicEventStore, 3); ///< ROOT class definition macro.
+    Double_t fMemoryBudget{512.};    ///< Max size (MB) of the in-memory copy of the tree.
+    Double_t fCacheSize{256.};       ///< TTreeCache size (MB) when the tree is read from the files.
+    Bool_t fAsyncPrefetch{kFALSE};   ///< Prefetch the baskets asynchronously.
+    Bool_t fShuffle{kFALSE};         ///< Replay the entries in a shuffled order.
+    Long_t fShuffleSeed{1};          ///< Seed of the shuffled order.
+    TTree *fMemTree{nullptr};        ///<! In-memory copy of the enabled branches (owned).
+    std::vector<Long64_t> fOrder;    ///<! Entry order of the current cycle (empty: sequential).
+    Long_t fCycle{0};                ///<! Number of the current cycle.
+    StringVec_t fActiveBranches;     ///< Branches to be read (empty: all).
+    std::vector<TString> fBranchNames; ///<! Names of the registered branches.
+    TString fHeaderBranchName;       ///<! Name of the TEventHeader branch.
+    Bool_t fIsPrepared{kFALSE};      ///<! PreLoop has been done.
+
+    /**
+     * @brief Disables the branches not in ActiveBranches and logs the saved size.
+     */
+    void SelectBranches();
+
+    /**
+     * @brief Copies the enabled branches to memory, or sets TTreeCache if they do not fit.
+     */
+    void LoadEntries();
+
+    /**
+     * @brief Makes the shuffled entry order of the current cycle.
+     */
+    void Shuffle();
+
+    ClassDefOverride(TTreePeriodicEventStore, 5); ///< ROOT class definition macro.
 };
 } // namespace art::crib
 
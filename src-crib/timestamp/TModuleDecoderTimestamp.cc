@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022?
- * @note    last modified: 2024-08-23 20:59:52
+ * @note    last modified: 2026-10-18 22:04:16
  * @details
  */
 
@@ -11,55 +11,64 @@
 
 #include <TRawDataSimple.h>
 
+#include <cstring>
+
 using art::crib::TModuleDecoderTimestamp;
 
 typedef art::TRawDataSimple<ULong64_t> TimestampRaw_t;
 
 ClassImp(TModuleDecoderTimestamp);
 
+namespace {
+/// one timestamp = 4 words = 8 bytes
+constexpr Int_t kTimestampBytes = TModuleDecoderTimestamp::kWordsPerTimestamp * sizeof(UShort_t);
+
+/// the words are stored lower word first, each word in the host byte order,
+/// so the value is the same on both endiannesses (a single load on little endian)
+inline ULong64_t LoadTimestamp(const char *ptr) {
+    UShort_t words[TModuleDecoderTimestamp::kWordsPerTimestamp];
+    std::memcpy(words, ptr, sizeof(words));
+    return (static_cast<ULong64_t>(words[3]) << 48) | (static_cast<ULong64_t>(words[2]) << 32) |
+           (static_cast<ULong64_t>(words[1]) << 16) | static_cast<ULong64_t>(words[0]);
+}
+} // namespace
+
 TModuleDecoderTimestamp::TModuleDecoderTimestamp()
-    : TModuleDecoder(kID, TimestampRaw_t::Class()) {
-    fHitData = new TObjArray;
+    : TModuleDecoder(kID, TimestampRaw_t::Class()),
+      fNumBlocks(0), fNumTimestamps(0), fNumEmptyBlocks(0), fNumMalformedBlocks(0) {
 }
 
 TModuleDecoderTimestamp::~TModuleDecoderTimestamp() {
-    delete fHitData;
-    fHitData = nullptr;
+    if (fNumMalformedBlocks > 0 || fNumEmptyBlocks > 0) {
+        Warning("~TModuleDecoderTimestamp", "%llu blocks: %llu malformed (size %% %d != 0), %llu without timestamp",
+                fNumBlocks, fNumMalformedBlocks, kTimestampBytes, fNumEmptyBlocks);
+    }
 }
 
 Int_t TModuleDecoderTimestamp::Decode(char *buf, const Int_t &size, TObjArray *seg) {
-    UShort_t *evtdata = reinterpret_cast<UShort_t *>(buf);
-    UInt_t evtsize = size / sizeof(UShort_t);
-    Int_t igeo, ich;
-    ULong64_t ts;
-    TimestampRaw_t *data;
-
-    // clear old hits
-    fHitData->Clear();
-
-    for (UInt_t i = 0; i < evtsize; i++) {
-        igeo = 0;
-        ich = 0;
-
-        ts = (ULong64_t)evtdata[3] << 48;
-        ts += (ULong64_t)evtdata[2] << 32;
-        ts += (ULong64_t)evtdata[1] << 16;
-        ts += (ULong64_t)evtdata[0];
-
-        // check if the data object exists.
-        if (fHitData->GetEntriesFast() <= ich || !fHitData->At(ich)) {
-            // if no data object is available, create one
-            TimestampRaw_t *obj = static_cast<TimestampRaw_t *>(this->New());
-            obj->SetSegInfo(seg->GetUniqueID(), igeo, ich);
-            fHitData->AddAtAndExpand(obj, ich);
-            seg->Add(obj);
+    ++fNumBlocks;
+    if (size % kTimestampBytes != 0) {
+        if (fNumMalformedBlocks++ == 0) {
+            Warning("Decode", "block size %d bytes is not a multiple of %d, the trailing bytes are ignored",
+                    size, kTimestampBytes);
         }
+    }
 
-        data = static_cast<TimestampRaw_t *>(fHitData->At(ich));
-        data->Set(ts);
+    const Int_t nts = size > 0 ? size / kTimestampBytes : 0;
+    if (nts == 0) {
+        ++fNumEmptyBlocks;
+        return 0;
+    }
 
-        fHitData->AddAt(nullptr, ich);
+    const UInt_t segid = seg->GetUniqueID();
+    const char *ptr = buf;
+    for (Int_t ich = 0; ich < nts; ++ich, ptr += kTimestampBytes) {
+        auto *data = static_cast<TimestampRaw_t *>(this->New());
+        data->SetSegInfo(segid, 0, ich);
+        data->Set(LoadTimestamp(ptr));
+        seg->Add(data);
     }
+    fNumTimestamps += nts;
 
     return 0;
 }
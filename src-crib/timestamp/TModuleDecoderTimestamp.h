@@ -3,7 +3,7 @@
  * @brief
  * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
  * @date    2022?
- * @note    last modified: 2025-01-08 10:36:39
+ * @note    last modified: 2026-10-18 11:12:35
  * @details
  */
 
@@ -16,15 +16,33 @@ namespace art::crib {
 class TModuleDecoderTimestamp;
 }
 
+/**
+ * @brief Decoder of the 64-bit timestamp blocks (module ID = 8).
+ *
+ * A block consists of N x 4 UShort_t words (little endian, lower word first).
+ * The i-th 64-bit timestamp in the block is stored as geo = 0, ch = i,
+ * so that several timestamp sources can share one segment.
+ * Blocks whose size is not a multiple of 8 bytes are counted as malformed;
+ * the complete timestamps in them are still decoded.
+ */
 class art::crib::TModuleDecoderTimestamp : public TModuleDecoder {
   public:
     static const int kID = 8;
+    static const int kWordsPerTimestamp = 4;
     TModuleDecoderTimestamp();
     ~TModuleDecoderTimestamp() override;
     Int_t Decode(char *buffer, const Int_t &size, TObjArray *seg) override;
 
+    ULong64_t GetNumBlocks() const { return fNumBlocks; }
+    ULong64_t GetNumTimestamps() const { return fNumTimestamps; }
+    ULong64_t GetNumEmptyBlocks() const { return fNumEmptyBlocks; }
+    ULong64_t GetNumMalformedBlocks() const { return fNumMalformedBlocks; }
+
   protected:
-    TObjArray *fHitData; // array to tomprally store the data for the aggregation
+    ULong64_t fNumBlocks;          // number of decoded blocks
+    ULong64_t fNumTimestamps;      // number of decoded timestamps
+    ULong64_t fNumEmptyBlocks;     // blocks without any complete timestamp
+    ULong64_t fNumMalformedBlocks; // blocks whose size is not a multiple of 4 words
 
     ClassDefOverride(TModuleDecoderTimestamp, 0) // timestamp decoder
 };
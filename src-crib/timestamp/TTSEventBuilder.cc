@@ -0,0 +1,341 @@
+/**
+ * @file    TTSEventBuilder.cc
+ * @brief   Event store merging several DAQ streams by their timestamps
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 11:40:03
+ * @note    last modified: 2026-10-18 22:09:51
+ * @details
+ */
+
+#include "TTSEventBuilder.h"
+
+#include "TTSData.h"
+#include <TChain.h>
+#include <TClonesArray.h>
+#include <TEventHeader.h>
+
+#include <algorithm>
+#include <functional>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TTSEventBuilder);
+
+namespace art::crib {
+
+TTSEventBuilder::TTSEventBuilder() {
+    StringVec_t init_s_vec;
+    RegisterProcessorParameter("InputFiles", "input ROOT files (one per stream)",
+                               fInputFiles, init_s_vec);
+    RegisterProcessorParameter("Prefixes", "prefix of the branch names of each stream (default: s<i>_)",
+                               fPrefixes, init_s_vec);
+    RegisterProcessorParameter("TreeName", "name of the input trees", fTreeName, TString("tree"));
+    RegisterProcessorParameter("TimestampBranch", "TClonesArray of art::crib::TTSData",
+                               fTimestampBranch, TString("TS"));
+    RegisterProcessorParameter("TimestampID", "ID of the TTSData used for the merge",
+                               fTimestampID, 0);
+    RegisterProcessorParameter("CoincidenceWindow", "coincidence window in timestamp unit",
+                               fCoincidenceWindow, 100L);
+    RegisterProcessorParameter("ReadAhead", "number of timestamps buffered per stream",
+                               fReadAhead, 256);
+    RegisterProcessorParameter("EmitOrphans", "process events with a fragment from only one stream",
+                               fEmitOrphans, kTRUE);
+    RegisterOutputCollection("OutputCollection", "timestamps of the streams in the event",
+                             fOutputColName, TString("evtts"));
+    RegisterProcessorParameter("MaxEventNum", "maximum number of built events (0: no limit)",
+                               fMaxEventNum, 0L);
+}
+
+TTSEventBuilder::~TTSEventBuilder() {
+    for (auto &st : fStreams) {
+        delete st.fIndexChain;
+        delete st.fDataChain;
+        delete st.fTSArray;
+    }
+    fStreams.clear();
+    delete fOutData;
+    fOutData = nullptr;
+}
+
+void TTSEventBuilder::Init(TEventCollection *col) {
+    if (fInputFiles.empty()) {
+        SetStateError("InputFiles is empty");
+        return;
+    }
+    if (!fPrefixes.empty() && fPrefixes.size() != fInputFiles.size()) {
+        SetStateError("the sizes of Prefixes and InputFiles are different");
+        return;
+    }
+    if (fReadAhead <= 0) {
+        SetStateError(Form("ReadAhead must be positive: %d", fReadAhead));
+        return;
+    }
+    if (fCoincidenceWindow < 0) {
+        SetStateError(Form("CoincidenceWindow must not be negative: %ld", fCoincidenceWindow));
+        return;
+    }
+
+    const Int_t nstream = fInputFiles.size();
+    fStreams.clear();
+    fStreams.resize(nstream);
+    for (Int_t i = 0; i < nstream; ++i) {
+        if (!InitStream(col, i))
+            return;
+    }
+
+    delete fOutData;
+    fOutData = new TClonesArray("art::crib::TTSData", nstream);
+    fOutData->SetName(fOutputColName);
+    col->Add(fOutputColName, fOutData, fOutputIsTransparent);
+
+    fHeap.clear();
+    fHeap.reserve(nstream);
+    fEvent.assign(nstream, Fragment{0, 0});
+    fInEvent.assign(nstream, kFALSE);
+    fMembers.clear();
+    fMembers.reserve(nstream);
+    fDeferred.clear();
+    fDeferred.reserve(nstream);
+    fMultHist.assign(nstream + 1, 0);
+    fNumEvents = fNumOrphans = fNumSkipOrphans = 0;
+
+    for (Int_t i = 0; i < nstream; ++i) {
+        PushHead(i);
+    }
+    if (fHeap.empty()) {
+        SetStateError("no timestamp found in the inputs");
+        return;
+    }
+
+    Info("Init", "%d streams, window = %ld, read ahead = %d -> %s",
+         nstream, fCoincidenceWindow, fReadAhead, fOutputColName.Data());
+}
+
+/**
+ * @details
+ * Two chains are opened for each stream: fIndexChain reads only the
+ * timestamp branch in batches, fDataChain reads the whole entry of
+ * the fragments used in the event.
+ */
+Bool_t TTSEventBuilder::InitStream(TEventCollection *col, Int_t idx) {
+    Stream &st = fStreams[idx];
+    const TString &file = fInputFiles[idx];
+    st.fPrefix = fPrefixes.empty() ? TString::Format("s%d_", idx) : fPrefixes[idx];
+
+    st.fIndexChain = new TChain(fTreeName);
+    st.fDataChain = new TChain(fTreeName);
+    if (st.fIndexChain->Add(file) == 0 || st.fDataChain->Add(file) == 0) {
+        SetStateError(Form("No files matched '%s'", file.Data()));
+        return kFALSE;
+    }
+    st.fNumEntries = st.fIndexChain->GetEntries();
+
+    // timestamp only chain
+    st.fIndexChain->LoadTree(0);
+    if (!st.fIndexChain->GetBranch(fTimestampBranch)) {
+        SetStateError(Form("branch '%s' not found in '%s'", fTimestampBranch.Data(), file.Data()));
+        return kFALSE;
+    }
+    st.fTSArray = new TClonesArray("art::crib::TTSData");
+    st.fIndexChain->SetBranchStatus("*", 0);
+    st.fIndexChain->SetBranchStatus(fTimestampBranch, 1);
+    st.fIndexChain->SetBranchAddress(fTimestampBranch, &st.fTSArray);
+
+    // payload chain, class type branches are registered with the prefix
+    st.fDataChain->LoadTree(0);
+    TIter nextBr(st.fDataChain->GetListOfBranches());
+    while (auto *br = dynamic_cast<TBranch *>(nextBr())) {
+        TClass *cl = nullptr;
+        EDataType dtype = kNoType_t;
+        if (br->GetExpectedType(cl, dtype) || !cl) {
+            Warning("InitStream", "branch '%s' of stream %d is skipped (not a class type)",
+                    br->GetName(), idx);
+            st.fDataChain->SetBranchStatus(br->GetName(), 0);
+            continue;
+        }
+        const TString name = st.fPrefix + br->GetName();
+        auto *obj = static_cast<TObject *>(cl->New());
+        col->Add(name, obj, fOutputIsTransparent);
+        st.fDataChain->SetBranchAddress(br->GetName(), reinterpret_cast<TObject **>(col->GetObjectRef(name)));
+        st.fObjects.emplace_back(obj);
+        if (idx == 0 && cl == TEventHeader::Class()) {
+            fEventHeader = static_cast<TEventHeader *>(obj);
+        }
+    }
+
+    st.fBuffer.assign(fReadAhead, Fragment{0, 0});
+    st.fHead = st.fSize = 0;
+    st.fNextEntry = 0;
+    st.fHasLastTS = kFALSE;
+
+    Info("InitStream", "stream %d: '%s' (%lld entries), prefix '%s', %zu branches",
+         idx, file.Data(), st.fNumEntries, st.fPrefix.Data(), st.fObjects.size());
+    return kTRUE;
+}
+
+/**
+ * @details
+ * Reads the next batch of timestamps into the (empty) buffer of the stream.
+ * Entries without the timestamp and entries going back in time are dropped.
+ */
+Bool_t TTSEventBuilder::Refill(Int_t idx) {
+    Stream &st = fStreams[idx];
+    st.fHead = 0;
+    st.fSize = 0;
+    while (st.fSize < fReadAhead && st.fNextEntry < st.fNumEntries) {
+        const Long64_t entry = st.fNextEntry++;
+        st.fIndexChain->GetEntry(entry);
+
+        const TTSData *ts = nullptr;
+        if (fTimestampID >= 0 && fTimestampID < st.fTSArray->GetEntriesFast())
+            ts = static_cast<TTSData *>(st.fTSArray->UncheckedAt(fTimestampID));
+        if (!ts || ts->GetID() != fTimestampID) {
+            ++st.fNumMissing;
+            continue;
+        }
+
+        const ULong64_t value = ts->GetTS();
+        if (st.fHasLastTS && value < st.fLastTS) {
+            ++st.fNumLate;
+            continue;
+        }
+        st.fLastTS = value;
+        st.fHasLastTS = kTRUE;
+        st.fBuffer[st.fSize++] = {entry, value};
+    }
+    return st.fSize > 0;
+}
+
+void TTSEventBuilder::PushHead(Int_t idx) {
+    Stream &st = fStreams[idx];
+    if (st.fSize == 0 && !Refill(idx))
+        return;
+    fHeap.push_back({st.fBuffer[st.fHead].fTS, idx});
+    std::push_heap(fHeap.begin(), fHeap.end(), std::greater<HeapItem>());
+}
+
+void TTSEventBuilder::TakeFragment(Int_t idx) {
+    Stream &st = fStreams[idx];
+    fEvent[idx] = st.fBuffer[st.fHead];
+    ++st.fHead;
+    --st.fSize;
+    ++st.fNumFragments;
+    fInEvent[idx] = kTRUE;
+    fMembers.emplace_back(idx);
+    PushHead(idx);
+}
+
+/**
+ * @details
+ * The fragment with the smallest timestamp opens the event, and the following
+ * fragments within the window are added if their streams are not yet in the event.
+ * A second fragment of a stream in the event stays queued for the next event,
+ * and the scan continues to the end of the window.
+ */
+Bool_t TTSEventBuilder::BuildEvent() {
+    for (const auto idx : fMembers) {
+        fInEvent[idx] = kFALSE;
+    }
+    fMembers.clear();
+
+    if (fHeap.empty())
+        return kFALSE;
+
+    std::pop_heap(fHeap.begin(), fHeap.end(), std::greater<HeapItem>());
+    const HeapItem first = fHeap.back();
+    fHeap.pop_back();
+    TakeFragment(first.fStream);
+
+    const ULong64_t window = fCoincidenceWindow;
+    fDeferred.clear();
+    while (!fHeap.empty()) {
+        const HeapItem top = fHeap.front();
+        if (top.fTS - first.fTS > window)
+            break;
+        std::pop_heap(fHeap.begin(), fHeap.end(), std::greater<HeapItem>());
+        fHeap.pop_back();
+        if (fInEvent[top.fStream]) {
+            // the stream has no other item in the heap until this one is pushed back
+            fDeferred.emplace_back(top);
+            continue;
+        }
+        TakeFragment(top.fStream);
+    }
+    for (const auto &item : fDeferred) {
+        fHeap.push_back(item);
+        std::push_heap(fHeap.begin(), fHeap.end(), std::greater<HeapItem>());
+    }
+    return kTRUE;
+}
+
+void TTSEventBuilder::Process() {
+    fOutData->Clear("C");
+
+    Bool_t built = kFALSE;
+    while ((built = BuildEvent())) {
+        if (fMembers.size() == 1 && fStreams.size() > 1) {
+            ++fNumOrphans;
+            if (!fEmitOrphans) {
+                ++fNumSkipOrphans;
+                continue;
+            }
+        }
+        break;
+    }
+
+    // nothing is left (e.g. only skipped orphans): no event is passed to the following processors
+    if (!built) {
+        SetStopEvent();
+        SetStopLoop();
+        SetEndOfRun();
+        return;
+    }
+
+    for (Int_t idx = 0, n = fStreams.size(); idx < n; ++idx) {
+        Stream &st = fStreams[idx];
+        if (!fInEvent[idx]) {
+            for (auto *obj : st.fObjects) {
+                obj->Clear("C");
+            }
+            continue;
+        }
+        const Fragment &frag = fEvent[idx];
+        st.fDataChain->GetEntry(frag.fEntry);
+
+        auto *data = static_cast<TTSData *>(fOutData->ConstructedAt(idx));
+        data->SetID(idx);
+        data->SetTS(frag.fTS);
+        data->SetTScal(frag.fTS * 0.01);
+    }
+
+    ++fNumEvents;
+    ++fMultHist[fMembers.size()];
+
+    if (fHeap.empty() || (fMaxEventNum > 0 && fNumEvents >= fMaxEventNum)) {
+        SetStopLoop();
+        SetEndOfRun();
+    }
+}
+
+void TTSEventBuilder::PostLoop() {
+    Info("PostLoop", "%lld events built, %lld orphans (%lld skipped)",
+         fNumEvents, fNumOrphans, fNumSkipOrphans);
+    for (Int_t mult = 1, n = fMultHist.size(); mult < n; ++mult) {
+        Info("PostLoop", "  %d stream(s): %lld events", mult, fMultHist[mult]);
+    }
+    for (Int_t idx = 0, n = fStreams.size(); idx < n; ++idx) {
+        const Stream &st = fStreams[idx];
+        Info("PostLoop", "  stream %d (%s): %lld fragments, %lld late, %lld missing, %lld unread",
+             idx, st.fPrefix.Data(), st.fNumFragments, st.fNumLate, st.fNumMissing,
+             st.fNumEntries - st.fNextEntry + st.fSize);
+    }
+}
+
+Int_t TTSEventBuilder::GetRunNumber() const {
+    return (fEventHeader) ? fEventHeader->GetRunNumber() : 0;
+}
+
+const char *TTSEventBuilder::GetRunName() const {
+    return "";
+}
+
+} // namespace art::crib
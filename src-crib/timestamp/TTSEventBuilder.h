@@ -0,0 +1,159 @@
+/**
+ * @file    TTSEventBuilder.h
+ * @brief   Event store merging several DAQ streams by their timestamps
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 11:40:03
+ * @note    last modified: 2026-10-18 22:09:51
+ * @details
+ */
+
+#ifndef CRIB_TTSEVENTBUILDER_H_
+#define CRIB_TTSEVENTBUILDER_H_
+
+#include <IEventStore.h>
+#include <TProcessor.h>
+
+#include <vector>
+
+class TChain;
+class TClonesArray;
+
+namespace art {
+class TEventHeader;
+} // namespace art
+
+namespace art::crib {
+/**
+ * @class TTSEventBuilder
+ * @brief Builds events from N streams with a k-way merge on TTSData timestamps.
+ *
+ * Each input is the ROOT output of one DAQ stream containing the timestamp
+ * branch made by TTSMappingProcessor (steering/ts/ts.yaml).
+ * The streams are merged in timestamp order, and fragments whose timestamps
+ * are within `CoincidenceWindow` of the first fragment are grouped into one
+ * event (at most one fragment per stream, a second one is left for the next event).
+ *
+ * Only the timestamp branch is read ahead, in batches of `ReadAhead` entries
+ * per stream into fixed-size buffers; the other branches of a fragment are
+ * read when the fragment is put into an event. No memory is allocated per
+ * fragment in the event loop.
+ *
+ * The branches of stream i are registered as `<Prefixes[i]><branch name>`.
+ * When a stream has no fragment in the event, its objects are cleared.
+ * The output collection holds one TTSData per stream (index = stream index)
+ * for the streams contributing to the event.
+ *
+ * - orphan: event with a fragment from only one stream
+ * - late: fragment whose timestamp is smaller than the previous one in the same stream (dropped)
+ * - missing: entry without the timestamp (dropped)
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: builder
+ *     type: art::crib::TTSEventBuilder
+ *     parameter:
+ *       InputFiles:                  # [StringVec_t] one file (or pattern) per stream
+ *         - output/run/0001/chkts_a.root
+ *         - output/run/0001/chkts_b.root
+ *       Prefixes: [a_, b_]           # [StringVec_t] prefix of the branches of each stream
+ *       TreeName: tree               # [TString] name of the input trees
+ *       TimestampBranch: TS          # [TString] TClonesArray of art::crib::TTSData
+ *       TimestampID: 0               # [Int_t] ID of the TTSData used for the merge
+ *       CoincidenceWindow: 100       # [Long_t] window in timestamp unit
+ *       ReadAhead: 256               # [Int_t] number of timestamps buffered per stream
+ *       EmitOrphans: 1               # [Bool_t] process events with only one stream
+ *       OutputCollection: evtts      # [TString] TClonesArray of art::crib::TTSData
+ *       MaxEventNum: 0               # [Long_t] 0: no limit
+ * ```
+ */
+class TTSEventBuilder : public TProcessor, public IEventStore {
+  public:
+    TTSEventBuilder();
+    ~TTSEventBuilder() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+    void PostLoop() override;
+
+    Int_t GetRunNumber() const override;
+    const char *GetRunName() const override;
+
+  private:
+    /// @brief timestamp of one tree entry
+    struct Fragment {
+        Long64_t fEntry;
+        ULong64_t fTS;
+    };
+
+    /// @brief state of one input stream
+    struct Stream {
+        TString fPrefix;
+        TChain *fIndexChain{nullptr};   ///< only the timestamp branch is active
+        TChain *fDataChain{nullptr};    ///< all registered branches
+        TClonesArray *fTSArray{nullptr}; ///< read buffer of fIndexChain
+        std::vector<TObject *> fObjects; ///< objects registered in the event collection
+
+        std::vector<Fragment> fBuffer; ///< read-ahead buffer (fixed capacity)
+        Int_t fHead{0}; ///< next fragment in fBuffer
+        Int_t fSize{0}; ///< remaining fragments in fBuffer
+        Long64_t fNextEntry{0};
+        Long64_t fNumEntries{0};
+        ULong64_t fLastTS{0};
+        Bool_t fHasLastTS{kFALSE};
+
+        Long64_t fNumFragments{0};
+        Long64_t fNumLate{0};
+        Long64_t fNumMissing{0};
+    };
+
+    /// @brief heap element, the smallest timestamp on top
+    struct HeapItem {
+        ULong64_t fTS;
+        Int_t fStream;
+        bool operator>(const HeapItem &rhs) const {
+            return fTS != rhs.fTS ? fTS > rhs.fTS : fStream > rhs.fStream;
+        }
+    };
+
+    StringVec_t fInputFiles;
+    StringVec_t fPrefixes;
+    TString fTreeName;
+    TString fTimestampBranch;
+    Int_t fTimestampID;
+    Long_t fCoincidenceWindow;
+    Int_t fReadAhead;
+    Bool_t fEmitOrphans;
+    TString fOutputColName;
+    Long_t fMaxEventNum;
+
+    TClonesArray *fOutData{nullptr};     //!
+    TEventHeader *fEventHeader{nullptr}; //! event header of the first stream
+
+    std::vector<Stream> fStreams;      //!
+    std::vector<HeapItem> fHeap;       //!
+    std::vector<Fragment> fEvent;      //! fragments of the current event (indexed by stream)
+    std::vector<Int_t> fMembers;       //! streams in the current event
+    std::vector<Bool_t> fInEvent;      //!
+    std::vector<HeapItem> fDeferred;   //! in-window fragments of streams already in the event
+
+    Long64_t fNumEvents{0};       //!
+    Long64_t fNumOrphans{0};      //!
+    Long64_t fNumSkipOrphans{0};  //!
+    std::vector<Long64_t> fMultHist; //! number of events by the number of streams
+
+    Bool_t InitStream(TEventCollection *col, Int_t idx);
+    Bool_t Refill(Int_t idx);
+    void PushHead(Int_t idx);
+    void TakeFragment(Int_t idx);
+    Bool_t BuildEvent();
+
+    TTSEventBuilder(const TTSEventBuilder &) = delete;
+    TTSEventBuilder &operator=(const TTSEventBuilder &) = delete;
+
+    ClassDefOverride(TTSEventBuilder, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TTSEVENTBUILDER_H_
@@ -0,0 +1,87 @@
+/**
+ * @file    TTSIndex.h
+ * @brief   Side-car timestamp index file (format and reader)
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 12:31:47
+ * @note    last modified: 2026-10-18 12:31:47
+ * @details
+ */
+
+#ifndef CRIB_TTSINDEX_H_
+#define CRIB_TTSINDEX_H_
+
+#include <Rtypes.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace art::crib::tsindex {
+
+/// file identifier written at the top of the index file
+constexpr char kMagic[8] = {'C', 'R', 'I', 'B', 'T', 'S', 'I', 'X'};
+constexpr UInt_t kVersion = 1;
+
+/**
+ * @brief Header of the index file.
+ */
+struct Header {
+    char fMagic[8];  ///< kMagic
+    UInt_t fVersion; ///< kVersion
+    UInt_t fStride;  ///< one record every fStride tree entries
+};
+
+/**
+ * @brief One index record, written in native byte order.
+ */
+struct Record {
+    Long64_t fEventNumber; ///< event number of the run
+    ULong64_t fTS;         ///< timestamp of the event
+    Long64_t fEntry;       ///< entry of the output tree
+};
+
+/**
+ * @brief Reads the whole index file.
+ * @return false if the file cannot be opened or is not an index file
+ */
+inline bool Read(const std::string &path, std::vector<Record> &records, UInt_t &stride) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin)
+        return false;
+
+    Header header;
+    if (!fin.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if (std::memcmp(header.fMagic, kMagic, sizeof(kMagic)) != 0 || header.fVersion != kVersion)
+        return false;
+    stride = header.fStride;
+
+    fin.seekg(0, std::ios::end);
+    const std::streamoff nbyte = static_cast<std::streamoff>(fin.tellg()) - sizeof(header);
+    records.resize(nbyte / sizeof(Record));
+    fin.seekg(sizeof(header), std::ios::beg);
+    fin.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(Record));
+    return static_cast<bool>(fin);
+}
+
+/**
+ * @brief Returns the tree entry from which a sequential read reaches `ts` first.
+ *
+ * The timestamps in the index are assumed to be non-decreasing.
+ * The entry of the last record with a timestamp smaller than `ts` is returned
+ * (0 if there is none).
+ */
+inline Long64_t FindEntry(const std::vector<Record> &records, ULong64_t ts) {
+    auto it = std::lower_bound(records.begin(), records.end(), ts,
+                               [](const Record &rec, ULong64_t val) { return rec.fTS < val; });
+    if (it == records.begin())
+        return 0;
+    return std::prev(it)->fEntry;
+}
+
+} // namespace art::crib::tsindex
+
+#endif // end of #ifndef CRIB_TTSINDEX_H_
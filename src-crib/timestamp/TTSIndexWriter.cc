@@ -0,0 +1,112 @@
+/**
+ * @file    TTSIndexWriter.cc
+ * @brief   Write a side-car timestamp index of the output tree
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 12:31:47
+ * @note    last modified: 2026-10-18 12:31:47
+ * @details
+ */
+
+#include "TTSIndexWriter.h"
+#include "../TProcessorUtil.h"
+
+#include "TTSData.h"
+#include "TTSIndex.h"
+#include <TClonesArray.h>
+#include <TEventHeader.h>
+#include <TSystem.h>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TTSIndexWriter);
+
+namespace art::crib {
+
+TTSIndexWriter::TTSIndexWriter() {
+    RegisterInputCollection("InputCollection", "TClonesArray of art::crib::TTSData",
+                            fInputColName, TString("TS"));
+    RegisterProcessorParameter("TimestampID", "ID of the TTSData to be recorded",
+                               fTimestampID, 0);
+    RegisterOptionalParameter("EventHeaderName", "event header (event number is counted if not found)",
+                              fEventHeaderName, TString("eventheader"));
+    RegisterProcessorParameter("FileName", "output index file", fFileName, TString("tsindex.tsidx"));
+    RegisterProcessorParameter("Stride", "one record every Stride entries", fStride, 1000);
+}
+
+TTSIndexWriter::~TTSIndexWriter() {
+    if (fOutput.is_open())
+        fOutput.close();
+}
+
+void TTSIndexWriter::Init(TEventCollection *col) {
+    auto result = util::GetInputObject<TClonesArray>(
+        col, fInputColName, "TClonesArray", "art::crib::TTSData");
+    if (std::holds_alternative<TString>(result)) {
+        SetStateError(std::get<TString>(result));
+        return;
+    }
+    fInData = std::get<TClonesArray **>(result);
+
+    if (fStride <= 0) {
+        SetStateError(Form("Stride must be positive: %d", fStride));
+        return;
+    }
+
+    fEventHeader = nullptr;
+    if (!fEventHeaderName.IsNull()) {
+        if (void **ref = col->GetObjectRef(fEventHeaderName)) {
+            fEventHeader = reinterpret_cast<TEventHeader **>(ref);
+        } else {
+            Warning("Init", "'%s' not found, event number is counted in this processor",
+                    fEventHeaderName.Data());
+        }
+    }
+
+    gSystem->mkdir(gSystem->DirName(fFileName), kTRUE);
+    fOutput.open(fFileName.Data(), std::ios::binary | std::ios::trunc);
+    if (!fOutput) {
+        SetStateError(Form("cannot open %s", fFileName.Data()));
+        return;
+    }
+    tsindex::Header header;
+    std::copy(std::begin(tsindex::kMagic), std::end(tsindex::kMagic), header.fMagic);
+    header.fVersion = tsindex::kVersion;
+    header.fStride = fStride;
+    fOutput.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    fEntry = 0;
+    fNumRecords = 0;
+    fPending = kFALSE;
+    Info("Init", "%s -> %s, stride = %d", fInputColName.Data(), fFileName.Data(), fStride);
+}
+
+void TTSIndexWriter::Process() {
+    const Long64_t entry = fEntry++;
+    if (entry % fStride == 0)
+        fPending = kTRUE;
+    if (!fPending)
+        return;
+
+    const TClonesArray *const arr = *fInData;
+    if (fTimestampID < 0 || fTimestampID >= arr->GetEntriesFast())
+        return;
+    const auto *const data = static_cast<const TTSData *>(arr->UncheckedAt(fTimestampID));
+    if (!data || data->GetID() != fTimestampID)
+        return;
+
+    tsindex::Record record;
+    record.fEventNumber = (fEventHeader && *fEventHeader) ? (*fEventHeader)->GetEventNumber() : entry;
+    record.fTS = data->GetTS();
+    record.fEntry = entry;
+    fOutput.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    ++fNumRecords;
+    fPending = kFALSE;
+}
+
+void TTSIndexWriter::PostLoop() {
+    if (!fOutput.is_open())
+        return;
+    fOutput.close();
+    Info("PostLoop", "%lld records for %lld entries -> %s", fNumRecords, fEntry, fFileName.Data());
+}
+
+} // namespace art::crib
@@ -0,0 +1,79 @@
+/**
+ * @file    TTSIndexWriter.h
+ * @brief   Write a side-car timestamp index of the output tree
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 12:31:47
+ * @note    last modified: 2026-10-18 12:31:47
+ * @details
+ */
+
+#ifndef CRIB_TTSINDEXWRITER_H_
+#define CRIB_TTSINDEXWRITER_H_
+
+#include <TProcessor.h>
+
+#include <fstream>
+
+class TClonesArray;
+
+namespace art {
+class TEventHeader;
+} // namespace art
+
+namespace art::crib {
+/**
+ * @class TTSIndexWriter
+ * @brief Records (event number, timestamp, tree entry) every `Stride` events.
+ *
+ * The index file is read by TTSIndexedEventStore to start reading the tree
+ * just before a given timestamp. The tree entry is the number of events which
+ * reached this processor, so it should be placed just before the output tree
+ * processor, after any gate.
+ * If the timestamp is missing at a stride point, the next event with
+ * a timestamp is recorded instead.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: tsindex
+ *     type: art::crib::TTSIndexWriter
+ *     parameter:
+ *       InputCollection: TS               # [TString] TClonesArray of art::crib::TTSData
+ *       TimestampID: 0                    # [Int_t] ID of the TTSData to be recorded
+ *       EventHeaderName: eventheader      # [TString] optional, event number is counted if not found
+ *       FileName: output/run0001.tsidx    # [TString] index file
+ *       Stride: 1000                      # [Int_t] one record every Stride entries
+ * ```
+ */
+class TTSIndexWriter : public TProcessor {
+  public:
+    TTSIndexWriter();
+    ~TTSIndexWriter() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+    void PostLoop() override;
+
+  private:
+    TString fInputColName;
+    Int_t fTimestampID;
+    TString fEventHeaderName;
+    TString fFileName;
+    Int_t fStride;
+
+    TClonesArray **fInData{nullptr};          //!
+    TEventHeader **fEventHeader{nullptr};     //!
+    std::ofstream fOutput;                    //!
+    Long64_t fEntry{0};                       //! current tree entry
+    Long64_t fNumRecords{0};                  //!
+    Bool_t fPending{kFALSE};                  //! waiting for a valid timestamp
+
+    TTSIndexWriter(const TTSIndexWriter &) = delete;
+    TTSIndexWriter &operator=(const TTSIndexWriter &) = delete;
+
+    ClassDefOverride(TTSIndexWriter, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TTSINDEXWRITER_H_
@@ -0,0 +1,160 @@
+/**
+ * @file    TTSIndexedEventStore.cc
+ * @brief   Event store reading only a timestamp range of a tree using the index file
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 12:58:10
+ * @note    last modified: 2026-10-18 12:58:10
+ * @details
+ */
+
+#include "TTSIndexedEventStore.h"
+
+#include "TTSData.h"
+#include "TTSIndex.h"
+#include <TChain.h>
+#include <TClonesArray.h>
+#include <TEventHeader.h>
+
+/// ROOT macro for class implementation
+ClassImp(art::crib::TTSIndexedEventStore);
+
+namespace art::crib {
+
+TTSIndexedEventStore::TTSIndexedEventStore() {
+    RegisterProcessorParameter("FileName", "input file", fFileName, TString("temp.root"));
+    RegisterProcessorParameter("TreeName", "input tree", fTreeName, TString("tree"));
+    RegisterProcessorParameter("IndexFile", "index file made by TTSIndexWriter",
+                               fIndexFile, TString("tsindex.tsidx"));
+    RegisterProcessorParameter("TimestampBranch", "TClonesArray of art::crib::TTSData",
+                               fTimestampBranch, TString("TS"));
+    RegisterProcessorParameter("TimestampID", "ID of the TTSData", fTimestampID, 0);
+    RegisterProcessorParameter("StartTimestamp", "first timestamp", fStartTS, 0L);
+    RegisterProcessorParameter("StopTimestamp", "last timestamp (0: until the end)", fStopTS, 0L);
+    RegisterProcessorParameter("MaxEventNum", "maximum number of events (0: no limit)",
+                               fMaxEventNum, 0L);
+}
+
+TTSIndexedEventStore::~TTSIndexedEventStore() {
+    delete fTree;
+    fTree = nullptr;
+}
+
+void TTSIndexedEventStore::Init(TEventCollection *col) {
+    std::vector<tsindex::Record> records;
+    UInt_t stride = 0;
+    if (!tsindex::Read(fIndexFile.Data(), records, stride)) {
+        SetStateError(Form("cannot read the index file %s", fIndexFile.Data()));
+        return;
+    }
+
+    fTree = new TChain(fTreeName);
+    if (fTree->Add(fFileName) == 0) {
+        SetStateError(Form("No files matched '%s'", fFileName.Data()));
+        return;
+    }
+    fNumEntries = fTree->GetEntries();
+    fTree->LoadTree(0);
+
+    // class type branches are registered with their names
+    TIter nextBr(fTree->GetListOfBranches());
+    while (auto *br = dynamic_cast<TBranch *>(nextBr())) {
+        TClass *cl = nullptr;
+        EDataType dtype = kNoType_t;
+        if (br->GetExpectedType(cl, dtype) || !cl) {
+            Warning("Init", "branch '%s' is skipped (not a class type)", br->GetName());
+            fTree->SetBranchStatus(br->GetName(), 0);
+            continue;
+        }
+        auto *obj = static_cast<TObject *>(cl->New());
+        col->Add(br->GetName(), obj, kTRUE);
+        fTree->SetBranchAddress(br->GetName(), reinterpret_cast<TObject **>(col->GetObjectRef(br->GetName())));
+        if (cl == TEventHeader::Class()) {
+            fEventHeader = static_cast<TEventHeader *>(obj);
+        }
+    }
+
+    void **ref = col->GetObjectRef(fTimestampBranch);
+    if (!ref || !fTree->GetBranch(fTimestampBranch)) {
+        SetStateError(Form("branch '%s' not found in %s", fTimestampBranch.Data(), fFileName.Data()));
+        return;
+    }
+    fTSArray = reinterpret_cast<TClonesArray **>(ref);
+
+    const Long64_t start = tsindex::FindEntry(records, fStartTS);
+    fNextEntry = FindNext(start);
+    if (fNextEntry < 0) {
+        SetStateError(Form("no event in [%ld, %ld]", fStartTS, fStopTS));
+        return;
+    }
+    fEventNum = 0;
+    Info("Init", "%zu index records (stride %u), seek to entry %lld, first event at entry %lld",
+         records.size(), stride, start, fNextEntry);
+}
+
+/// reads only the timestamp branch of the entry
+Bool_t TTSIndexedEventStore::ReadTimestamp(Long64_t entry, ULong64_t &ts) {
+    const Long64_t local = fTree->LoadTree(entry);
+    if (local < 0)
+        return kFALSE;
+    TBranch *br = fTree->GetTree()->GetBranch(fTimestampBranch);
+    if (!br)
+        return kFALSE;
+    br->GetEntry(local);
+
+    const TClonesArray *const arr = *fTSArray;
+    if (fTimestampID < 0 || fTimestampID >= arr->GetEntriesFast())
+        return kFALSE;
+    const auto *const data = static_cast<const TTSData *>(arr->UncheckedAt(fTimestampID));
+    if (!data || data->GetID() != fTimestampID)
+        return kFALSE;
+    ts = data->GetTS();
+    return kTRUE;
+}
+
+/**
+ * @details
+ * Returns the first entry at or after `from` in the timestamp range,
+ * or -1 if the end of the range or of the tree is reached.
+ */
+Long64_t TTSIndexedEventStore::FindNext(Long64_t from) {
+    const ULong64_t start = fStartTS;
+    const ULong64_t stop = fStopTS;
+    ULong64_t ts = 0;
+    for (Long64_t entry = from; entry < fNumEntries; ++entry) {
+        if (!ReadTimestamp(entry, ts) || ts < start)
+            continue;
+        if (stop > 0 && ts > stop)
+            return -1;
+        return entry;
+    }
+    return -1;
+}
+
+void TTSIndexedEventStore::Process() {
+    if (fNextEntry < 0) {
+        SetStopLoop();
+        SetEndOfRun();
+        return;
+    }
+
+    // look ahead before reading the whole entry, so that the timestamp of this event is kept
+    const Long64_t entry = fNextEntry;
+    fNextEntry = FindNext(entry + 1);
+    fTree->GetEntry(entry);
+    ++fEventNum;
+
+    if (fNextEntry < 0 || (fMaxEventNum > 0 && fEventNum >= fMaxEventNum)) {
+        SetStopLoop();
+        SetEndOfRun();
+    }
+}
+
+Int_t TTSIndexedEventStore::GetRunNumber() const {
+    return (fEventHeader) ? fEventHeader->GetRunNumber() : 0;
+}
+
+const char *TTSIndexedEventStore::GetRunName() const {
+    return "";
+}
+
+} // namespace art::crib
@@ -0,0 +1,89 @@
+/**
+ * @file    TTSIndexedEventStore.h
+ * @brief   Event store reading only a timestamp range of a tree using the index file
+ * @author  Kodai Okawa <okawa@cns.s.u-tokyo.ac.jp>
+ * @date    2026-10-18 12:58:10
+ * @note    last modified: 2026-10-18 12:58:10
+ * @details
+ */
+
+#ifndef CRIB_TTSINDEXEDEVENTSTORE_H_
+#define CRIB_TTSINDEXEDEVENTSTORE_H_
+
+#include <IEventStore.h>
+#include <TProcessor.h>
+
+class TChain;
+class TClonesArray;
+
+namespace art {
+class TEventHeader;
+} // namespace art
+
+namespace art::crib {
+/**
+ * @class TTSIndexedEventStore
+ * @brief Reads the events with StartTimestamp <= TS <= StopTimestamp.
+ *
+ * The index file written by TTSIndexWriter gives the tree entry from which
+ * the sequential read starts, so at most `Stride` entries are scanned before
+ * the first event in the range. The scan reads only the timestamp branch.
+ * The timestamps are assumed to be non-decreasing in the tree, and the store
+ * stops at the first event after StopTimestamp.
+ *
+ * ### Example Steering File
+ *
+ * ```yaml
+ * Processor:
+ *   - name: tsstore
+ *     type: art::crib::TTSIndexedEventStore
+ *     parameter:
+ *       FileName: output/run0001.root     # [TString] input file
+ *       TreeName: tree                    # [TString] input tree
+ *       IndexFile: output/run0001.tsidx   # [TString] made by TTSIndexWriter
+ *       TimestampBranch: TS               # [TString] TClonesArray of art::crib::TTSData
+ *       TimestampID: 0                    # [Int_t] ID of the TTSData
+ *       StartTimestamp: 1000000000        # [Long_t] first timestamp
+ *       StopTimestamp: 2000000000         # [Long_t] last timestamp (0: until the end)
+ *       MaxEventNum: 0                    # [Long_t] 0: no limit
+ * ```
+ */
+class TTSIndexedEventStore : public TProcessor, public IEventStore {
+  public:
+    TTSIndexedEventStore();
+    ~TTSIndexedEventStore() override;
+
+    void Init(TEventCollection *col) override;
+    void Process() override;
+
+    Int_t GetRunNumber() const override;
+    const char *GetRunName() const override;
+
+  private:
+    TString fFileName;
+    TString fTreeName;
+    TString fIndexFile;
+    TString fTimestampBranch;
+    Int_t fTimestampID;
+    Long_t fStartTS;
+    Long_t fStopTS;
+    Long_t fMaxEventNum;
+
+    TChain *fTree{nullptr};              //!
+    TClonesArray **fTSArray{nullptr};    //!
+    TEventHeader *fEventHeader{nullptr}; //!
+    Long64_t fNumEntries{0};             //!
+    Long64_t fNextEntry{-1};             //! next entry in the range (-1: none)
+    Long64_t fEventNum{0};               //!
+
+    Bool_t ReadTimestamp(Long64_t entry, ULong64_t &ts);
+    Long64_t FindNext(Long64_t from);
+
+    TTSIndexedEventStore(const TTSIndexedEventStore &) = delete;
+    TTSIndexedEventStore &operator=(const TTSIndexedEventStore &) = delete;
+
+    ClassDefOverride(TTSIndexedEventStore, 0);
+};
+} // namespace art::crib
+
+#endif // end of #ifndef CRIB_TTSINDEXEDEVENTSTORE_H_